@@ -23,11 +23,68 @@
 #include <glib.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "gssim.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GSSIM_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+/* Minimum number of rows handled by a thread, bands smaller than that
+ * are not worth the synchronisation overhead */
+#define GSSIM_MIN_BAND_HEIGHT 32
+
+/* Subtracted from the pixel values before filtering to keep the sums of
+ * squares small and precise */
+#define GSSIM_PIXEL_BIAS 128
+
 typedef gfloat (*SSimWeightFunc) (Gssim * self, gint y, gint x);
 
+/* dest[x] = sum (kernel[i] * src[x + i]) for i in [0, ksize[ */
+typedef void (*SSimRowFilterFunc) (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width);
+/* dest[x] = sum (kernel[j] * rows[j][x]) for j in [0, n_rows[ */
+typedef void (*SSimColumnFilterFunc) (const gfloat ** rows,
+    const gfloat * kernel, gint n_rows, gfloat * dest, gint width);
+
+/* Indices of the planes filtered by the separable engine */
+enum
+{
+  SSIM_PLANE_ORG,
+  SSIM_PLANE_MOD,
+  SSIM_PLANE_ORG_ORG,
+  SSIM_PLANE_MOD_MOD,
+  SSIM_PLANE_ORG_MOD,
+  SSIM_N_PLANES
+};
+
+typedef struct _SSimBand
+{
+  Gssim *self;
+
+  /* Output rows handled by the band: [y_start, y_end[ */
+  gint y_start;
+  gint y_end;
+
+  /* SSIM_N_PLANES padded input rows */
+  gfloat *padded;
+  /* SSIM_N_PLANES horizontally filtered planes, covering the input rows
+   * needed by the band */
+  gfloat *filtered;
+  /* SSIM_N_PLANES vertically filtered rows */
+  gfloat *sums;
+
+  /* Inputs and results of the current comparison */
+  const guint8 *org;
+  const guint8 *mod;
+  guint8 *out;
+  gdouble cumulative_ssim;
+  gfloat lowest;
+  gfloat highest;
+} SSimBand;
+
 typedef struct _SSimWindowCache
 {
   gint x_window_start;
@@ -53,6 +110,22 @@ struct _GssimPrivate
 
   gfloat *orgmu;
 
+  /* Separable engine state */
+  gfloat *kernel;
+  /* Sums of the kernel weights actually covered by the window of each column
+   * (resp. row) and the corresponding normalization factors */
+  gfloat *col_weights;
+  gfloat *col_norms;
+  gfloat *row_weights;
+  gfloat *row_norms;
+
+  SSimBand *bands;
+  gint n_bands;
+
+  GMutex lock;
+  GCond cond;
+  gint pending_bands;
+
   GstVideoConverter *converter;
   GstVideoInfo in_info, out_info;
 };
@@ -233,17 +306,498 @@ gssim_regenerate_windows (Gssim * self)
     }
   }
 
-  /* FIXME: while 0.01 and 0.03 are pretty much static, the 255 implies that
-   * we're working with 8-bit-per-color-component format, which may not be true
-   */
-  self->priv->const1 = 0.01 * 255 * 0.01 * 255;
-  self->priv->const2 = 0.03 * 255 * 0.03 * 255;
   return TRUE;
 }
 
+/* Separable engine
+ *
+ * Both window types are separable: the gaussian weight of (x, y) is
+ * proportional to k(x) * k(y), and the box weights are all 1. Each window
+ * sum needed to compute the SSIM of a pixel (means, variances and
+ * covariance) can thus be computed by filtering the rows of the org, mod,
+ * org * org, mod * mod and org * mod planes with the 1D kernel, then
+ * filtering the columns of the result, which costs 2 * windowsize operations
+ * per pixel and plane instead of windowsize * windowsize for each of the
+ * two passes of gssim_compare_reference().
+ *
+ * Given, for a window, the sums S(x) = sum (w * x), its actual weight W
+ * = sum (w) (clipped at the image borders) and the normalization factor E
+ * used by the reference implementation, we have:
+ *
+ *   mu_x = S(x) / E
+ *   sigma_x^2 = (S(xx) - 2 * mu_x * S(x) + mu_x^2 * W) / E
+ *   sigma_xy = (S(xy) - mu_x * S(y) - mu_y * S(x) + mu_x * mu_y * W) / E
+ *
+ * which are the values the reference computes. The image is split in bands
+ * of rows which are processed in parallel.
+ *
+ * Pixel values are biased by -GSSIM_PIXEL_BIAS before filtering, which
+ * doesn't change the variances, and box window sums are then integers
+ * < 2^24 which are exact in single precision. Gaussian window sums are
+ * accumulated in a different order than the reference, so results match
+ * within GSSIM_EPSILON and the output pixels within 1.
+ */
+
+static void
+ssim_row_filter_scalar (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+{
+  gint x, i;
+
+  for (x = 0; x < width; x++) {
+    gfloat acc = 0;
+
+    for (i = 0; i < ksize; i++)
+      acc += kernel[i] * src[x + i];
+    dest[x] = acc;
+  }
+}
+
+static void
+ssim_column_filter_scalar (const gfloat ** rows, const gfloat * kernel,
+    gint n_rows, gfloat * dest, gint width)
+{
+  gint x, j;
+
+  for (x = 0; x < width; x++) {
+    gfloat acc = 0;
+
+    for (j = 0; j < n_rows; j++)
+      acc += kernel[j] * rows[j][x];
+    dest[x] = acc;
+  }
+}
+
+/* Sliding sum for box windows, all values are integers so this is exact */
+static void
+ssim_row_filter_box (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+{
+  gint x, i;
+  gfloat acc = 0;
+
+  for (i = 0; i < ksize; i++)
+    acc += src[i];
+  dest[0] = acc;
+
+  for (x = 1; x < width; x++) {
+    acc += src[x + ksize - 1] - src[x - 1];
+    dest[x] = acc;
+  }
+}
+
+#ifdef GSSIM_HAVE_X86_KERNELS
+static void ssim_row_filter_sse (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+    __attribute__ ((target ("sse")));
+static void ssim_column_filter_sse (const gfloat ** rows,
+    const gfloat * kernel, gint n_rows, gfloat * dest, gint width)
+    __attribute__ ((target ("sse")));
+static void ssim_row_filter_avx2 (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+    __attribute__ ((target ("avx2")));
+static void ssim_column_filter_avx2 (const gfloat ** rows,
+    const gfloat * kernel, gint n_rows, gfloat * dest, gint width)
+    __attribute__ ((target ("avx2")));
+
+static void
+ssim_row_filter_sse (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+{
+  gint x, i;
+
+  for (x = 0; x + 4 <= width; x += 4) {
+    __m128 acc = _mm_setzero_ps ();
+
+    for (i = 0; i < ksize; i++)
+      acc = _mm_add_ps (acc, _mm_mul_ps (_mm_set1_ps (kernel[i]),
+              _mm_loadu_ps (src + x + i)));
+    _mm_storeu_ps (dest + x, acc);
+  }
+
+  ssim_row_filter_scalar (src + x, dest + x, kernel, ksize, width - x);
+}
+
+static void
+ssim_column_filter_sse (const gfloat ** rows,
+    const gfloat * kernel, gint n_rows, gfloat * dest, gint width)
+{
+  gint x, j;
+
+  for (x = 0; x + 4 <= width; x += 4) {
+    __m128 acc = _mm_setzero_ps ();
+
+    for (j = 0; j < n_rows; j++)
+      acc = _mm_add_ps (acc, _mm_mul_ps (_mm_set1_ps (kernel[j]),
+              _mm_loadu_ps (rows[j] + x)));
+    _mm_storeu_ps (dest + x, acc);
+  }
+
+  for (; x < width; x++) {
+    gfloat acc = 0;
+
+    for (j = 0; j < n_rows; j++)
+      acc += kernel[j] * rows[j][x];
+    dest[x] = acc;
+  }
+}
+
+static void
+ssim_row_filter_avx2 (const gfloat * src, gfloat * dest,
+    const gfloat * kernel, gint ksize, gint width)
+{
+  gint x, i;
+
+  for (x = 0; x + 8 <= width; x += 8) {
+    __m256 acc = _mm256_setzero_ps ();
+
+    for (i = 0; i < ksize; i++)
+      acc = _mm256_add_ps (acc, _mm256_mul_ps (_mm256_set1_ps (kernel[i]),
+              _mm256_loadu_ps (src + x + i)));
+    _mm256_storeu_ps (dest + x, acc);
+  }
+
+  ssim_row_filter_scalar (src + x, dest + x, kernel, ksize, width - x);
+}
+
+static void
+ssim_column_filter_avx2 (const gfloat ** rows,
+    const gfloat * kernel, gint n_rows, gfloat * dest, gint width)
+{
+  gint x, j;
+
+  for (x = 0; x + 8 <= width; x += 8) {
+    __m256 acc = _mm256_setzero_ps ();
+
+    for (j = 0; j < n_rows; j++)
+      acc = _mm256_add_ps (acc, _mm256_mul_ps (_mm256_set1_ps (kernel[j]),
+              _mm256_loadu_ps (rows[j] + x)));
+    _mm256_storeu_ps (dest + x, acc);
+  }
+
+  for (; x < width; x++) {
+    gfloat acc = 0;
+
+    for (j = 0; j < n_rows; j++)
+      acc += kernel[j] * rows[j][x];
+    dest[x] = acc;
+  }
+}
+#endif
+
+static SSimRowFilterFunc ssim_row_filter = ssim_row_filter_scalar;
+static SSimColumnFilterFunc ssim_column_filter = ssim_column_filter_scalar;
+
+static void
+gssim_clear_engine (Gssim * self)
+{
+  gint i;
+
+  for (i = 0; i < self->priv->n_bands; i++) {
+    g_free (self->priv->bands[i].padded);
+    g_free (self->priv->bands[i].filtered);
+    g_free (self->priv->bands[i].sums);
+  }
+  g_free (self->priv->bands);
+  self->priv->bands = NULL;
+  self->priv->n_bands = 0;
+
+  g_free (self->priv->kernel);
+  self->priv->kernel = NULL;
+  g_free (self->priv->col_weights);
+  self->priv->col_weights = NULL;
+  g_free (self->priv->col_norms);
+  self->priv->col_norms = NULL;
+  g_free (self->priv->row_weights);
+  self->priv->row_weights = NULL;
+  g_free (self->priv->row_norms);
+  self->priv->row_norms = NULL;
+}
+
+/* Sums of the kernel weights covered by the windows along an axis of
+ * @size pixels */
+static void
+gssim_compute_axis_weights (Gssim * self, gint size, gfloat ** weights,
+    gfloat ** norms)
+{
+  gint pos, i;
+  gint ksize = self->priv->windowsize;
+  gint offset = ksize / 2 - (ksize % 2 == 0 ? 1 : 0);
+
+  *weights = g_new (gfloat, size);
+  *norms = g_new (gfloat, size);
+
+  for (pos = 0; pos < size; pos++) {
+    gfloat weight = 0, norm = 0;
+
+    for (i = 0; i < ksize; i++) {
+      gint coord = pos - offset + i;
+
+      /* The reference only ignores the part of the window that is before
+       * the start of the image when normalizing */
+      if (coord >= 0)
+        norm += self->priv->kernel[i];
+      if (coord >= 0 && coord < size)
+        weight += self->priv->kernel[i];
+    }
+
+    (*weights)[pos] = weight;
+    (*norms)[pos] = norm;
+  }
+}
+
+static void gssim_band_thread_func (SSimBand * band, gpointer unused);
+
+/* Shared by all the instances, so that comparing several images in parallel
+ * does not start more threads than there are processors */
+static GThreadPool *
+gssim_get_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool)) {
+    GThreadPool *new_pool =
+        g_thread_pool_new ((GFunc) gssim_band_thread_func, NULL,
+        MAX (g_get_num_processors () - 1, 1), FALSE, NULL);
+
+    g_once_init_leave (&pool, new_pool);
+  }
+
+  return pool;
+}
+
+static void
+gssim_setup_engine (Gssim * self)
+{
+  gint i, n_threads, band_height, padded_stride;
+  gint ksize = self->priv->windowsize;
+  gint offset = ksize / 2 - (ksize % 2 == 0 ? 1 : 0);
+
+  if (self->priv->windowtype != 0 && self->priv->windowtype != 1)
+    self->priv->windowtype = 1;
+
+  self->priv->kernel = g_new (gfloat, ksize);
+  for (i = 0; i < ksize; i++) {
+    gfloat coord = i - offset;
+
+    if (self->priv->windowtype == 0)
+      self->priv->kernel[i] = 1;
+    else
+      self->priv->kernel[i] = exp (-1 * (coord * coord) /
+          (2 * self->priv->sigma * self->priv->sigma));
+  }
+
+  gssim_compute_axis_weights (self, self->priv->width,
+      &self->priv->col_weights, &self->priv->col_norms);
+  gssim_compute_axis_weights (self, self->priv->height,
+      &self->priv->row_weights, &self->priv->row_norms);
+
+  n_threads = g_get_num_processors ();
+  self->priv->n_bands = CLAMP (self->priv->height / GSSIM_MIN_BAND_HEIGHT, 1,
+      n_threads);
+  band_height = (self->priv->height + self->priv->n_bands - 1) /
+      self->priv->n_bands;
+  padded_stride = self->priv->width + ksize - 1;
+
+  self->priv->bands = g_new0 (SSimBand, self->priv->n_bands);
+  for (i = 0; i < self->priv->n_bands; i++) {
+    SSimBand *band = &self->priv->bands[i];
+
+    band->self = self;
+    band->y_start = i * band_height;
+    band->y_end = MIN (band->y_start + band_height, self->priv->height);
+
+    /* Zeroed once, the padding is never written to */
+    band->padded = g_new0 (gfloat, SSIM_N_PLANES * padded_stride);
+    band->filtered = g_new (gfloat, SSIM_N_PLANES * self->priv->width *
+        (band_height + ksize - 1));
+    band->sums = g_new (gfloat, SSIM_N_PLANES * self->priv->width);
+  }
+}
+
+static void
+gssim_process_band (SSimBand * band)
+{
+  gint x, y, p;
+  GssimPrivate *priv = band->self->priv;
+  gint width = priv->width;
+  gint ksize = priv->windowsize;
+  gint offset = ksize / 2 - (ksize % 2 == 0 ? 1 : 0);
+  gint padded_stride = width + ksize - 1;
+  gint first_row = MAX (0, band->y_start - offset);
+  gint last_row = MIN (priv->height, band->y_end - offset + ksize - 1);
+  gint plane_stride = width * (last_row - first_row);
+  SSimRowFilterFunc row_filter =
+      priv->windowtype == 0 ? ssim_row_filter_box : ssim_row_filter;
+  const gfloat **rows = g_newa (const gfloat *, ksize);
+
+  band->cumulative_ssim = 0;
+  band->lowest = G_MAXFLOAT;
+  band->highest = -G_MAXFLOAT;
+
+  /* Horizontal pass over all the rows covered by the band windows */
+  for (y = first_row; y < last_row; y++) {
+    const guint8 *org = band->org + y * width;
+    const guint8 *mod = band->mod + y * width;
+    gfloat *po = band->padded + SSIM_PLANE_ORG * padded_stride + offset;
+    gfloat *pm = band->padded + SSIM_PLANE_MOD * padded_stride + offset;
+    gfloat *poo = band->padded + SSIM_PLANE_ORG_ORG * padded_stride + offset;
+    gfloat *pmm = band->padded + SSIM_PLANE_MOD_MOD * padded_stride + offset;
+    gfloat *pom = band->padded + SSIM_PLANE_ORG_MOD * padded_stride + offset;
+
+    for (x = 0; x < width; x++) {
+      gfloat o = org[x] - GSSIM_PIXEL_BIAS, m = mod[x] - GSSIM_PIXEL_BIAS;
+
+      po[x] = o;
+      pm[x] = m;
+      poo[x] = o * o;
+      pmm[x] = m * m;
+      pom[x] = o * m;
+    }
+
+    for (p = 0; p < SSIM_N_PLANES; p++)
+      row_filter (band->padded + p * padded_stride,
+          band->filtered + p * plane_stride + (y - first_row) * width,
+          priv->kernel, ksize, width);
+  }
+
+  /* Vertical pass and SSIM of each pixel */
+  for (y = band->y_start; y < band->y_end; y++) {
+    gint win_start = MAX (0, y - offset);
+    gint win_end = MIN (priv->height, y - offset + ksize);
+    const gfloat *kernel = priv->kernel + (win_start - (y - offset));
+    gdouble row_weight = priv->row_weights[y];
+    gdouble row_norm = priv->row_norms[y];
+    const gfloat *so, *sm, *soo, *smm, *som;
+
+    for (p = 0; p < SSIM_N_PLANES; p++) {
+      gint j;
+
+      for (j = 0; j < win_end - win_start; j++)
+        rows[j] = band->filtered + p * plane_stride +
+            (win_start + j - first_row) * width;
+
+      ssim_column_filter (rows, kernel, win_end - win_start,
+          band->sums + p * width, width);
+    }
+
+    so = band->sums + SSIM_PLANE_ORG * width;
+    sm = band->sums + SSIM_PLANE_MOD * width;
+    soo = band->sums + SSIM_PLANE_ORG_ORG * width;
+    smm = band->sums + SSIM_PLANE_MOD_MOD * width;
+    som = band->sums + SSIM_PLANE_ORG_MOD * width;
+
+    for (x = 0; x < width; x++) {
+      gdouble norm = row_norm * priv->col_norms[x];
+      gdouble weight = row_weight * priv->col_weights[x];
+      gdouble mu_o, mu_m, sigma_o, sigma_m, sigma_om;
+      gfloat ssim;
+
+      /* Biased means, the variance and covariance are computed on biased
+       * values, the means are then unbiased */
+      mu_o = (so[x] + GSSIM_PIXEL_BIAS * (weight - norm)) / norm;
+      mu_m = (sm[x] + GSSIM_PIXEL_BIAS * (weight - norm)) / norm;
+
+      sigma_o = (soo[x] - 2 * mu_o * so[x] + mu_o * mu_o * weight) / norm;
+      sigma_m = (smm[x] - 2 * mu_m * sm[x] + mu_m * mu_m * weight) / norm;
+      sigma_om = (som[x] - mu_o * sm[x] - mu_m * so[x] +
+          mu_o * mu_m * weight) / norm;
+      mu_o += GSSIM_PIXEL_BIAS;
+      mu_m += GSSIM_PIXEL_BIAS;
+
+      ssim = (2 * mu_o * mu_m + priv->const1) * (2 * sigma_om +
+          priv->const2) / ((mu_o * mu_o + mu_m * mu_m + priv->const1) *
+          (MAX (sigma_o, 0) + MAX (sigma_m, 0) + priv->const2));
+
+      /* SSIM can go negative, that's why it is
+         127 + index * 128 instead of index * 255 */
+      if (band->out)
+        band->out[y * width + x] = 127 + ssim * 128;
+      band->lowest = MIN (band->lowest, ssim);
+      band->highest = MAX (band->highest, ssim);
+      band->cumulative_ssim += ssim;
+    }
+  }
+}
+
+static void
+gssim_band_thread_func (SSimBand * band, gpointer unused)
+{
+  Gssim *self = band->self;
+
+  gssim_process_band (band);
+
+  g_mutex_lock (&self->priv->lock);
+  self->priv->pending_bands--;
+  if (self->priv->pending_bands == 0)
+    g_cond_signal (&self->priv->cond);
+  g_mutex_unlock (&self->priv->lock);
+}
+
+/**
+ * gssim_compare:
+ * @self: a #Gssim configured with gssim_configure()
+ * @org: the reference luma plane, without padding between rows
+ * @mod: the luma plane to compare with @org
+ * @out: (allow-none): where to write the SSIM map, mapping [-1, 1] to
+ * [0, 255]
+ * @mean: (out): mean SSIM of the image
+ * @lowest: (out): lowest SSIM of the image
+ * @highest: (out): highest SSIM of the image
+ *
+ * Computes the structural similarity of @org and @mod. The rows of the image
+ * are split across a thread pool shared by all the #Gssim and the windows
+ * are computed with separable filters using the fastest kernels supported by
+ * the CPU.
+ */
 void
 gssim_compare (Gssim * self, guint8 * org, guint8 * mod,
     guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
+{
+  gint i;
+  gdouble cumulative_ssim = 0;
+
+  *lowest = G_MAXFLOAT;
+  *highest = -G_MAXFLOAT;
+
+  if (self->priv->kernel == NULL)
+    gssim_setup_engine (self);
+
+  for (i = 0; i < self->priv->n_bands; i++) {
+    self->priv->bands[i].org = org;
+    self->priv->bands[i].mod = mod;
+    self->priv->bands[i].out = out;
+  }
+
+  self->priv->pending_bands = self->priv->n_bands - 1;
+  for (i = 1; i < self->priv->n_bands; i++)
+    g_thread_pool_push (gssim_get_pool (), &self->priv->bands[i], NULL);
+
+  gssim_process_band (&self->priv->bands[0]);
+
+  g_mutex_lock (&self->priv->lock);
+  while (self->priv->pending_bands > 0)
+    g_cond_wait (&self->priv->cond, &self->priv->lock);
+  g_mutex_unlock (&self->priv->lock);
+
+  for (i = 0; i < self->priv->n_bands; i++) {
+    *lowest = MIN (*lowest, self->priv->bands[i].lowest);
+    *highest = MAX (*highest, self->priv->bands[i].highest);
+    cumulative_ssim += self->priv->bands[i].cumulative_ssim;
+  }
+  *mean = cumulative_ssim / (self->priv->width * self->priv->height);
+}
+
+/**
+ * gssim_compare_reference:
+ *
+ * Straightforward implementation of the SSIM computation, recomputing the
+ * means and variances of every window from scratch. It is very slow and only
+ * kept as a reference to check the results of gssim_compare() against.
+ */
+void
+gssim_compare_reference (Gssim * self, guint8 * org, guint8 * mod,
+    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
 {
   gint oy, ox, iy, ix;
   gfloat cumulative_ssim = 0;
@@ -252,6 +806,8 @@ gssim_compare (Gssim * self, guint8 * org, guint8 * mod,
 
   if (self->priv->windows == NULL)
     gssim_regenerate_windows (self);
+  if (self->priv->orgmu == NULL)
+    self->priv->orgmu = g_new (gfloat, self->priv->width * self->priv->height);
   gssim_calculate_mu (self, org);
 
   for (oy = 0; oy < self->priv->height; oy++) {
@@ -377,7 +933,9 @@ gssim_configure (Gssim * self, gint width, gint height)
   self->priv->windows = NULL;
 
   g_free (self->priv->orgmu);
-  self->priv->orgmu = g_new (gfloat, width * height);
+  self->priv->orgmu = NULL;
+
+  gssim_clear_engine (self);
 
   return TRUE;
 }
@@ -415,8 +973,13 @@ gssim_finalize (GObject * object)
   void (*chain_up) (GObject *) =
       ((GObjectClass *) gssim_parent_class)->finalize;
 
+  gssim_clear_engine (self);
+  g_mutex_clear (&self->priv->lock);
+  g_cond_clear (&self->priv->cond);
+
   g_free (self->priv->orgmu);
   g_free (self->priv->windows);
+  g_free (self->priv->weights);
 
   chain_up (object);
 }
@@ -429,6 +992,17 @@ gssim_class_init (GssimClass * klass)
   oclass->get_property = gssim_get_property;
   oclass->set_property = gssim_set_property;
   oclass->finalize = gssim_finalize;
+
+#ifdef GSSIM_HAVE_X86_KERNELS
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2")) {
+    ssim_row_filter = ssim_row_filter_avx2;
+    ssim_column_filter = ssim_column_filter_avx2;
+  } else if (__builtin_cpu_supports ("sse")) {
+    ssim_row_filter = ssim_row_filter_sse;
+    ssim_column_filter = ssim_column_filter_sse;
+  }
+#endif
 }
 
 static void
@@ -440,6 +1014,14 @@ gssim_init (Gssim * self)
   self->priv->windowtype = 1;
   self->priv->windows = NULL;
   self->priv->sigma = 1.5;
+
+  /* FIXME: while 0.01 and 0.03 are pretty much static, the 255 implies that
+   * we're working with 8-bit-per-color-component format, which may not be true
+   */
+  self->priv->const1 = 0.01 * 255 * 0.01 * 255;
+  self->priv->const2 = 0.03 * 255 * 0.03 * 255;
+  g_mutex_init (&self->priv->lock);
+  g_cond_init (&self->priv->cond);
 }
 
 Gssim *
@@ -30,6 +30,12 @@
 
 G_BEGIN_DECLS
 
+/* Maximum difference between the SSIM values computed by gssim_compare()
+ * and gssim_compare_reference() for the lowest and highest values of a
+ * frame, and for its mean on frames under 100000 pixels (the reference
+ * accumulates the mean in single precision and drifts on bigger frames) */
+#define GSSIM_EPSILON 1e-4
+
 typedef struct _GssimPrivate GssimPrivate;
 
 typedef struct {
@@ -55,6 +61,9 @@ Gssim * gssim_new    (void);
 void gssim_compare       (Gssim * self, guint8 * org, guint8 * mod,
                           guint8 * out, gfloat * mean, gfloat * lowest,
                           gfloat * highest);
+void gssim_compare_reference (Gssim * self, guint8 * org, guint8 * mod,
+                              guint8 * out, gfloat * mean, gfloat * lowest,
+                              gfloat * highest);
 gboolean gssim_configure (Gssim * self, gint width, gint height);
 
 G_END_DECLS
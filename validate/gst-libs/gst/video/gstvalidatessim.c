@@ -25,6 +25,7 @@
 #include <stdio.h>
 
 #include <errno.h>
+#include <glib/gstdio.h>
 #include "gstvalidatessim.h"
 #include "gssim.h"
 
@@ -48,6 +49,8 @@ enum
   PROP_LAST
 };
 
+#define DEFAULT_REFERENCE_CACHE_SIZE (256 * 1024 * 1024)
+
 typedef struct
 {
   GstVideoConverter *converter;
@@ -55,6 +58,19 @@ typedef struct
   GstVideoInfo out_info;
 } SSimConverterInfo;
 
+typedef struct
+{
+  gchar *path;
+  gint64 mtime;
+  gint width;
+  gint height;
+
+  /* GST_ROUND_UP_4 (width) * height bytes luma plane */
+  GstBuffer *luma;
+
+  GList link;
+} SSimReference;
+
 struct _GstValidateSsimPrivate
 {
   gint width;
@@ -71,6 +87,17 @@ struct _GstValidateSsimPrivate
   gfloat min_lowest_similarity;
 
   GHashTable *ref_frames_cache;
+
+  guint jobs;
+
+  /* LRU cache of the luma planes of the reference frames, most recently
+   * used first */
+  GHashTable *references;
+  GQueue references_lru;
+  guint64 references_size;
+  guint64 references_max_size;
+  guint references_hits;
+  guint references_misses;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GstValidateSsim, gst_validate_ssim,
@@ -256,50 +283,49 @@ _get_format_from_surface (cairo_surface_t * surface)
 #endif
 }
 
-void
-gst_validate_ssim_compare_frames (GstValidateSsim * self,
-    GstVideoFrame * ref_frame, GstVideoFrame * frame, GstBuffer ** outbuf,
-    gfloat * mean, gfloat * lowest, gfloat * highest)
+/* Returns a buffer with the luma plane of @frame, as used by gssim, in its
+ * first GST_ROUND_UP_4 (width) * height bytes */
+static GstBuffer *
+gst_validate_ssim_get_luma (GstValidateSsim * self, gint index,
+    gboolean reconf, GstVideoFrame * frame)
 {
-  gboolean reconf;
-  guint8 *outdata = NULL;
-  GstMapInfo map1, map2, outmap;
+  GstBuffer *res;
+  GstVideoFrame converted;
+  SSimConverterInfo *info;
 
-  GstVideoFrame converted_frame1, converted_frame2;
-  SSimConverterInfo *convinfo1, *convinfo2;
+  gst_validate_ssim_configure_converter (self, index, reconf,
+      frame->info.finfo->format, frame->info.width, frame->info.height);
 
-  reconf =
-      gst_validate_ssim_configure (self, ref_frame->info.width,
-      ref_frame->info.height);
+  info = (SSimConverterInfo *) g_list_nth_data (self->priv->converters, index);
+  if (!info->converter)
+    return gst_buffer_ref (frame->buffer);
 
-  gst_validate_ssim_configure_converter (self, 0, reconf,
-      ref_frame->info.finfo->format, ref_frame->info.width,
-      ref_frame->info.height);
+  if (!gst_validate_ssim_convert (self, info, frame, &converted))
+    return NULL;
 
-  gst_validate_ssim_configure_converter (self, 1, reconf,
-      frame->info.finfo->format, frame->info.width, frame->info.height);
+  res = gst_buffer_ref (converted.buffer);
+  gst_video_frame_unmap (&converted);
 
-  convinfo1 = (SSimConverterInfo *) g_list_nth_data (self->priv->converters, 0);
-  if (convinfo1->converter)
-    gst_validate_ssim_convert (self, convinfo1, ref_frame, &converted_frame1);
-  else
-    converted_frame1 = *ref_frame;
+  return res;
+}
 
-  convinfo2 = (SSimConverterInfo *) g_list_nth_data (self->priv->converters, 1);
-  if (convinfo2->converter)
-    gst_validate_ssim_convert (self, convinfo2, frame, &converted_frame2);
-  else
-    converted_frame2 = *frame;
+static void
+gst_validate_ssim_compare_luma (GstValidateSsim * self, GstBuffer * ref_luma,
+    GstBuffer * luma, GstBuffer ** outbuf, gfloat * mean, gfloat * lowest,
+    gfloat * highest)
+{
+  guint8 *outdata = NULL;
+  GstMapInfo map1, map2, outmap;
 
-  if (!gst_buffer_map (converted_frame1.buffer, &map1, GST_MAP_READ)) {
+  if (!gst_buffer_map (ref_luma, &map1, GST_MAP_READ)) {
     GST_VALIDATE_REPORT (self, GENERAL_INPUT_ERROR,
         "Could not map reference frame");
 
     return;
   }
 
-  if (!gst_buffer_map (converted_frame2.buffer, &map2, GST_MAP_READ)) {
-    gst_buffer_unmap (converted_frame1.buffer, &map1);
+  if (!gst_buffer_map (luma, &map2, GST_MAP_READ)) {
+    gst_buffer_unmap (ref_luma, &map1);
     GST_VALIDATE_REPORT (self, GENERAL_INPUT_ERROR,
         "Could not map compared frame");
 
@@ -314,8 +340,8 @@ gst_validate_ssim_compare_frames (GstValidateSsim * self,
           "Could not map output frame");
 
       gst_buffer_unref (*outbuf);
-      gst_buffer_unmap (converted_frame1.buffer, &map1);
-      gst_buffer_unmap (converted_frame2.buffer, &map2);
+      gst_buffer_unmap (ref_luma, &map1);
+      gst_buffer_unmap (luma, &map2);
       *outbuf = NULL;
 
       return;
@@ -327,18 +353,38 @@ gst_validate_ssim_compare_frames (GstValidateSsim * self,
   gssim_compare (self->priv->ssim, map1.data, map2.data, outdata, mean,
       lowest, highest);
 
-  gst_buffer_unmap (ref_frame->buffer, &map1);
-  gst_buffer_unmap (frame->buffer, &map2);
-
-  if (convinfo1->converter)
-    gst_video_frame_unmap (&converted_frame1);
-  if (convinfo2->converter)
-    gst_video_frame_unmap (&converted_frame2);
+  gst_buffer_unmap (ref_luma, &map1);
+  gst_buffer_unmap (luma, &map2);
 
   if (outbuf)
     gst_buffer_unmap (*outbuf, &outmap);
 }
 
+void
+gst_validate_ssim_compare_frames (GstValidateSsim * self,
+    GstVideoFrame * ref_frame, GstVideoFrame * frame, GstBuffer ** outbuf,
+    gfloat * mean, gfloat * lowest, gfloat * highest)
+{
+  gboolean reconf;
+  GstBuffer *ref_luma, *luma;
+
+  reconf =
+      gst_validate_ssim_configure (self, ref_frame->info.width,
+      ref_frame->info.height);
+
+  ref_luma = gst_validate_ssim_get_luma (self, 0, reconf, ref_frame);
+  luma = gst_validate_ssim_get_luma (self, 1, reconf, frame);
+
+  if (ref_luma && luma)
+    gst_validate_ssim_compare_luma (self, ref_luma, luma, outbuf, mean,
+        lowest, highest);
+
+  if (ref_luma)
+    gst_buffer_unref (ref_luma);
+  if (luma)
+    gst_buffer_unref (luma);
+}
+
 static gboolean
 gst_validate_ssim_get_frame_from_png (GstValidateSsim * self, const char *file,
     GstVideoFrame * frame)
@@ -384,9 +430,9 @@ static gboolean
 gst_validate_ssim_get_frame_from_file (GstValidateSsim * self, const char *file,
     GstVideoFrame * frame)
 {
-  gchar *data;
   gsize length;
   GstBuffer *buf;
+  GMappedFile *mapped_file;
   GstVideoInfo info;
   GstVideoFormat format;
   gint strv_length, width, height;
@@ -440,7 +486,7 @@ gst_validate_ssim_get_frame_from_file (GstValidateSsim * self, const char *file,
   gst_video_info_init (&info);
   gst_video_info_set_format (&info, format, width, height);
 
-  if (!g_file_get_contents (file, &data, &length, &error)) {
+  if (!(mapped_file = g_mapped_file_new (file, FALSE, &error))) {
     GST_VALIDATE_REPORT (self, GENERAL_INPUT_ERROR, "Could not open %s: %s",
         file, error->message);
     g_error_free (error);
@@ -448,7 +494,10 @@ gst_validate_ssim_get_frame_from_file (GstValidateSsim * self, const char *file,
     goto fail;
   }
 
-  buf = gst_buffer_new_wrapped (data, length);
+  length = g_mapped_file_get_length (mapped_file);
+  buf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      g_mapped_file_get_contents (mapped_file), length, 0, length,
+      mapped_file, (GDestroyNotify) g_mapped_file_unref);
   if (!gst_video_frame_map (frame, &info, buf, GST_MAP_READ)) {
     gst_buffer_unref (buf);
     GST_VALIDATE_REPORT (self, GENERAL_INPUT_ERROR,
@@ -640,14 +689,123 @@ done:
   return real_ref_file;
 }
 
+static void
+ssim_reference_free (SSimReference * ref)
+{
+  g_free (ref->path);
+  gst_buffer_unref (ref->luma);
+
+  g_slice_free (SSimReference, ref);
+}
+
+static void
+gst_validate_ssim_remove_reference (GstValidateSsim * self,
+    SSimReference * ref)
+{
+  g_queue_unlink (&self->priv->references_lru, &ref->link);
+  self->priv->references_size -= gst_buffer_get_size (ref->luma);
+  g_hash_table_remove (self->priv->references, ref->path);
+}
+
+/* The modification time of @stats in nanoseconds, where the platform gives
+ * it, so that references rewritten within a second are noticed */
+static gint64
+gst_validate_ssim_get_mtime (const GStatBuf * stats)
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+  return (gint64) stats->st_mtim.tv_sec * G_GINT64_CONSTANT (1000000000) +
+      stats->st_mtim.tv_nsec;
+#else
+  return (gint64) stats->st_mtime * G_GINT64_CONSTANT (1000000000);
+#endif
+}
+
+/* Returns the luma plane of the reference frame stored in @path. When
+ * @cache is set, it is kept around and taken from the cache the next times
+ * if the file was not modified since then. */
+static GstBuffer *
+gst_validate_ssim_get_reference (GstValidateSsim * self, const gchar * path,
+    gboolean cache, gboolean * reconf)
+{
+  gsize size;
+  GStatBuf stats;
+  GstBuffer *luma;
+  GstVideoFrame frame;
+  gint64 mtime = -1;
+  SSimReference *ref;
+
+  if (!cache) {
+    if (!gst_validate_ssim_get_frame_from_file (self, path, &frame))
+      return NULL;
+
+    *reconf = gst_validate_ssim_configure (self, frame.info.width,
+        frame.info.height);
+    luma = gst_validate_ssim_get_luma (self, 0, *reconf, &frame);
+    gst_video_frame_unmap (&frame);
+
+    return luma;
+  }
+
+  if (g_stat (path, &stats) == 0)
+    mtime = gst_validate_ssim_get_mtime (&stats);
+
+  ref = g_hash_table_lookup (self->priv->references, path);
+  if (ref && ref->mtime == mtime) {
+    self->priv->references_hits++;
+    g_queue_unlink (&self->priv->references_lru, &ref->link);
+    g_queue_push_head_link (&self->priv->references_lru, &ref->link);
+
+    *reconf = gst_validate_ssim_configure (self, ref->width, ref->height);
+
+    return gst_buffer_ref (ref->luma);
+  }
+
+  self->priv->references_misses++;
+  if (ref)
+    gst_validate_ssim_remove_reference (self, ref);
+
+  if (!gst_validate_ssim_get_frame_from_file (self, path, &frame))
+    return NULL;
+
+  *reconf = gst_validate_ssim_configure (self, frame.info.width,
+      frame.info.height);
+  luma = gst_validate_ssim_get_luma (self, 0, *reconf, &frame);
+  gst_video_frame_unmap (&frame);
+
+  size = GST_ROUND_UP_4 (self->priv->width) * self->priv->height;
+  if (!luma || mtime == -1 || size > self->priv->references_max_size)
+    return luma;
+
+  ref = g_slice_new0 (SSimReference);
+  ref->path = g_strdup (path);
+  ref->mtime = mtime;
+  ref->width = self->priv->width;
+  ref->height = self->priv->height;
+  /* Only keep the luma plane, and do not keep the mapped file around */
+  ref->luma = gst_buffer_copy_region (luma, GST_BUFFER_COPY_MEMORY |
+      GST_BUFFER_COPY_DEEP, 0, size);
+  ref->link.data = ref;
+
+  g_hash_table_insert (self->priv->references, ref->path, ref);
+  g_queue_push_head_link (&self->priv->references_lru, &ref->link);
+  self->priv->references_size += size;
+
+  while (self->priv->references_size > self->priv->references_max_size)
+    gst_validate_ssim_remove_reference (self,
+        self->priv->references_lru.tail->data);
+
+  return luma;
+}
+
 static gboolean
 gst_validate_ssim_compare_image_file (GstValidateSsim * self,
     const gchar * ref_file, const gchar * file, gfloat * mean, gfloat * lowest,
     gfloat * highest, const gchar * outfolder)
 {
   GstBuffer *outbuf = NULL, **poutbuf = NULL;
-  gboolean res = TRUE;
-  GstVideoFrame ref_frame, frame;
+  GstBuffer *ref_luma, *luma;
+  gboolean res = TRUE, reconf;
+  GstVideoFrame frame;
   gchar *real_ref_file = NULL;
 
   real_ref_file = _get_ref_file_path (self, ref_file, file, FALSE);
@@ -658,12 +816,24 @@ gst_validate_ssim_compare_image_file (GstValidateSsim * self,
     goto fail;
   }
 
-  if (!gst_validate_ssim_get_frame_from_file (self, real_ref_file, &ref_frame))
+  /* References are only reused when they are picked among a set of frames
+   * by timestamp, several compared frames then falling on the same one. A
+   * reference given explicitly, as when comparing directories, is not worth
+   * keeping in memory */
+  if (!(ref_luma = gst_validate_ssim_get_reference (self, real_ref_file,
+              g_strcmp0 (ref_file, real_ref_file) != 0, &reconf)))
     goto fail;
 
-
   if (!gst_validate_ssim_get_frame_from_file (self, file, &frame)) {
-    gst_video_frame_unmap (&ref_frame);
+    gst_buffer_unref (ref_luma);
+
+    goto fail;
+  }
+
+  luma = gst_validate_ssim_get_luma (self, 1, reconf, &frame);
+  gst_video_frame_unmap (&frame);
+  if (!luma) {
+    gst_buffer_unref (ref_luma);
 
     goto fail;
   }
@@ -672,13 +842,12 @@ gst_validate_ssim_compare_image_file (GstValidateSsim * self,
     poutbuf = &outbuf;
   }
 
-  gst_validate_ssim_compare_frames (self, &ref_frame, &frame,
-      poutbuf, mean, lowest, highest);
+  gst_validate_ssim_compare_luma (self, ref_luma, luma, poutbuf, mean, lowest,
+      highest);
+  gst_buffer_unref (ref_luma);
+  gst_buffer_unref (luma);
 
   if (*mean < self->priv->min_avg_similarity) {
-    gst_video_frame_unmap (&ref_frame);
-    gst_video_frame_unmap (&frame);
-
     if (g_strcmp0 (ref_file, real_ref_file)) {
       gchar *tmpref = real_ref_file;
 
@@ -710,15 +879,9 @@ gst_validate_ssim_compare_image_file (GstValidateSsim * self,
         " than the minimum lowest similarity: %f", *lowest,
         real_ref_file, file, self->priv->min_lowest_similarity);
 
-    gst_video_frame_unmap (&ref_frame);
-    gst_video_frame_unmap (&frame);
-
     goto fail;
   }
 
-  gst_video_frame_unmap (&ref_frame);
-  gst_video_frame_unmap (&frame);
-
 done:
 
   g_free (real_ref_file);
@@ -736,16 +899,196 @@ fail:
   goto done;
 }
 
+typedef struct
+{
+  gint nfiles;
+  gint nnotfound;
+  gint nfailures;
+  gfloat min_avg;
+  gfloat min_min;
+  gfloat total_avg;
+} SSimDirectoryStats;
+
+static void
+_directory_stats_add (SSimDirectoryStats * stats, const gchar * name,
+    gboolean found, gboolean res, gfloat mean, gfloat lowest)
+{
+  if (!found)
+    stats->nnotfound++;
+  else if (!res)
+    stats->nfailures++;
+  else
+    stats->nfiles++;
+
+  stats->min_avg = MIN (stats->min_avg, mean);
+  stats->min_min = MIN (stats->min_min, lowest);
+  stats->total_avg += mean;
+  gst_validate_printf (NULL,
+      "<position: %s duration: %" GST_TIME_FORMAT
+      " avg: %f min: %f (Passed: %d failed: %d, %d not found)/>\r",
+      name, GST_TIME_ARGS (GST_CLOCK_TIME_NONE),
+      mean, lowest, stats->nfiles, stats->nfailures, stats->nnotfound);
+}
+
+static void
+_directory_stats_print (SSimDirectoryStats * stats)
+{
+  if (stats->nfiles == 0) {
+    gst_validate_printf (NULL, "\nNo files to verify.\n");
+  } else {
+    gst_validate_printf (NULL,
+        "\nAverage similarity: %f, min_avg: %f, min_min: %f\n",
+        stats->total_avg / stats->nfiles, stats->min_avg, stats->min_min);
+  }
+}
+
+typedef struct
+{
+  gchar *name;
+  gchar *ref_file;
+  gchar *compared_file;
+
+  /* Set by the worker */
+  gboolean done;
+  gboolean res;
+  gfloat mean;
+  gfloat lowest;
+  gfloat highest;
+} SSimDirectoryEntry;
+
+typedef struct
+{
+  const gchar *outfolder;
+
+  /* Idle GstValidateSsim, one per worker */
+  GAsyncQueue *contexts;
+
+  GMutex lock;
+  GCond cond;
+} SSimDirectoryCheck;
+
+static void
+_directory_entry_clear (SSimDirectoryEntry * entry)
+{
+  g_free (entry->name);
+  g_free (entry->ref_file);
+  g_free (entry->compared_file);
+}
+
+static void
+_check_directory_entry (SSimDirectoryEntry * entry, SSimDirectoryCheck * check)
+{
+  GstValidateSsim *context = g_async_queue_pop (check->contexts);
+  gfloat mean = NAN, lowest = NAN, highest = NAN;
+  gboolean res;
+
+  res = gst_validate_ssim_compare_image_files (context, entry->ref_file,
+      entry->compared_file, &mean, &lowest, &highest, check->outfolder);
+
+  g_async_queue_push (check->contexts, context);
+
+  g_mutex_lock (&check->lock);
+  entry->res = res;
+  entry->mean = mean;
+  entry->lowest = lowest;
+  entry->highest = highest;
+  entry->done = TRUE;
+  g_cond_broadcast (&check->cond);
+  g_mutex_unlock (&check->lock);
+}
+
+/* Compares the files across self->priv->jobs workers, each with its own
+ * GstValidateSsim, and accounts for the results in the directory order so
+ * that the output is the same as when comparing them serially. */
+static gboolean
+_check_directory_parallel (GstValidateSsim * self, GArray * entries,
+    gfloat * mean, gfloat * lowest, gfloat * highest, const gchar * outfolder)
+{
+  guint i;
+  gboolean res = TRUE;
+  GThreadPool *pool;
+  SSimDirectoryCheck check;
+  GstValidateRunner *runner;
+  SSimDirectoryStats stats = { 0, 0, 0, 1.0, 1.0, 0 };
+
+  check.outfolder = outfolder;
+  check.contexts = g_async_queue_new ();
+  g_mutex_init (&check.lock);
+  g_cond_init (&check.cond);
+
+  runner = gst_validate_reporter_get_runner (GST_VALIDATE_REPORTER (self));
+  for (i = 0; i < self->priv->jobs; i++) {
+    GstValidateSsim *context = gst_validate_ssim_new (runner,
+        self->priv->min_avg_similarity, self->priv->min_lowest_similarity);
+
+    g_async_queue_push (check.contexts, context);
+  }
+
+  pool = g_thread_pool_new ((GFunc) _check_directory_entry, &check,
+      self->priv->jobs, TRUE, NULL);
+  for (i = 0; i < entries->len; i++) {
+    SSimDirectoryEntry *entry = &g_array_index (entries, SSimDirectoryEntry, i);
+
+    if (entry->ref_file)
+      g_thread_pool_push (pool, entry, NULL);
+  }
+
+  for (i = 0; i < entries->len; i++) {
+    SSimDirectoryEntry *entry = &g_array_index (entries, SSimDirectoryEntry, i);
+
+    if (!entry->ref_file) {
+      GST_INFO_OBJECT (self, "Could not find file %s", entry->compared_file);
+      res = FALSE;
+      _directory_stats_add (&stats, entry->name, FALSE, FALSE, *mean,
+          *lowest);
+      continue;
+    }
+
+    g_mutex_lock (&check.lock);
+    while (!entry->done)
+      g_cond_wait (&check.cond, &check.lock);
+    g_mutex_unlock (&check.lock);
+
+    /* Like in serial mode, a comparison that could not be done leaves the
+     * values of the previous one */
+    if (!isnan (entry->mean)) {
+      *mean = entry->mean;
+      *lowest = entry->lowest;
+      *highest = entry->highest;
+    }
+
+    if (!entry->res)
+      res = FALSE;
+    _directory_stats_add (&stats, entry->name, TRUE, entry->res, *mean,
+        *lowest);
+  }
+  _directory_stats_print (&stats);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  for (i = 0; i < self->priv->jobs; i++) {
+    GstValidateSsim *context = g_async_queue_pop (check.contexts);
+
+    gst_object_unref (context);
+  }
+  g_async_queue_unref (check.contexts);
+  g_mutex_clear (&check.lock);
+  g_cond_clear (&check.cond);
+  if (runner)
+    gst_object_unref (runner);
+
+  return res;
+}
+
 static gboolean
 _check_directory (GstValidateSsim * self, const gchar * ref_dir,
     const gchar * compared_dir, gfloat * mean, gfloat * lowest,
     gfloat * highest, const gchar * outfolder)
 {
-  gint nfiles = 0, nnotfound = 0, nfailures = 0;
   gboolean res = TRUE;
   GFileInfo *info;
   GFileEnumerator *fenum;
-  gfloat min_avg = 1.0, min_min = 1.0, total_avg = 0;
+  GArray *entries = NULL;
+  SSimDirectoryStats stats = { 0, 0, 0, 1.0, 1.0, 0 };
   GFile *file = g_file_new_for_path (ref_dir);
 
   if (!(fenum = g_file_enumerate_children (file,
@@ -756,6 +1099,11 @@ _check_directory (GstValidateSsim * self, const gchar * ref_dir,
     goto done;
   }
 
+  if (self->priv->jobs > 1) {
+    entries = g_array_new (FALSE, TRUE, sizeof (SSimDirectoryEntry));
+    g_array_set_clear_func (entries, (GDestroyNotify) _directory_entry_clear);
+  }
+
   for (info = g_file_enumerator_next_file (fenum, NULL, NULL);
       info; info = g_file_enumerator_next_file (fenum, NULL, NULL)) {
 
@@ -764,34 +1112,37 @@ _check_directory (GstValidateSsim * self, const gchar * ref_dir,
       gchar *compared_file = g_build_path (G_DIR_SEPARATOR_S,
           compared_dir, g_file_info_get_name (info), NULL);
       gchar *ref_file = NULL;
+      gboolean found, file_res = FALSE;
 
-      if (!g_file_test (compared_file, G_FILE_TEST_IS_REGULAR)) {
-        GST_INFO_OBJECT (self, "Could not find file %s", compared_file);
-        nnotfound++;
-        res = FALSE;
-      } else {
-
+      found = g_file_test (compared_file, G_FILE_TEST_IS_REGULAR);
+      if (found)
         ref_file =
             g_build_path (G_DIR_SEPARATOR_S, ref_dir,
             g_file_info_get_name (info), NULL);
-        if (!gst_validate_ssim_compare_image_files (self, ref_file,
-                compared_file, mean, lowest, highest, outfolder)) {
-          nfailures++;
-          res = FALSE;
-        } else {
-          nfiles++;
-        }
+
+      if (entries) {
+        SSimDirectoryEntry entry = { 0, };
+
+        entry.name = g_strdup (g_file_info_get_display_name (info));
+        entry.ref_file = ref_file;
+        entry.compared_file = compared_file;
+        g_array_append_val (entries, entry);
+        g_object_unref (info);
+
+        continue;
+      }
+
+      if (!found) {
+        GST_INFO_OBJECT (self, "Could not find file %s", compared_file);
+      } else {
+        file_res = gst_validate_ssim_compare_image_files (self, ref_file,
+            compared_file, mean, lowest, highest, outfolder);
       }
 
-      min_avg = MIN (min_avg, *mean);
-      min_min = MIN (min_min, *lowest);
-      total_avg += *mean;
-      gst_validate_printf (NULL,
-          "<position: %s duration: %" GST_TIME_FORMAT
-          " avg: %f min: %f (Passed: %d failed: %d, %d not found)/>\r",
-          g_file_info_get_display_name (info),
-          GST_TIME_ARGS (GST_CLOCK_TIME_NONE),
-          *mean, *lowest, nfiles, nfailures, nnotfound);
+      if (!file_res)
+        res = FALSE;
+      _directory_stats_add (&stats, g_file_info_get_display_name (info),
+          found, file_res, *mean, *lowest);
 
       g_free (compared_file);
       g_free (ref_file);
@@ -800,18 +1151,18 @@ _check_directory (GstValidateSsim * self, const gchar * ref_dir,
     g_object_unref (info);
   }
 
-  if (nfiles == 0) {
-    gst_validate_printf (NULL, "\nNo files to verify.\n");
-  } else {
-    gst_validate_printf (NULL,
-        "\nAverage similarity: %f, min_avg: %f, min_min: %f\n",
-        total_avg / nfiles, min_avg, min_min);
-  }
+  if (entries)
+    res = _check_directory_parallel (self, entries, mean, lowest, highest,
+        outfolder);
+  else
+    _directory_stats_print (&stats);
 
 done:
   gst_object_unref (file);
   if (fenum)
     gst_object_unref (fenum);
+  if (entries)
+    g_array_unref (entries);
 
   return res;
 }
@@ -837,6 +1188,61 @@ gst_validate_ssim_compare_image_files (GstValidateSsim * self,
   }
 }
 
+/**
+ * gst_validate_ssim_set_jobs:
+ * @self: a #GstValidateSsim
+ * @jobs: the number of files to compare in parallel
+ *
+ * Sets how many files gst_validate_ssim_compare_image_files() compares in
+ * parallel when comparing directories. Each worker decodes, converts and
+ * compares files with its own context. The aggregated results are the same
+ * as when comparing serially, which is the default (@jobs <= 1).
+ */
+void
+gst_validate_ssim_set_jobs (GstValidateSsim * self, guint jobs)
+{
+  self->priv->jobs = jobs;
+}
+
+/**
+ * gst_validate_ssim_set_reference_cache_size:
+ * @self: a #GstValidateSsim
+ * @max_size: the maximum size in bytes of the reference frames cache
+ *
+ * When the reference is picked by timestamp among the frames matching a
+ * pattern, several compared files can fall on the same reference frame, so
+ * those frames are kept converted in memory and only loaded and converted
+ * once. This sets how much memory can be used for that, the least recently
+ * used references being dropped first. References given explicitly, as when
+ * comparing directories, are never cached.
+ */
+void
+gst_validate_ssim_set_reference_cache_size (GstValidateSsim * self,
+    guint64 max_size)
+{
+  self->priv->references_max_size = max_size;
+
+  while (self->priv->references_size > self->priv->references_max_size)
+    gst_validate_ssim_remove_reference (self,
+        self->priv->references_lru.tail->data);
+}
+
+/**
+ * gst_validate_ssim_get_reference_cache_stats:
+ * @self: a #GstValidateSsim
+ * @hits: (out) (allow-none): the number of references found in the cache
+ * @misses: (out) (allow-none): the number of references loaded from disk
+ */
+void
+gst_validate_ssim_get_reference_cache_stats (GstValidateSsim * self,
+    guint * hits, guint * misses)
+{
+  if (hits)
+    *hits = self->priv->references_hits;
+  if (misses)
+    *misses = self->priv->references_misses;
+}
+
 static void
 gst_validate_ssim_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec)
@@ -894,6 +1300,7 @@ gst_validate_ssim_finalize (GObject * object)
   if (self->priv->outconverter_info.converter)
     gst_video_converter_free (self->priv->outconverter_info.converter);
   g_hash_table_unref (self->priv->ref_frames_cache);
+  g_hash_table_unref (self->priv->references);
 
   chain_up (object);
 }
@@ -962,6 +1369,10 @@ gst_validate_ssim_init (GstValidateSsim * self)
   self->priv->ssim = gssim_new ();
   self->priv->ref_frames_cache = g_hash_table_new_full (g_str_hash,
       g_str_equal, g_free, (GDestroyNotify) g_array_unref);
+  self->priv->references = g_hash_table_new_full (g_str_hash, g_str_equal,
+      NULL, (GDestroyNotify) ssim_reference_free);
+  g_queue_init (&self->priv->references_lru);
+  self->priv->references_max_size = DEFAULT_REFERENCE_CACHE_SIZE;
 }
 
 GstValidateSsim *
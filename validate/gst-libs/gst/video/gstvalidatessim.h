@@ -68,6 +68,12 @@ void gst_validate_ssim_compare_frames           (GstValidateSsim * self, GstVide
                                                  GstVideoFrame *frame, GstBuffer **outbuf,
                                                  gfloat * mean, gfloat * lowest, gfloat * highest);
 
+void gst_validate_ssim_set_jobs                 (GstValidateSsim * self, guint jobs);
+
+void gst_validate_ssim_set_reference_cache_size (GstValidateSsim * self, guint64 max_size);
+void gst_validate_ssim_get_reference_cache_stats (GstValidateSsim * self, guint * hits,
+                                                  guint * misses);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,556 @@
+/* GStreamer
+ *
+ * gst-validate-checksum.c - Checksum engine used to verify buffers content
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gst-validate-checksum
+ * @short_description: Incremental checksumming of buffers
+ *
+ * #GstValidateChecksum computes checksums of buffers incrementally, memory by
+ * memory, so that multi-memory buffers never need to be merged. On top of the
+ * cryptographic hashes provided by #GChecksum it implements XXH64, a fast
+ * non-cryptographic hash which should be preferred when checksumming big raw
+ * video frames.
+ *
+ * Video frames can also be checksummed plane by plane, only taking into
+ * account the visible part of each row, which makes the checksum independent
+ * of the strides used by the element that produced the frame.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gst-validate-checksum.h"
+
+#define XXH64_PRIME_1 G_GUINT64_CONSTANT (0x9E3779B185EBCA87)
+#define XXH64_PRIME_2 G_GUINT64_CONSTANT (0xC2B2AE3D27D4EB4F)
+#define XXH64_PRIME_3 G_GUINT64_CONSTANT (0x165667B19E3779F9)
+#define XXH64_PRIME_4 G_GUINT64_CONSTANT (0x85EBCA77C2B2AE63)
+#define XXH64_PRIME_5 G_GUINT64_CONSTANT (0x27D4EB2F165667C5)
+
+#define XXH64_STRIPE_SIZE 32
+
+typedef struct
+{
+  guint64 total_len;
+  guint64 acc[4];
+  guint8 mem[XXH64_STRIPE_SIZE];
+  guint memsize;
+} Xxh64State;
+
+struct _GstValidateChecksum
+{
+  GstValidateChecksumType type;
+
+  /* Used for the cryptographic hashes */
+  GChecksum *gchecksum;
+
+  Xxh64State xxh64;
+
+  gchar *digest;
+};
+
+static const struct
+{
+  GstValidateChecksumType type;
+  const gchar *name;
+} checksum_names[] = {
+  {GST_VALIDATE_CHECKSUM_TYPE_MD5, "md5"},
+  {GST_VALIDATE_CHECKSUM_TYPE_SHA1, "sha1"},
+  {GST_VALIDATE_CHECKSUM_TYPE_SHA256, "sha256"},
+  {GST_VALIDATE_CHECKSUM_TYPE_XXH64, "xxh64"},
+};
+
+static inline guint64
+_xxh64_rotl (guint64 x, guint r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline guint64
+_xxh64_read64 (const guint8 * p)
+{
+  guint64 v;
+
+  memcpy (&v, p, sizeof (v));
+  return GUINT64_FROM_LE (v);
+}
+
+static inline guint32
+_xxh64_read32 (const guint8 * p)
+{
+  guint32 v;
+
+  memcpy (&v, p, sizeof (v));
+  return GUINT32_FROM_LE (v);
+}
+
+static inline guint64
+_xxh64_round (guint64 acc, guint64 input)
+{
+  acc += input * XXH64_PRIME_2;
+  acc = _xxh64_rotl (acc, 31);
+
+  return acc * XXH64_PRIME_1;
+}
+
+static inline guint64
+_xxh64_merge_round (guint64 acc, guint64 val)
+{
+  acc ^= _xxh64_round (0, val);
+
+  return acc * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+static void
+_xxh64_reset (Xxh64State * state)
+{
+  memset (state, 0, sizeof (Xxh64State));
+  state->acc[0] = XXH64_PRIME_1 + XXH64_PRIME_2;
+  state->acc[1] = XXH64_PRIME_2;
+  state->acc[2] = 0;
+  state->acc[3] = -XXH64_PRIME_1;
+}
+
+static inline void
+_xxh64_consume_stripe (Xxh64State * state, const guint8 * p)
+{
+  state->acc[0] = _xxh64_round (state->acc[0], _xxh64_read64 (p));
+  state->acc[1] = _xxh64_round (state->acc[1], _xxh64_read64 (p + 8));
+  state->acc[2] = _xxh64_round (state->acc[2], _xxh64_read64 (p + 16));
+  state->acc[3] = _xxh64_round (state->acc[3], _xxh64_read64 (p + 24));
+}
+
+static void
+_xxh64_update (Xxh64State * state, const guint8 * p, gsize len)
+{
+  const guint8 *end = p + len;
+
+  state->total_len += len;
+
+  if (state->memsize + len < XXH64_STRIPE_SIZE) {
+    memcpy (state->mem + state->memsize, p, len);
+    state->memsize += len;
+    return;
+  }
+
+  if (state->memsize) {
+    gsize fill = XXH64_STRIPE_SIZE - state->memsize;
+
+    memcpy (state->mem + state->memsize, p, fill);
+    _xxh64_consume_stripe (state, state->mem);
+    p += fill;
+    state->memsize = 0;
+  }
+
+  while (end - p >= XXH64_STRIPE_SIZE) {
+    _xxh64_consume_stripe (state, p);
+    p += XXH64_STRIPE_SIZE;
+  }
+
+  if (p < end) {
+    memcpy (state->mem, p, end - p);
+    state->memsize = end - p;
+  }
+}
+
+static guint64
+_xxh64_digest (Xxh64State * state)
+{
+  guint64 h;
+  const guint8 *p = state->mem;
+  guint len = state->memsize;
+
+  if (state->total_len >= XXH64_STRIPE_SIZE) {
+    h = _xxh64_rotl (state->acc[0], 1) + _xxh64_rotl (state->acc[1], 7) +
+        _xxh64_rotl (state->acc[2], 12) + _xxh64_rotl (state->acc[3], 18);
+    h = _xxh64_merge_round (h, state->acc[0]);
+    h = _xxh64_merge_round (h, state->acc[1]);
+    h = _xxh64_merge_round (h, state->acc[2]);
+    h = _xxh64_merge_round (h, state->acc[3]);
+  } else {
+    h = state->acc[2] + XXH64_PRIME_5;
+  }
+
+  h += state->total_len;
+
+  while (len >= 8) {
+    h ^= _xxh64_round (0, _xxh64_read64 (p));
+    h = _xxh64_rotl (h, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+    p += 8;
+    len -= 8;
+  }
+
+  if (len >= 4) {
+    h ^= (guint64) _xxh64_read32 (p) * XXH64_PRIME_1;
+    h = _xxh64_rotl (h, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+    p += 4;
+    len -= 4;
+  }
+
+  while (len > 0) {
+    h ^= (*p) * XXH64_PRIME_5;
+    h = _xxh64_rotl (h, 11) * XXH64_PRIME_1;
+    p++;
+    len--;
+  }
+
+  h ^= h >> 33;
+  h *= XXH64_PRIME_2;
+  h ^= h >> 29;
+  h *= XXH64_PRIME_3;
+  h ^= h >> 32;
+
+  return h;
+}
+
+/**
+ * gst_validate_checksum_type_get_name:
+ * @type: A #GstValidateChecksumType
+ *
+ * Returns: The name of @type as used in media descriptors and scenarios
+ */
+const gchar *
+gst_validate_checksum_type_get_name (GstValidateChecksumType type)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (checksum_names); i++) {
+    if (checksum_names[i].type == type)
+      return checksum_names[i].name;
+  }
+
+  return NULL;
+}
+
+/**
+ * gst_validate_checksum_type_from_name:
+ * @name: The name of a checksum type
+ * @type: (out): The #GstValidateChecksumType matching @name
+ *
+ * Returns: %TRUE if @name is a known checksum type, %FALSE otherwise
+ */
+gboolean
+gst_validate_checksum_type_from_name (const gchar * name,
+    GstValidateChecksumType * type)
+{
+  guint i;
+
+  g_return_val_if_fail (name, FALSE);
+
+  for (i = 0; i < G_N_ELEMENTS (checksum_names); i++) {
+    if (!g_ascii_strcasecmp (checksum_names[i].name, name)) {
+      *type = checksum_names[i].type;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+ * gst_validate_checksum_new: (skip):
+ * @type: The algorithm to use
+ *
+ * Returns: A newly allocated #GstValidateChecksum, free with
+ * #gst_validate_checksum_free
+ */
+GstValidateChecksum *
+gst_validate_checksum_new (GstValidateChecksumType type)
+{
+  GstValidateChecksum *checksum = g_slice_new0 (GstValidateChecksum);
+
+  checksum->type = type;
+  switch (type) {
+    case GST_VALIDATE_CHECKSUM_TYPE_MD5:
+      checksum->gchecksum = g_checksum_new (G_CHECKSUM_MD5);
+      break;
+    case GST_VALIDATE_CHECKSUM_TYPE_SHA1:
+      checksum->gchecksum = g_checksum_new (G_CHECKSUM_SHA1);
+      break;
+    case GST_VALIDATE_CHECKSUM_TYPE_SHA256:
+      checksum->gchecksum = g_checksum_new (G_CHECKSUM_SHA256);
+      break;
+    case GST_VALIDATE_CHECKSUM_TYPE_XXH64:
+      _xxh64_reset (&checksum->xxh64);
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+
+  return checksum;
+}
+
+void
+gst_validate_checksum_free (GstValidateChecksum * checksum)
+{
+  if (checksum->gchecksum)
+    g_checksum_free (checksum->gchecksum);
+  g_free (checksum->digest);
+
+  g_slice_free (GstValidateChecksum, checksum);
+}
+
+/**
+ * gst_validate_checksum_reset: (skip):
+ * @checksum: A #GstValidateChecksum
+ *
+ * Resets @checksum so it can be reused to compute a new checksum.
+ */
+void
+gst_validate_checksum_reset (GstValidateChecksum * checksum)
+{
+  if (checksum->gchecksum)
+    g_checksum_reset (checksum->gchecksum);
+  else
+    _xxh64_reset (&checksum->xxh64);
+
+  g_clear_pointer (&checksum->digest, g_free);
+}
+
+/**
+ * gst_validate_checksum_update: (skip):
+ * @checksum: A #GstValidateChecksum
+ * @data: The data to feed
+ * @length: The size of @data
+ *
+ * Feeds @data into @checksum. This can not be called once
+ * #gst_validate_checksum_get_string has been called, unless
+ * #gst_validate_checksum_reset is called first.
+ */
+void
+gst_validate_checksum_update (GstValidateChecksum * checksum,
+    const guint8 * data, gsize length)
+{
+  g_return_if_fail (checksum->digest == NULL);
+
+  if (checksum->gchecksum)
+    g_checksum_update (checksum->gchecksum, data, length);
+  else
+    _xxh64_update (&checksum->xxh64, data, length);
+}
+
+/**
+ * gst_validate_checksum_update_buffer: (skip):
+ * @checksum: A #GstValidateChecksum
+ * @buffer: The buffer to feed
+ *
+ * Feeds the content of @buffer into @checksum, mapping its memories one
+ * by one so multi-memory buffers are never merged.
+ *
+ * Returns: %TRUE if all memories of @buffer could be mapped
+ */
+gboolean
+gst_validate_checksum_update_buffer (GstValidateChecksum * checksum,
+    GstBuffer * buffer)
+{
+  guint i, n_mem = gst_buffer_n_memory (buffer);
+
+  for (i = 0; i < n_mem; i++) {
+    GstMapInfo map;
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+
+    if (!gst_memory_map (mem, &map, GST_MAP_READ))
+      return FALSE;
+
+    gst_validate_checksum_update (checksum, map.data, map.size);
+    gst_memory_unmap (mem, &map);
+  }
+
+  return TRUE;
+}
+
+static gsize
+_get_video_plane_row_size (GstVideoFrame * frame, guint plane,
+    guint * n_rows)
+{
+  guint i;
+  gsize row_size = 0;
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+
+  *n_rows = 0;
+  for (i = 0; i < GST_VIDEO_FRAME_N_COMPONENTS (frame); i++) {
+    if (GST_VIDEO_FORMAT_INFO_PLANE (finfo, i) != plane)
+      continue;
+
+    row_size = MAX (row_size, (gsize) GST_VIDEO_FRAME_COMP_PSTRIDE (frame, i)
+        * GST_VIDEO_FRAME_COMP_WIDTH (frame, i));
+    *n_rows = MAX (*n_rows, GST_VIDEO_FRAME_COMP_HEIGHT (frame, i));
+  }
+
+  /* Formats with components sharing bytes (v210, UYVP...) have no pixel
+   * stride, consider the whole row as visible */
+  if (!row_size
+      || row_size > (gsize) GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane))
+    row_size = GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+
+  return row_size;
+}
+
+/**
+ * gst_validate_checksum_update_video_frame: (skip):
+ * @checksum: A #GstValidateChecksum
+ * @frame: A mapped #GstVideoFrame
+ *
+ * Feeds the visible part of each row of each plane of @frame into @checksum,
+ * ignoring the padding at the end of the rows. The resulting checksum does
+ * not depend on the strides used for @frame.
+ *
+ * Returns: %TRUE if @frame could be checksummed, %FALSE if its format is not
+ * supported (tiled formats).
+ */
+gboolean
+gst_validate_checksum_update_video_frame (GstValidateChecksum * checksum,
+    GstVideoFrame * frame)
+{
+  guint plane;
+
+  if (GST_VIDEO_FORMAT_INFO_IS_TILED (frame->info.finfo))
+    return FALSE;
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (frame); plane++) {
+    guint row, n_rows;
+    const guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, plane);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+    gsize row_size = _get_video_plane_row_size (frame, plane, &n_rows);
+
+    if (row_size == (gsize) stride) {
+      gst_validate_checksum_update (checksum, data, row_size * n_rows);
+      continue;
+    }
+
+    for (row = 0; row < n_rows; row++)
+      gst_validate_checksum_update (checksum, data + row * stride, row_size);
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_validate_checksum_update_video_buffer: (skip):
+ * @checksum: A #GstValidateChecksum
+ * @buffer: The buffer to feed
+ * @caps: (allow-none): The caps of @buffer
+ *
+ * Feeds @buffer as a video frame when @caps are raw video caps, only taking
+ * into account the visible part of each row as
+ * #gst_validate_checksum_update_video_frame does. The planes are mapped one
+ * by one when @buffer has a #GstVideoMeta, so its memories are not merged.
+ * Other buffers, and the ones that can not be mapped as a video frame, are
+ * fed with #gst_validate_checksum_update_buffer.
+ *
+ * Returns: %TRUE if @buffer could be mapped, %FALSE otherwise
+ */
+gboolean
+gst_validate_checksum_update_video_buffer (GstValidateChecksum * checksum,
+    GstBuffer * buffer, GstCaps * caps)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  gboolean ret;
+
+  if (!caps || !gst_video_info_from_caps (&info, caps)
+      || GST_VIDEO_FORMAT_INFO_IS_TILED (info.finfo))
+    return gst_validate_checksum_update_buffer (checksum, buffer);
+
+  /* e.g. a buffer smaller than the frame its caps describe */
+  if (!gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ))
+    return gst_validate_checksum_update_buffer (checksum, buffer);
+
+  ret = gst_validate_checksum_update_video_frame (checksum, &frame);
+  gst_video_frame_unmap (&frame);
+
+  return ret;
+}
+
+/**
+ * gst_validate_checksum_get_string: (skip):
+ * @checksum: A #GstValidateChecksum
+ *
+ * Returns: (transfer none): The hexadecimal representation of the checksum
+ */
+const gchar *
+gst_validate_checksum_get_string (GstValidateChecksum * checksum)
+{
+  if (checksum->digest)
+    return checksum->digest;
+
+  if (checksum->gchecksum)
+    checksum->digest = g_strdup (g_checksum_get_string (checksum->gchecksum));
+  else
+    checksum->digest = g_strdup_printf ("%016" G_GINT64_MODIFIER "x",
+        _xxh64_digest (&checksum->xxh64));
+
+  return checksum->digest;
+}
+
+/**
+ * gst_validate_checksum_get_digest: (skip):
+ * @checksum: A #GstValidateChecksum
+ * @digest: (out caller-allocates): A buffer of at least
+ * #GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE bytes
+ *
+ * Gets the checksum in binary form, with the same byte order as its
+ * hexadecimal representation, without allocating it. @checksum must be
+ * reset before being fed more data.
+ *
+ * Returns: The number of bytes written to @digest
+ */
+gsize
+gst_validate_checksum_get_digest (GstValidateChecksum * checksum,
+    guint8 * digest)
+{
+  gsize len = GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE;
+
+  if (checksum->gchecksum) {
+    g_checksum_get_digest (checksum->gchecksum, digest, &len);
+  } else {
+    guint64 h = GUINT64_TO_BE (_xxh64_digest (&checksum->xxh64));
+
+    len = sizeof (h);
+    memcpy (digest, &h, len);
+  }
+
+  return len;
+}
+
+/**
+ * gst_validate_compute_checksum_for_buffer:
+ * @type: The algorithm to use
+ * @buffer: The buffer to checksum
+ *
+ * Returns: (transfer full) (nullable): The checksum of the content of @buffer
+ * as an hexadecimal string, or %NULL if @buffer could not be mapped.
+ */
+gchar *
+gst_validate_compute_checksum_for_buffer (GstValidateChecksumType type,
+    GstBuffer * buffer)
+{
+  gchar *res = NULL;
+  GstValidateChecksum *checksum = gst_validate_checksum_new (type);
+
+  if (gst_validate_checksum_update_buffer (checksum, buffer))
+    res = g_strdup (gst_validate_checksum_get_string (checksum));
+  gst_validate_checksum_free (checksum);
+
+  return res;
+}
@@ -0,0 +1,96 @@
+/* GStreamer
+ *
+ * gst-validate-checksum.h - Checksum engine used to verify buffers content
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_VALIDATE_CHECKSUM_H__
+#define __GST_VALIDATE_CHECKSUM_H__
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/validate/validate-prelude.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstValidateChecksumType:
+ * @GST_VALIDATE_CHECKSUM_TYPE_MD5: MD5, the historical default for
+ * media descriptors
+ * @GST_VALIDATE_CHECKSUM_TYPE_SHA1: SHA-1
+ * @GST_VALIDATE_CHECKSUM_TYPE_SHA256: SHA-256
+ * @GST_VALIDATE_CHECKSUM_TYPE_XXH64: XXH64, a fast non-cryptographic hash,
+ * meant to be used when checksumming big raw buffers
+ *
+ * The algorithm used to compute buffers checksums.
+ */
+typedef enum {
+  GST_VALIDATE_CHECKSUM_TYPE_MD5 = 0,
+  GST_VALIDATE_CHECKSUM_TYPE_SHA1,
+  GST_VALIDATE_CHECKSUM_TYPE_SHA256,
+  GST_VALIDATE_CHECKSUM_TYPE_XXH64,
+} GstValidateChecksumType;
+
+/**
+ * GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE:
+ *
+ * The size of the largest binary digest computed by #GstValidateChecksum.
+ */
+#define GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE 32
+
+typedef struct _GstValidateChecksum GstValidateChecksum;
+
+GST_VALIDATE_API
+const gchar *         gst_validate_checksum_type_get_name     (GstValidateChecksumType type);
+GST_VALIDATE_API
+gboolean              gst_validate_checksum_type_from_name    (const gchar * name,
+                                                               GstValidateChecksumType * type);
+
+GST_VALIDATE_API
+GstValidateChecksum * gst_validate_checksum_new               (GstValidateChecksumType type);
+GST_VALIDATE_API
+void                  gst_validate_checksum_free              (GstValidateChecksum * checksum);
+GST_VALIDATE_API
+void                  gst_validate_checksum_reset             (GstValidateChecksum * checksum);
+GST_VALIDATE_API
+void                  gst_validate_checksum_update            (GstValidateChecksum * checksum,
+                                                               const guint8 * data,
+                                                               gsize length);
+GST_VALIDATE_API
+gboolean              gst_validate_checksum_update_buffer     (GstValidateChecksum * checksum,
+                                                               GstBuffer * buffer);
+GST_VALIDATE_API
+gboolean              gst_validate_checksum_update_video_frame (GstValidateChecksum * checksum,
+                                                               GstVideoFrame * frame);
+GST_VALIDATE_API
+gboolean              gst_validate_checksum_update_video_buffer (GstValidateChecksum * checksum,
+                                                               GstBuffer * buffer,
+                                                               GstCaps * caps);
+GST_VALIDATE_API
+const gchar *         gst_validate_checksum_get_string        (GstValidateChecksum * checksum);
+GST_VALIDATE_API
+gsize                 gst_validate_checksum_get_digest        (GstValidateChecksum * checksum,
+                                                               guint8 * digest);
+
+GST_VALIDATE_API
+gchar *               gst_validate_compute_checksum_for_buffer (GstValidateChecksumType type,
+                                                               GstBuffer * buffer);
+
+G_END_DECLS
+
+#endif /* __GST_VALIDATE_CHECKSUM_H__ */
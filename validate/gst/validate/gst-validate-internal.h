@@ -25,7 +25,9 @@
 #include <gst/gst.h>
 #include "gst-validate-scenario.h"
 #include "gst-validate-monitor.h"
+#include "media-descriptor.h"
 #include <json-glib/json-glib.h>
+#include <glib/gstdio.h>
 
 extern G_GNUC_INTERNAL GstDebugCategory *gstvalidate_debug;
 #define GST_CAT_DEFAULT gstvalidate_debug
@@ -50,10 +52,22 @@ G_GNUC_INTERNAL gboolean gst_validate_action_is_subaction (GstValidateAction *ac
 G_GNUC_INTERNAL void _priv_validate_override_registry_deinit (void);
 
 G_GNUC_INTERNAL GstValidateReportingDetails gst_validate_runner_get_default_reporting_details (GstValidateRunner *runner);
+G_GNUC_INTERNAL gboolean gst_validate_runner_has_reporting_level_patterns (GstValidateRunner *runner);
+G_GNUC_INTERNAL void gst_validate_runner_add_repeated_report (GstValidateRunner *runner, GstValidateReport *report, GstValidateReport *repeated_report);
 
 G_GNUC_INTERNAL GstValidateMonitor * gst_validate_get_monitor (GObject *object);
+G_GNUC_INTERNAL GList * gst_validate_monitor_get_overrides_unlocked (GstValidateMonitor *monitor);
 G_GNUC_INTERNAL void gst_validate_init_runner (void);
 G_GNUC_INTERNAL void gst_validate_deinit_runner (void);
 G_GNUC_INTERNAL void gst_validate_report_deinit (void);
 G_GNUC_INTERNAL gboolean gst_validate_send (JsonNode * root);
+
+/* Fills @expected_frames with the frames of @streamnode if not %NULL, or
+ * adds them to @streamnode otherwise. Called with the descriptor lock. */
+typedef void (*GstValidateMediaDescriptorFramesLoader) (GstValidateMediaDescriptor * self, GstValidateMediaStreamNode * streamnode, GArray * expected_frames);
+G_GNUC_INTERNAL void gst_validate_media_descriptor_set_frames_loader (GstValidateMediaDescriptor * self, GstValidateMediaDescriptorFramesLoader loader);
+G_GNUC_INTERNAL void gst_validate_media_descriptor_ensure_frames (GstValidateMediaDescriptor * self);
+G_GNUC_INTERNAL guint8 gst_validate_media_descriptor_parse_checksum (const gchar * str, guint8 * digest);
+G_GNUC_INTERNAL gint64 gst_validate_utils_get_mtime (const GStatBuf * st);
+G_GNUC_INTERNAL void gst_validate_utils_deinit (void);
 #endif
@@ -27,6 +27,7 @@
 #endif
 
 #include "gst-validate-media-info.h"
+#include "validate.h"
 
 #include <glib/gstdio.h>
 #include <string.h>
@@ -529,6 +530,9 @@ check_playback_scenario (GstValidateMediaInfo * mi,
 
   g_object_set (playbin, "video-sink", videosink, "audio-sink", audiosink,
       "uri", mi->uri, NULL);
+  /* Only decoding matters here, let it run as fast as possible */
+  g_object_set (videosink, "sync", FALSE, NULL);
+  g_object_set (audiosink, "sync", FALSE, NULL);
 
   bus = gst_pipeline_get_bus (GST_PIPELINE (playbin));
 
@@ -996,6 +1000,79 @@ end:
   return ret;
 }
 
+typedef struct
+{
+  GstValidateMediaInfo *mi;
+  gboolean (*func) (GstValidateMediaInfo * mi, gchar ** error_message);
+  gchar **error_message;
+  gboolean res;
+} PlaybackCheck;
+
+static void
+run_playback_check (PlaybackCheck * check, gpointer unused)
+{
+  check->res = check->func (check->mi, check->error_message);
+}
+
+static guint
+get_max_concurrent_checks (void)
+{
+  GList *config;
+  gint max_checks;
+
+  for (config = gst_validate_plugin_get_config (NULL); config;
+      config = config->next) {
+    if (gst_structure_get_int (config->data,
+            "media-info-max-concurrent-checks", &max_checks))
+      return MAX (max_checks, 1);
+  }
+
+  return G_MAXUINT;
+}
+
+/* Each check plays the media in its own pipeline, so they are run
+ * concurrently. The track selection check switches tracks every few seconds
+ * of playback so it needs to run in real time and is started first, the
+ * others only decode the media as fast as possible. When only one check can
+ * run at a time, they run in their usual order */
+static gboolean
+check_playback_all (GstValidateMediaInfo * mi)
+{
+  guint i, max_checks = get_max_concurrent_checks ();
+  gboolean ret = TRUE;
+  PlaybackCheck checks[] = {
+    {mi, check_playback, &mi->playback_error, TRUE},
+    {mi, check_reverse_playback, &mi->reverse_playback_error, TRUE},
+    {mi, check_track_selection, &mi->track_switch_error, TRUE},
+  };
+
+  if (max_checks > 1) {
+    GThreadPool *pool = g_thread_pool_new ((GFunc) run_playback_check, NULL,
+        MIN (max_checks, G_N_ELEMENTS (checks)), TRUE, NULL);
+
+    if (pool) {
+      /* Track selection last in the list, first in the queue */
+      for (i = 0; i < G_N_ELEMENTS (checks); i++)
+        g_thread_pool_push (pool,
+            &checks[(i + G_N_ELEMENTS (checks) - 1) % G_N_ELEMENTS (checks)],
+            NULL);
+
+      /* Waits for all the checks to be done */
+      g_thread_pool_free (pool, FALSE, TRUE);
+    } else {
+      max_checks = 1;
+    }
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (checks); i++) {
+    if (max_checks <= 1)
+      run_playback_check (&checks[i], NULL);
+    ret = checks[i].res & ret;
+  }
+
+  return ret;
+}
+
 static gboolean
 check_is_image (GstDiscovererInfo * info)
 {
@@ -1054,9 +1131,7 @@ gst_validate_media_info_inspect_uri (GstValidateMediaInfo * mi,
   if (discover_only)
     goto done;
 
-  ret = check_playback (mi, &mi->playback_error) & ret;
-  ret = check_reverse_playback (mi, &mi->reverse_playback_error) & ret;
-  ret = check_track_selection (mi, &mi->track_switch_error) & ret;
+  ret = check_playback_all (mi) & ret;
 
 done:
   gst_object_unref (discoverer);
@@ -64,7 +64,18 @@ static GstValidateInterceptionReturn
 gst_validate_monitor_intercept_report (GstValidateReporter * reporter,
     GstValidateReport * report);
 
+typedef struct
+{
+  /* Copy of the overrides list that is walked without taking the overrides
+   * lock. It is replaced by a new copy when an override is attached, the
+   * previous copies are kept in retired_overrides as they may still be
+   * walked until the monitor goes away */
+  GList *overrides;
+  GList *retired_overrides;
+} GstValidateMonitorPrivate;
+
 #define _do_init \
+  G_ADD_PRIVATE (GstValidateMonitor) \
   G_IMPLEMENT_INTERFACE (GST_TYPE_VALIDATE_REPORTER, _reporter_iface_init)
 
 static GstValidateReportingDetails
@@ -116,14 +127,22 @@ _reporter_iface_init (GstValidateReporterInterface * iface)
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstValidateMonitor, gst_validate_monitor,
     GST_TYPE_OBJECT, _do_init);
 
+#define GET_PRIV(m) ((GstValidateMonitorPrivate *) \
+    gst_validate_monitor_get_instance_private (m))
+
 static void
 gst_validate_monitor_dispose (GObject * object)
 {
   GstValidateMonitor *monitor = GST_VALIDATE_MONITOR_CAST (object);
+  GstValidateMonitorPrivate *priv = GET_PRIV (monitor);
 
   g_mutex_clear (&monitor->mutex);
   g_mutex_clear (&monitor->overrides_mutex);
   g_queue_clear (&monitor->overrides);
+  g_list_free (priv->overrides);
+  priv->overrides = NULL;
+  g_list_free_full (priv->retired_overrides, (GDestroyNotify) g_list_free);
+  priv->retired_overrides = NULL;
 
   g_weak_ref_clear (&monitor->pipeline);
   g_weak_ref_clear (&monitor->target);
@@ -259,9 +278,19 @@ _determine_reporting_level (GstValidateMonitor * monitor)
   gchar *object_name;
   GstValidateReportingDetails level = GST_VALIDATE_SHOW_UNKNOWN;
 
-  object = gst_validate_monitor_get_target (monitor);
   runner = gst_validate_reporter_get_runner (GST_VALIDATE_REPORTER (monitor));
 
+  /* No pattern was set, nothing to look up for this object nor its parents */
+  if (!runner || !gst_validate_runner_has_reporting_level_patterns (runner)) {
+    if (runner)
+      gst_object_unref (runner);
+    monitor->level = GST_VALIDATE_SHOW_UNKNOWN;
+
+    return;
+  }
+
+  object = gst_validate_monitor_get_target (monitor);
+
   do {
     if (!GST_IS_OBJECT (object))
       break;
@@ -365,10 +394,20 @@ gst_validate_monitor_intercept_report (GstValidateReporter * reporter,
   return GST_VALIDATE_REPORTER_REPORT;
 }
 
+/* Returns the overrides of @monitor, to be walked without taking the
+ * overrides lock. Overrides are never detached, and the list stays valid as
+ * long as @monitor. An override attached concurrently may be missed. */
+GList *
+gst_validate_monitor_get_overrides_unlocked (GstValidateMonitor * monitor)
+{
+  return g_atomic_pointer_get (&GET_PRIV (monitor)->overrides);
+}
+
 void
 gst_validate_monitor_attach_override (GstValidateMonitor * monitor,
     GstValidateOverride * override)
 {
+  GstValidateMonitorPrivate *priv = GET_PRIV (monitor);
   GstValidateRunner *runner;
   GstValidateRunner *mrunner;
 
@@ -388,6 +427,10 @@ gst_validate_monitor_attach_override (GstValidateMonitor * monitor,
     gst_validate_reporter_set_runner (GST_VALIDATE_REPORTER (override),
         mrunner);
   g_queue_push_tail (&monitor->overrides, override);
+  if (priv->overrides)
+    priv->retired_overrides =
+        g_list_prepend (priv->retired_overrides, priv->overrides);
+  g_atomic_pointer_set (&priv->overrides, g_list_copy (monitor->overrides.head));
   GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (monitor);
 
   if (runner)
@@ -41,6 +41,11 @@ typedef struct
 {
   gchar *name;
   GstValidateOverride *override;
+
+  /* Compiled once at registration, for name overrides */
+  GRegex *regex;
+  /* The classification tokens that elements need, for klass overrides */
+  gchar **klass_tokens;
 } GstValidateOverrideRegistryNameEntry;
 
 typedef struct
@@ -64,6 +69,9 @@ static void
 {
   g_free (entry->name);
   g_object_unref (entry->override);
+  if (entry->regex)
+    g_regex_unref (entry->regex);
+  g_strfreev (entry->klass_tokens);
 
   g_slice_free (GstValidateOverrideRegistryNameEntry, entry);
 }
@@ -86,6 +94,8 @@ gst_validate_override_registry_new (void)
   g_queue_init (&reg->name_overrides);
   g_queue_init (&reg->gtype_overrides);
   g_queue_init (&reg->klass_overrides);
+  reg->type_overrides = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) g_ptr_array_unref);
 
   return reg;
 }
@@ -105,6 +115,7 @@ gst_validate_overide_registery_free (GstValidateOverrideRegistry * reg)
   g_queue_clear (&reg->name_overrides);
   g_queue_clear (&reg->gtype_overrides);
   g_queue_clear (&reg->klass_overrides);
+  g_hash_table_unref (reg->type_overrides);
   g_mutex_clear (&reg->mutex);
 
   g_slice_free (GstValidateOverrideRegistry, reg);
@@ -133,9 +144,17 @@ gst_validate_override_register_by_name (const gchar * name,
   GstValidateOverrideRegistryNameEntry *entry =
       g_slice_new (GstValidateOverrideRegistryNameEntry);
 
+  GError *err = NULL;
+
   GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (registry);
   entry->name = g_strdup (name);
   entry->override = g_object_ref (override);
+  entry->regex = g_regex_new (name, G_REGEX_OPTIMIZE, 0, &err);
+  entry->klass_tokens = NULL;
+  if (!entry->regex) {
+    GST_WARNING ("Invalid override name pattern %s: %s", name, err->message);
+    g_clear_error (&err);
+  }
   g_queue_push_tail (&registry->name_overrides, entry);
   GST_VALIDATE_OVERRIDE_REGISTRY_UNLOCK (registry);
 }
@@ -152,6 +171,7 @@ gst_validate_override_register_by_type (GType gtype,
   entry->gtype = gtype;
   entry->override = g_object_ref (override);
   g_queue_push_tail (&registry->gtype_overrides, entry);
+  g_hash_table_remove_all (registry->type_overrides);
   GST_VALIDATE_OVERRIDE_REGISTRY_UNLOCK (registry);
 }
 
@@ -166,7 +186,10 @@ gst_validate_override_register_by_klass (const gchar * klass,
   GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (registry);
   entry->name = g_strdup (klass);
   entry->override = g_object_ref (override);
+  entry->regex = NULL;
+  entry->klass_tokens = g_strsplit (klass, "/", -1);
   g_queue_push_tail (&registry->klass_overrides, entry);
+  g_hash_table_remove_all (registry->type_overrides);
   GST_VALIDATE_OVERRIDE_REGISTRY_UNLOCK (registry);
 }
 
@@ -181,7 +204,7 @@ static void
   name = gst_validate_reporter_get_name (GST_VALIDATE_REPORTER (monitor));
   for (iter = registry->name_overrides.head; iter; iter = g_list_next (iter)) {
     entry = iter->data;
-    if (g_regex_match_simple (entry->name, name, 0, 0)) {
+    if (entry->regex && g_regex_match (entry->regex, name, 0, NULL)) {
       GST_INFO_OBJECT (registry, "Adding override %s to %s", entry->name, name);
 
       gst_validate_monitor_attach_override (monitor, entry->override);
@@ -190,47 +213,82 @@ static void
   }
 }
 
-static void
-    gst_validate_override_registry_attach_gtype_overrides_unlocked
-    (GstValidateOverrideRegistry * registry, GstValidateMonitor * monitor)
+static gboolean
+_klass_tokens_match (gchar ** wanted, gchar ** tokens)
+{
+  guint i;
+
+  /* All the wanted tokens have to be in the element classification */
+  for (i = 0; wanted[i]; i++) {
+    if (!g_strv_contains ((const gchar * const *) tokens, wanted[i]))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Type and klass overrides only depend on the element type, so the list of
+ * overrides applying to a given type is only computed once */
+static GPtrArray *
+    gst_validate_override_registry_get_type_overrides_unlocked
+    (GstValidateOverrideRegistry * registry, GstElement * element)
 {
-  GstValidateOverrideRegistryGTypeEntry *entry;
-  GstElement *element;
   GList *iter;
+  gchar **klass_tokens;
+  GType type = G_OBJECT_TYPE (element);
+  GPtrArray *overrides = g_hash_table_lookup (registry->type_overrides,
+      GSIZE_TO_POINTER (type));
 
-  element = gst_validate_monitor_get_element (monitor);
-  if (!element)
-    return;
+  if (overrides)
+    return overrides;
 
+  overrides = g_ptr_array_new ();
   for (iter = registry->gtype_overrides.head; iter; iter = g_list_next (iter)) {
-    entry = iter->data;
-    if (G_TYPE_CHECK_INSTANCE_TYPE (element, entry->gtype)) {
-      gst_validate_monitor_attach_override (monitor, entry->override);
-    }
+    GstValidateOverrideRegistryGTypeEntry *entry = iter->data;
+
+    if (g_type_is_a (type, entry->gtype))
+      g_ptr_array_add (overrides, entry->override);
   }
-  gst_object_unref (element);
+
+  klass_tokens =
+      g_strsplit (gst_element_class_get_metadata (GST_ELEMENT_GET_CLASS
+          (element), GST_ELEMENT_METADATA_KLASS), "/", -1);
+  for (iter = registry->klass_overrides.head; iter; iter = g_list_next (iter)) {
+    GstValidateOverrideRegistryNameEntry *entry = iter->data;
+
+    if (_klass_tokens_match (entry->klass_tokens, klass_tokens))
+      g_ptr_array_add (overrides, entry->override);
+  }
+  g_strfreev (klass_tokens);
+
+  g_hash_table_insert (registry->type_overrides, GSIZE_TO_POINTER (type),
+      overrides);
+
+  return overrides;
 }
 
 static void
-    gst_validate_override_registry_attach_klass_overrides_unlocked
+    gst_validate_override_registry_attach_type_overrides_unlocked
     (GstValidateOverrideRegistry * registry, GstValidateMonitor * monitor)
 {
-  GstValidateOverrideRegistryNameEntry *entry;
-  GList *iter;
   GstElement *element;
+  GPtrArray *overrides;
+  guint i;
+
+  if (!registry->gtype_overrides.length && !registry->klass_overrides.length)
+    return;
 
   element = gst_validate_monitor_get_element (monitor);
   if (!element)
     return;
 
-  for (iter = registry->klass_overrides.head; iter; iter = g_list_next (iter)) {
+  overrides =
+      gst_validate_override_registry_get_type_overrides_unlocked (registry,
+      element);
+  for (i = 0; i < overrides->len; i++)
+    gst_validate_monitor_attach_override (monitor,
+        g_ptr_array_index (overrides, i));
 
-    entry = iter->data;
-
-    if (gst_validate_element_has_klass (element, entry->name)) {
-      gst_validate_monitor_attach_override (monitor, entry->override);
-    }
-  }
   gst_object_unref (element);
 }
 
@@ -241,8 +299,7 @@ gst_validate_override_registry_attach_overrides (GstValidateMonitor * monitor)
 
   GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (reg);
   gst_validate_override_registry_attach_name_overrides_unlocked (reg, monitor);
-  gst_validate_override_registry_attach_gtype_overrides_unlocked (reg, monitor);
-  gst_validate_override_registry_attach_klass_overrides_unlocked (reg, monitor);
+  gst_validate_override_registry_attach_type_overrides_unlocked (reg, monitor);
   GST_VALIDATE_OVERRIDE_REGISTRY_UNLOCK (reg);
 }
 
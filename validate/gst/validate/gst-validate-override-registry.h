@@ -37,6 +37,10 @@ typedef struct {
   GQueue name_overrides;
   GQueue gtype_overrides;
   GQueue klass_overrides;
+
+  /*< private >*/
+  /* GType -> GPtrArray of the type and klass overrides applying to it */
+  GHashTable *type_overrides;
 } GstValidateOverrideRegistry;
 
 GST_VALIDATE_API
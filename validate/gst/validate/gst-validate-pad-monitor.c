@@ -48,7 +48,26 @@ static GstValidateInterceptionReturn
 gst_validate_pad_monitor_intercept_report (GstValidateReporter * reporter,
     GstValidateReport * report);
 
+/* Kept out of the public structure so that its layout does not change */
+typedef struct
+{
+  GstPadChainListFunction chain_list_func;
+
+  /* Set while the wrapped chain list function runs, so that the buffers of
+   * a list it chains one by one are not checked a second time */
+  gboolean in_chain_list;
+
+  GstValidateMediaExpectedFrames *expected_frames;
+  /* The index in expected_frames of the frame that should arrive next */
+  guint next_frame;
+
+  /* Odd while the timestamp range is being updated, see
+   * gst_validate_pad_monitor_get_timestamp_range() */
+  gint timestamp_range_seqnum;
+} GstValidatePadMonitorPrivate;
+
 #define _do_init \
+  G_ADD_PRIVATE (GstValidatePadMonitor) \
   G_IMPLEMENT_INTERFACE (GST_TYPE_VALIDATE_REPORTER, _reporter_iface_init)
 
 static void
@@ -61,6 +80,9 @@ _reporter_iface_init (GstValidateReporterInterface * iface)
 G_DEFINE_TYPE_WITH_CODE (GstValidatePadMonitor, gst_validate_pad_monitor,
     GST_TYPE_VALIDATE_MONITOR, _do_init);
 
+#define GET_PRIV(m) ((GstValidatePadMonitorPrivate *) \
+    gst_validate_pad_monitor_get_instance_private (m))
+
 #define PENDING_FIELDS "pending-fields"
 #define AUDIO_TIMESTAMP_TOLERANCE (GST_MSECOND * 100)
 
@@ -101,6 +123,13 @@ G_DEFINE_TYPE_WITH_CODE (GstValidatePadMonitor, gst_validate_pad_monitor,
  * parent in case it wants to do a check that won't need to use other internally
  * linked pads (sinkpad). But in this case it might lock and unlock freely without
  * causing deadlocks.
+ *
+ * The per-buffer checks done in the chain function do not take any lock:
+ * the state they use is only modified from the streaming thread of the pad,
+ * and the timestamp range other pads read is published like a sequence lock.
+ * Both locks are only taken there when the pad returns EOS, which marks other
+ * pads. The buffer probe only takes the parent lock when checks involving
+ * other pads are needed.
  */
 #define GST_VALIDATE_PAD_MONITOR_PARENT_LOCK(m)                  \
 G_STMT_START {                                             \
@@ -874,6 +903,7 @@ static void
 gst_validate_pad_monitor_dispose (GObject * object)
 {
   GstValidatePadMonitor *monitor = GST_VALIDATE_PAD_MONITOR_CAST (object);
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (monitor);
   GstPad *pad =
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (monitor)));
@@ -890,7 +920,8 @@ gst_validate_pad_monitor_dispose (GObject * object)
   gst_structure_free (monitor->pending_setcaps_fields);
   g_ptr_array_unref (monitor->serialized_events);
   g_list_free_full (monitor->expired_events, (GDestroyNotify) gst_event_unref);
-  g_list_free_full (monitor->all_bufs, (GDestroyNotify) gst_buffer_unref);
+  if (priv->expected_frames)
+    gst_validate_media_expected_frames_free (priv->expected_frames);
   gst_caps_replace (&monitor->last_caps, NULL);
   gst_caps_replace (&monitor->last_query_res, NULL);
   gst_caps_replace (&monitor->last_query_filter, NULL);
@@ -942,10 +973,12 @@ gst_validate_pad_monitor_flush (GstValidatePadMonitor * pad_monitor)
   pad_monitor->current_timestamp = GST_CLOCK_TIME_NONE;
   pad_monitor->current_duration = GST_CLOCK_TIME_NONE;
 
-  pad_monitor->last_flow_return = GST_FLOW_OK;
+  g_atomic_int_set (&pad_monitor->last_flow_return, GST_FLOW_OK);
 
+  g_atomic_int_inc (&GET_PRIV (pad_monitor)->timestamp_range_seqnum);
   pad_monitor->timestamp_range_start = GST_CLOCK_TIME_NONE;
   pad_monitor->timestamp_range_end = GST_CLOCK_TIME_NONE;
+  g_atomic_int_inc (&GET_PRIV (pad_monitor)->timestamp_range_seqnum);
 }
 
 /* Called when the pad monitor is initialized or when
@@ -1027,6 +1060,16 @@ gst_validate_pad_monitor_get_element (GstValidateMonitor * monitor)
   return parent;
 }
 
+/* Buffers are passed to the overrides without taking the overrides lock, an
+ * override attached concurrently may only start seeing them from the next
+ * one */
+static inline gboolean
+gst_validate_pad_monitor_has_overrides (GstValidatePadMonitor * pad_monitor)
+{
+  return gst_validate_monitor_get_overrides_unlocked (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor)) != NULL;
+}
+
 static void
 gst_validate_pad_monitor_event_overrides (GstValidatePadMonitor * pad_monitor,
     GstEvent * event)
@@ -1050,15 +1093,14 @@ gst_validate_pad_monitor_buffer_overrides (GstValidatePadMonitor * pad_monitor,
 {
   GList *iter;
 
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
+  for (iter = gst_validate_monitor_get_overrides_unlocked
+      (GST_VALIDATE_MONITOR_CAST (pad_monitor)); iter;
       iter = g_list_next (iter)) {
     GstValidateOverride *override = iter->data;
 
     gst_validate_override_buffer_handler (override,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), buffer);
   }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
@@ -1067,15 +1109,14 @@ gst_validate_pad_monitor_buffer_probe_overrides (GstValidatePadMonitor *
 {
   GList *iter;
 
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
+  for (iter = gst_validate_monitor_get_overrides_unlocked
+      (GST_VALIDATE_MONITOR_CAST (pad_monitor)); iter;
       iter = g_list_next (iter)) {
     GstValidateOverride *override = iter->data;
 
     gst_validate_override_buffer_probe_handler (override,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), buffer);
   }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
@@ -1112,30 +1153,47 @@ gst_validate_pad_monitor_setcaps_overrides (GstValidatePadMonitor * pad_monitor,
   GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
+/* The timestamp range is updated for each buffer from the streaming thread
+ * of the pad without taking any lock, so it is read from other threads like
+ * a sequence lock: until it was not updated while being read */
+static void
+gst_validate_pad_monitor_get_timestamp_range (GstValidatePadMonitor * monitor,
+    GstClockTime * start, GstClockTime * end)
+{
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (monitor);
+  gint seqnum;
+
+  do {
+    seqnum = g_atomic_int_get (&priv->timestamp_range_seqnum);
+    *start = monitor->timestamp_range_start;
+    *end = monitor->timestamp_range_end;
+  } while ((seqnum & 1)
+      || seqnum != g_atomic_int_get (&priv->timestamp_range_seqnum));
+}
+
 /* FIXME : This is a bit dubious, what's the point of this check ? */
 static gboolean
 gst_validate_pad_monitor_timestamp_is_in_received_range (GstValidatePadMonitor *
     monitor, GstClockTime ts, GstClockTime tolerance)
 {
+  GstClockTime start, end;
   GstPad *pad =
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (monitor)));
 
+  gst_validate_pad_monitor_get_timestamp_range (monitor, &start, &end);
   GST_DEBUG_OBJECT (pad,
       "Checking if timestamp %" GST_TIME_FORMAT " is in range: %"
       GST_TIME_FORMAT " - %" GST_TIME_FORMAT " for pad "
       "%s:%s with tolerance: %" GST_TIME_FORMAT, GST_TIME_ARGS (ts),
-      GST_TIME_ARGS (monitor->timestamp_range_start),
-      GST_TIME_ARGS (monitor->timestamp_range_end), GST_DEBUG_PAD_NAME (pad),
+      GST_TIME_ARGS (start), GST_TIME_ARGS (end), GST_DEBUG_PAD_NAME (pad),
       GST_TIME_ARGS (tolerance));
   gst_object_unref (pad);
 
-  return !GST_CLOCK_TIME_IS_VALID (monitor->timestamp_range_start) ||
-      !GST_CLOCK_TIME_IS_VALID (monitor->timestamp_range_end) ||
-      ((monitor->timestamp_range_start >= tolerance ?
-          monitor->timestamp_range_start - tolerance : 0) <= ts
-      && (ts >= tolerance ? ts - tolerance : 0) <=
-      monitor->timestamp_range_end);
+  return !GST_CLOCK_TIME_IS_VALID (start) ||
+      !GST_CLOCK_TIME_IS_VALID (end) ||
+      ((start >= tolerance ? start - tolerance : 0) <= ts
+      && (ts >= tolerance ? ts - tolerance : 0) <= end);
 }
 
 /* Iterates over internal links (sinkpads) to check that this buffer has
@@ -1243,12 +1301,8 @@ gst_validate_pad_monitor_check_discont (GstValidatePadMonitor * pad_monitor,
 
 static void
 gst_validate_pad_monitor_check_first_buffer (GstValidatePadMonitor *
-    pad_monitor, GstBuffer * buffer)
+    pad_monitor, GstPad * pad, GstBuffer * buffer)
 {
-  GstPad *pad =
-      GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
-          (pad_monitor)));
-
   if (G_UNLIKELY (pad_monitor->first_buffer)) {
     pad_monitor->first_buffer = FALSE;
 
@@ -1263,8 +1317,6 @@ gst_validate_pad_monitor_check_first_buffer (GstValidatePadMonitor *
         GST_TIME_ARGS (GST_BUFFER_DTS (buffer)));
 
   }
-
-  gst_object_unref (pad);
 }
 
 static void
@@ -1279,14 +1331,14 @@ gst_validate_pad_monitor_check_eos (GstValidatePadMonitor *
 
 static void
 gst_validate_pad_monitor_update_buffer_data (GstValidatePadMonitor *
-    pad_monitor, GstBuffer * buffer)
+    pad_monitor, GstPad * pad, GstBuffer * buffer)
 {
-  GstPad *pad =
-      GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
-          (pad_monitor)));
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (pad_monitor);
+
   pad_monitor->current_timestamp = GST_BUFFER_TIMESTAMP (buffer);
   pad_monitor->current_duration = GST_BUFFER_DURATION (buffer);
   if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_TIMESTAMP (buffer))) {
+    g_atomic_int_inc (&priv->timestamp_range_seqnum);
     if (GST_CLOCK_TIME_IS_VALID (pad_monitor->timestamp_range_start)) {
       pad_monitor->timestamp_range_start =
           MIN (pad_monitor->timestamp_range_start,
@@ -1305,13 +1357,12 @@ gst_validate_pad_monitor_update_buffer_data (GstValidatePadMonitor *
         pad_monitor->timestamp_range_end = endts;
       }
     }
+    g_atomic_int_inc (&priv->timestamp_range_seqnum);
   }
   GST_DEBUG_OBJECT (pad, "Current stored range: %" GST_TIME_FORMAT
       " - %" GST_TIME_FORMAT,
       GST_TIME_ARGS (pad_monitor->timestamp_range_start),
       GST_TIME_ARGS (pad_monitor->timestamp_range_end));
-
-  gst_object_unref (pad);
 }
 
 static GstFlowReturn
@@ -1357,10 +1408,9 @@ gst_validate_pad_monitor_check_aggregated_return (GstValidatePadMonitor *
           othermonitor = _GET_PAD_MONITOR (peerpad);
           if (othermonitor) {
             found_a_pad = TRUE;
-            GST_VALIDATE_MONITOR_LOCK (othermonitor);
             aggregated =
-                _combine_flows (aggregated, othermonitor->last_flow_return);
-            GST_VALIDATE_MONITOR_UNLOCK (othermonitor);
+                _combine_flows (aggregated,
+                g_atomic_int_get (&othermonitor->last_flow_return));
           }
 
           gst_object_unref (peerpad);
@@ -1742,6 +1792,7 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (pad_monitor)));
   GstValidateMonitor *monitor = GST_VALIDATE_MONITOR (pad_monitor);
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (pad_monitor);
 
   if (pad_monitor->first_buffer || force_checks) {
     if (pad_monitor->segment.rate != 1.0) {
@@ -1770,9 +1821,10 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
       GST_DEBUG_OBJECT (pad,
           "No frame detection media descriptor => no buffer checking");
       pad_monitor->check_buffers = FALSE;
-    } else if (pad_monitor->all_bufs == NULL &&
-        !gst_validate_media_descriptor_get_buffers (monitor->media_descriptor,
-            pad, NULL, &pad_monitor->all_bufs)) {
+    } else if (priv->expected_frames == NULL &&
+        !(priv->expected_frames =
+            gst_validate_media_descriptor_get_expected_frames
+            (monitor->media_descriptor, pad))) {
 
       GST_INFO_OBJECT (monitor,
           "The MediaInfo is marked as detecting frame, but getting frames"
@@ -1781,8 +1833,8 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
 
       pad_monitor->check_buffers = FALSE;
     } else {
-      if (!pad_monitor->current_buf)
-        pad_monitor->current_buf = pad_monitor->all_bufs;
+      if (priv->next_frame >= priv->expected_frames->frames->len)
+        priv->next_frame = 0;
       pad_monitor->check_buffers = TRUE;
     }
   }
@@ -1794,36 +1846,14 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
 static void
 gst_validate_monitor_find_next_buffer (GstValidatePadMonitor * pad_monitor)
 {
-  GList *tmp;
-  gboolean passed_start = FALSE;
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (pad_monitor);
 
   if (!_should_check_buffers (pad_monitor, TRUE))
     return;
 
-  for (tmp = g_list_last (pad_monitor->all_bufs); tmp; tmp = tmp->prev) {
-    GstBuffer *cbuf = (GstBuffer *) tmp->data;
-    GstClockTime ts =
-        GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (cbuf)) ? GST_BUFFER_DTS (cbuf)
-        : GST_BUFFER_PTS (cbuf);
-
-    if (!GST_CLOCK_TIME_IS_VALID (ts))
-      continue;
-
-    if (ts <= pad_monitor->segment.start)
-      passed_start = TRUE;
-
-    if (!passed_start)
-      continue;
-
-    if (!GST_BUFFER_FLAG_IS_SET (cbuf, GST_BUFFER_FLAG_DELTA_UNIT)) {
-      break;
-    }
-  }
-
-  if (tmp == NULL)
-    pad_monitor->current_buf = pad_monitor->all_bufs;
-  else
-    pad_monitor->current_buf = tmp;
+  priv->next_frame =
+      gst_validate_media_expected_frames_find_sync_point
+      (priv->expected_frames, pad_monitor->segment.start);
 }
 
 /* Checks whether a segment is just an update of another,
@@ -2129,13 +2159,29 @@ gst_validate_pad_monitor_src_event_check (GstValidatePadMonitor * pad_monitor,
   return ret;
 }
 
+static gchar *
+_checksum_to_string (const guint8 * digest, gsize len)
+{
+  gsize i;
+  gchar *str = g_malloc (len * 2 + 1);
+
+  for (i = 0; i < len; i++)
+    g_snprintf (str + i * 2, 3, "%02x", digest[i]);
+  str[len * 2] = '\0';
+
+  return str;
+}
+
 static gboolean
 gst_validate_pad_monitor_check_right_buffer (GstValidatePadMonitor *
     pad_monitor, GstBuffer * buffer)
 {
-  gchar *checksum;
-  GstBuffer *wanted_buf;
-  GstMapInfo map, wanted_map;
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (pad_monitor);
+  GstValidateChecksum *checksum;
+  GstValidateMediaExpectedFrame *wanted;
+  guint8 digest[GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE];
+  gsize digest_size = 0;
+  gboolean wanted_is_delta;
 
   gboolean ret = TRUE;
   GstPad *pad;
@@ -2147,75 +2193,86 @@ gst_validate_pad_monitor_check_right_buffer (GstValidatePadMonitor *
   pad =
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (pad_monitor)));
-  if (pad_monitor->current_buf == NULL) {
+  if (priv->next_frame >= priv->expected_frames->frames->len) {
     GST_INFO_OBJECT (pad, "No current buffer one pad, Why?");
     gst_object_unref (pad);
     return FALSE;
   }
 
-  wanted_buf = pad_monitor->current_buf->data;
+  wanted = &g_array_index (priv->expected_frames->frames,
+      GstValidateMediaExpectedFrame, priv->next_frame);
 
-  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (wanted_buf)) &&
+  if (GST_CLOCK_TIME_IS_VALID (wanted->pts) &&
       GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (buffer)) &&
-      GST_BUFFER_PTS (wanted_buf) != GST_BUFFER_PTS (buffer)) {
+      wanted->pts != GST_BUFFER_PTS (buffer)) {
 
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " PTS %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
-        GST_TIME_ARGS (GST_BUFFER_PTS (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_PTS (wanted_buf)));
+        GST_TIME_ARGS (GST_BUFFER_PTS (buffer)), GST_TIME_ARGS (wanted->pts));
 
     ret = FALSE;
   }
 
-  if (GST_BUFFER_DTS (wanted_buf) != GST_BUFFER_DTS (buffer)) {
+  if (wanted->dts != GST_BUFFER_DTS (buffer)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " DTS %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
-        GST_TIME_ARGS (GST_BUFFER_DTS (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_DTS (wanted_buf)));
+        GST_TIME_ARGS (GST_BUFFER_DTS (buffer)), GST_TIME_ARGS (wanted->dts));
     ret = FALSE;
   }
 
-  if (GST_BUFFER_DURATION (wanted_buf) != GST_BUFFER_DURATION (buffer)) {
+  if (wanted->duration != GST_BUFFER_DURATION (buffer)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " DURATION %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
         GST_TIME_ARGS (GST_BUFFER_DURATION (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_DURATION (wanted_buf)));
+        GST_TIME_ARGS (wanted->duration));
     ret = FALSE;
   }
 
-  if (GST_BUFFER_FLAG_IS_SET (wanted_buf, GST_BUFFER_FLAG_DELTA_UNIT) !=
+  wanted_is_delta = !wanted->is_keyframe;
+  if (wanted_is_delta !=
       GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT "  Delta unit is set to %s but expected %s",
         buffer, GST_BUFFER_FLAG_IS_SET (buffer,
             GST_BUFFER_FLAG_DELTA_UNIT) ? "True" : "False",
-        GST_BUFFER_FLAG_IS_SET (wanted_buf,
-            GST_BUFFER_FLAG_DELTA_UNIT) ? "True" : "False");
+        wanted_is_delta ? "True" : "False");
     ret = FALSE;
   }
 
-  g_assert (gst_buffer_map (wanted_buf, &wanted_map, GST_MAP_READ));
-  g_assert (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  checksum =
+      gst_validate_checksum_new (priv->expected_frames->checksum_type);
+  if (priv->expected_frames->checksum_video_frames) {
+    GstCaps *caps = gst_pad_get_current_caps (pad);
+
+    if (gst_validate_checksum_update_video_buffer (checksum, buffer, caps))
+      digest_size = gst_validate_checksum_get_digest (checksum, digest);
+    if (caps)
+      gst_caps_unref (caps);
+  } else if (gst_validate_checksum_update_buffer (checksum, buffer)) {
+    digest_size = gst_validate_checksum_get_digest (checksum, digest);
+  }
+  gst_validate_checksum_free (checksum);
 
-  checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-      (const guchar *) map.data, map.size);
+  if (digest_size != wanted->checksum_size
+      || memcmp (digest, wanted->checksum, digest_size)) {
+    gchar *checksum_str = _checksum_to_string (digest, digest_size);
+    gchar *wanted_str =
+        _checksum_to_string (wanted->checksum, wanted->checksum_size);
 
-  if (g_strcmp0 ((gchar *) wanted_map.data, checksum)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " checksum %s different from expected: %s",
-        buffer, checksum, wanted_map.data);
+        buffer, checksum_str, wanted_str);
+    g_free (checksum_str);
+    g_free (wanted_str);
     ret = FALSE;
   }
 
-  gst_buffer_unmap (wanted_buf, &wanted_map);
-  gst_buffer_unmap (buffer, &map);
-  g_free (checksum);
   gst_object_unref (pad);
 
-  pad_monitor->current_buf = pad_monitor->current_buf->next;
+  priv->next_frame++;
 
   return ret;
 }
@@ -2248,6 +2305,40 @@ gst_validate_pad_monitor_check_return (GstValidatePadMonitor * pad_monitor,
   }
 }
 
+/* Must be called from the streaming thread of the pad */
+static void
+gst_validate_pad_monitor_check_chained_buffer (GstValidatePadMonitor *
+    pad_monitor, GstPad * pad, GstBuffer * buffer)
+{
+  gst_validate_pad_monitor_check_discont (pad_monitor, buffer);
+  gst_validate_pad_monitor_check_right_buffer (pad_monitor, buffer);
+  gst_validate_pad_monitor_check_first_buffer (pad_monitor, pad, buffer);
+  gst_validate_pad_monitor_update_buffer_data (pad_monitor, pad, buffer);
+  gst_validate_pad_monitor_check_eos (pad_monitor, buffer);
+}
+
+static void
+gst_validate_pad_monitor_check_chain_return (GstValidatePadMonitor *
+    pad_monitor, GstPad * pad, GstObject * parent, GstFlowReturn ret)
+{
+  gst_validate_pad_monitor_check_return (pad_monitor, ret);
+
+  g_atomic_int_set (&pad_monitor->last_flow_return, ret);
+
+  /* Only EOS handling modifies other pads, the flow returns the demuxer
+   * ones are aggregated from are read atomically */
+  if (G_UNLIKELY (ret == GST_FLOW_EOS)) {
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
+    GST_VALIDATE_MONITOR_LOCK (pad_monitor);
+    mark_pads_eos (pad_monitor);
+    GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+  }
+
+  if (PAD_PARENT_IS_DEMUXER (pad_monitor))
+    gst_validate_pad_monitor_check_aggregated_return (pad_monitor, parent, ret);
+}
+
 static GstFlowReturn
 gst_validate_pad_monitor_chain_func (GstPad * pad, GstObject * parent,
     GstBuffer * buffer)
@@ -2255,36 +2346,66 @@ gst_validate_pad_monitor_chain_func (GstPad * pad, GstObject * parent,
   GstValidatePadMonitor *pad_monitor = _GET_PAD_MONITOR (pad);
   GstFlowReturn ret;
 
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
-  GST_VALIDATE_MONITOR_LOCK (pad_monitor);
-
-  gst_validate_pad_monitor_check_discont (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_right_buffer (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_first_buffer (pad_monitor, buffer);
-  gst_validate_pad_monitor_update_buffer_data (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_eos (pad_monitor, buffer);
-
-  GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+  /* The whole list has already been checked */
+  if (GET_PRIV (pad_monitor)->in_chain_list)
+    return pad_monitor->chain_func (pad, parent, buffer);
 
+  gst_validate_pad_monitor_check_chained_buffer (pad_monitor, pad, buffer);
   gst_validate_pad_monitor_buffer_overrides (pad_monitor, buffer);
 
   ret = pad_monitor->chain_func (pad, parent, buffer);
 
-  gst_validate_pad_monitor_check_return (pad_monitor, ret);
+  gst_validate_pad_monitor_check_chain_return (pad_monitor, pad, parent, ret);
 
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
-  GST_VALIDATE_MONITOR_LOCK (pad_monitor);
+  return ret;
+}
 
-  pad_monitor->last_flow_return = ret;
-  if (ret == GST_FLOW_EOS) {
-    mark_pads_eos (pad_monitor);
+/* The chain list function pads get when the element does not set one, it is
+ * not exposed by GStreamer */
+static GstPadChainListFunction
+_get_default_chain_list_func (void)
+{
+  static gsize default_func = 0;
+
+  if (g_once_init_enter (&default_func)) {
+    GstPad *pad = gst_object_ref_sink (gst_pad_new (NULL, GST_PAD_SINK));
+    gsize func = (gsize) GST_PAD_CHAINLISTFUNC (pad);
+
+    gst_object_unref (pad);
+    g_once_init_leave (&default_func, func);
   }
-  if (PAD_PARENT_IS_DEMUXER (pad_monitor))
-    gst_validate_pad_monitor_check_aggregated_return (pad_monitor, parent, ret);
 
-  GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+  return (GstPadChainListFunction) default_func;
+}
+
+static GstFlowReturn
+gst_validate_pad_monitor_chain_list_func (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstValidatePadMonitor *pad_monitor = _GET_PAD_MONITOR (pad);
+  GstValidatePadMonitorPrivate *priv = GET_PRIV (pad_monitor);
+  GstFlowReturn ret;
+  guint i, len = gst_buffer_list_length (list);
+
+  /* Check the whole list at once, so that it can reach the element
+   * without being split */
+  for (i = 0; i < len; i++)
+    gst_validate_pad_monitor_check_chained_buffer (pad_monitor, pad,
+        gst_buffer_list_get (list, i));
+
+  if (gst_validate_pad_monitor_has_overrides (pad_monitor)) {
+    for (i = 0; i < len; i++)
+      gst_validate_pad_monitor_buffer_overrides (pad_monitor,
+          gst_buffer_list_get (list, i));
+  }
+
+  /* In case the chain list function chains buffers through our chain
+   * function, which must not check them again */
+  priv->in_chain_list = TRUE;
+  ret = priv->chain_list_func (pad, parent, list);
+  priv->in_chain_list = FALSE;
+
+  gst_validate_pad_monitor_check_chain_return (pad_monitor, pad, parent, ret);
 
   return ret;
 }
@@ -2505,22 +2626,20 @@ gst_validate_pad_monitor_check_buffer_freq (GstValidatePadMonitor * monitor,
   }
 }
 
-static gboolean
-gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
-    gpointer udata, gboolean pull_mode)
+/* Must be called with the pad monitor lock held, and the parent lock too
+ * when @cross_pad_checks is %TRUE */
+static void
+gst_validate_pad_monitor_check_pushed_buffer (GstValidatePadMonitor * monitor,
+    GstPad * pad, GstBuffer * buffer, gboolean pull_mode,
+    gboolean cross_pad_checks)
 {
-  GstValidatePadMonitor *monitor = udata;
-
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (monitor);
-  GST_VALIDATE_MONITOR_LOCK (monitor);
-
   if (!pull_mode)
     gst_validate_pad_monitor_check_discont (monitor, buffer);
-  gst_validate_pad_monitor_check_first_buffer (monitor, buffer);
-  gst_validate_pad_monitor_update_buffer_data (monitor, buffer);
+  gst_validate_pad_monitor_check_first_buffer (monitor, pad, buffer);
+  gst_validate_pad_monitor_update_buffer_data (monitor, pad, buffer);
   gst_validate_pad_monitor_check_eos (monitor, buffer);
 
-  if (PAD_PARENT_IS_DECODER (monitor) || PAD_PARENT_IS_ENCODER (monitor)) {
+  if (cross_pad_checks) {
     GstClockTime tolerance = 0;
 
     if (monitor->caps_is_audio)
@@ -2562,13 +2681,61 @@ gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
   }
 
   gst_validate_pad_monitor_check_buffer_freq (monitor, pad);
+}
+
+static gboolean
+gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
+    gpointer udata, gboolean pull_mode)
+{
+  GstValidatePadMonitor *monitor = udata;
+  /* Only decoders and encoders check against the internally linked pads */
+  gboolean cross_pad_checks = PAD_PARENT_IS_DECODER (monitor)
+      || PAD_PARENT_IS_ENCODER (monitor);
+
+  if (cross_pad_checks)
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (monitor);
+  GST_VALIDATE_MONITOR_LOCK (monitor);
+
+  gst_validate_pad_monitor_check_pushed_buffer (monitor, pad, buffer,
+      pull_mode, cross_pad_checks);
 
   GST_VALIDATE_MONITOR_UNLOCK (monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (monitor);
+  if (cross_pad_checks)
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (monitor);
   gst_validate_pad_monitor_buffer_probe_overrides (monitor, buffer);
   return TRUE;
 }
 
+/* Lists are checked in one go instead of being split in buffers, so that
+ * monitoring does not break the batching done by the element */
+static void
+gst_validate_pad_monitor_buffer_list_probe (GstPad * pad, GstBufferList * list,
+    gpointer udata)
+{
+  GstValidatePadMonitor *monitor = udata;
+  gboolean cross_pad_checks = PAD_PARENT_IS_DECODER (monitor)
+      || PAD_PARENT_IS_ENCODER (monitor);
+  guint i, len = gst_buffer_list_length (list);
+
+  if (cross_pad_checks)
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (monitor);
+  GST_VALIDATE_MONITOR_LOCK (monitor);
+
+  for (i = 0; i < len; i++)
+    gst_validate_pad_monitor_check_pushed_buffer (monitor, pad,
+        gst_buffer_list_get (list, i), FALSE, cross_pad_checks);
+
+  GST_VALIDATE_MONITOR_UNLOCK (monitor);
+  if (cross_pad_checks)
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (monitor);
+
+  if (gst_validate_pad_monitor_has_overrides (monitor)) {
+    for (i = 0; i < len; i++)
+      gst_validate_pad_monitor_buffer_probe_overrides (monitor,
+          gst_buffer_list_get (list, i));
+  }
+}
+
 static void
 gst_validate_pad_monitor_event_probe (GstPad * pad, GstEvent * event,
     gpointer udata)
@@ -2674,6 +2841,8 @@ gst_validate_pad_monitor_pad_probe (GstPad * pad, GstPadProbeInfo * info,
   if (info->type & GST_PAD_PROBE_TYPE_BUFFER)
     gst_validate_pad_monitor_buffer_probe (pad, info->data, udata,
         GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_PULL);
+  else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    gst_validate_pad_monitor_buffer_list_probe (pad, info->data, udata);
   else if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
     gst_validate_pad_monitor_event_probe (pad, info->data, udata);
 
@@ -2896,6 +3065,16 @@ gst_validate_pad_monitor_do_setup (GstValidateMonitor * monitor)
     if (pad_monitor->chain_func)
       gst_pad_set_chain_function (pad, gst_validate_pad_monitor_chain_func);
 
+    /* The default chain list function chains each buffer through the chain
+     * function, which already checks them one by one along with their flow
+     * returns, so only the lists the element handles itself are wrapped */
+    GET_PRIV (pad_monitor)->chain_list_func = GST_PAD_CHAINLISTFUNC (pad);
+    if (pad_monitor->chain_func && GET_PRIV (pad_monitor)->chain_list_func
+        && GET_PRIV (pad_monitor)->chain_list_func !=
+        _get_default_chain_list_func ())
+      gst_pad_set_chain_list_function (pad,
+          gst_validate_pad_monitor_chain_list_func);
+
     if (pad_monitor->event_full_func)
       gst_pad_set_event_full_function (pad,
           gst_validate_pad_monitor_sink_event_full_func);
@@ -2908,8 +3087,8 @@ gst_validate_pad_monitor_do_setup (GstValidateMonitor * monitor)
     /* add buffer/event probes */
     pad_monitor->pad_probe_id =
         gst_pad_add_probe (pad,
-        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
-        GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST |
+        GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
         (GstPadProbeCallback) gst_validate_pad_monitor_pad_probe, pad_monitor,
         NULL);
   }
@@ -106,6 +106,8 @@ struct _GstValidatePadMonitor {
   GstClockTime current_timestamp;
   GstClockTime current_duration;
 
+  /* Accessed atomically, it is updated without taking any lock after
+   * each chain call */
   GstFlowReturn last_flow_return;
 
   /* Stores the timestamp range of data that has flown through
@@ -120,6 +122,8 @@ struct _GstValidatePadMonitor {
   GstClockTime timestamp_range_end;
 
   /* GstValidateMediaCheck related fields */
+  /* Unused since the expected frames are looked up in an indexed array, kept
+   * for API and ABI stability */
   GList *all_bufs;
   /* The GstBuffer that should arrive next in a GList */
   GList *current_buf;
@@ -29,6 +29,11 @@
 #include <stdio.h>              /* fprintf */
 #include <glib/gstdio.h>
 #include <errno.h>
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include <string.h>
 #include "gst-validate-i18n-lib.h"
@@ -41,7 +46,14 @@
 
 static GstClockTime _gst_validate_report_start_time = 0;
 static GstValidateDebugFlags _gst_validate_flags = 0;
+/* The issue registry is read on every report and only written when issues
+ * are registered, which mostly happens in gst_validate_report_init(). It is
+ * a copy-on-write table: lookups read the current table without locking,
+ * registrations publish an updated copy and keep the replaced ones alive
+ * until gst_validate_report_deinit() as readers might still be using them */
 static GHashTable *_gst_validate_issues = NULL;
+static GMutex _gst_validate_issues_lock;
+static GList *_gst_validate_retired_issues = NULL;
 static FILE **log_files = NULL;
 
 /* Tcp server for communications with gst-validate-launcher */
@@ -49,6 +61,83 @@ GSocketClient *socket_client = NULL;
 GSocketConnection *server_connection = NULL;
 GOutputStream *server_ostream = NULL;
 
+/* Messages to the launcher are queued by gst_validate_send() and written in
+ * batches from a dedicated thread, so that a slow launcher never blocks the
+ * streaming or main loop threads. The launcher relies on all the reports and
+ * actions being received so those are never dropped, only the latest
+ * position update is kept.
+ *
+ * The queue is deliberately not bounded: most messages come from streaming
+ * threads which must not be stalled, so a launcher that stops reading costs
+ * memory rather than changing the timing of the pipeline under test. */
+#define SERVER_BATCH_MAX_SIZE 64
+
+static GThread *server_thread = NULL;
+static GMutex server_lock;
+static GCond server_cond;
+static GQueue server_queue = G_QUEUE_INIT;
+static JsonNode *server_pending_position = NULL;
+static gboolean server_stopping = FALSE;
+
+/* When GST_VALIDATE_SERVER is a file:// URI, messages are written in a ring
+ * mapped from that file instead, which the launcher polls and which is still
+ * readable after a crash. The file is a RingHeader followed by the ring
+ * itself, in host byte order. Each record is a RingRecord followed by its
+ * payload, padded to 8 bytes, and records never wrap around the end of the
+ * ring. Position updates are not queued but stored in the header.
+ *
+ * The file is created under a temporary name and renamed once initialized,
+ * so readers never see a partially initialized ring, and a reader mapping a
+ * previous ring at the same path is never truncated under its feet. */
+#define RING_MAGIC "GSTVRING"
+#define RING_VERSION 2
+#define RING_CAPACITY (4 * 1024 * 1024)
+
+#define RING_FLAG_CLOSED (1 << 0)
+
+#define RING_RECORD_PADDING 0
+#define RING_RECORD_MESSAGE 1   /* A JSON message */
+
+typedef struct
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 capacity;
+  /* Number of bytes written in the ring, modulo 2^32, updated once a record
+   * is complete */
+  volatile gint write_offset;
+  guint32 flags;
+  /* Odd while the position fields are being updated */
+  volatile gint position_seq;
+  guint32 pid;
+  gint64 position;
+  gint64 duration;
+  gdouble speed;
+  /* Offset up to which the record being written extends, updated before
+   * writing it. Readers check it after copying a record to detect that the
+   * writer lapped them meanwhile. */
+  volatile gint reserved_offset;
+  guint8 padding[4];
+} RingHeader;
+
+typedef struct
+{
+  guint32 size;
+  guint32 type;
+} RingRecord;
+
+G_STATIC_ASSERT (sizeof (RingHeader) == 64);
+G_STATIC_ASSERT (sizeof (RingRecord) == 8);
+
+typedef struct
+{
+  guint8 *data;
+  gsize size;
+  JsonGenerator *jgen;
+} ReportsRing;
+
+static ReportsRing *server_ring = NULL;
+
 static GType _gst_validate_report_type = 0;
 
 static JsonNode *
@@ -197,23 +286,54 @@ gst_validate_issue_set_default_level (GstValidateIssue * issue,
 void
 gst_validate_issue_register (GstValidateIssue * issue)
 {
-  g_return_if_fail (g_hash_table_lookup (_gst_validate_issues,
-          (gpointer) gst_validate_issue_get_id (issue)) == NULL);
+  GHashTable *issues, *new_issues;
+  GHashTableIter iter;
+  gpointer id, value;
+
+  g_mutex_lock (&_gst_validate_issues_lock);
+  issues = _gst_validate_issues;
+  if (g_hash_table_lookup (issues,
+          (gpointer) gst_validate_issue_get_id (issue)) != NULL) {
+    g_mutex_unlock (&_gst_validate_issues_lock);
+    g_return_if_reached ();
+  }
 
-  g_hash_table_insert (_gst_validate_issues,
+  new_issues = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_iter_init (&iter, issues);
+  while (g_hash_table_iter_next (&iter, &id, &value))
+    g_hash_table_insert (new_issues, id, value);
+  g_hash_table_insert (new_issues,
       (gpointer) gst_validate_issue_get_id (issue), issue);
+
+  g_atomic_pointer_set (&_gst_validate_issues, new_issues);
+  _gst_validate_retired_issues =
+      g_list_prepend (_gst_validate_retired_issues, issues);
+  g_mutex_unlock (&_gst_validate_issues_lock);
+}
+
+/* Used while loading the core issues, before the registry is published */
+static void
+gst_validate_issue_register_static (GHashTable * issues,
+    GstValidateIssue * issue)
+{
+  g_return_if_fail (g_hash_table_lookup (issues,
+          (gpointer) gst_validate_issue_get_id (issue)) == NULL);
+
+  g_hash_table_insert (issues, (gpointer) gst_validate_issue_get_id (issue),
+      issue);
 }
 
 #define REGISTER_VALIDATE_ISSUE(lvl,id,sum,desc)			\
-  gst_validate_issue_register (gst_validate_issue_new (id, \
+  gst_validate_issue_register_static (issues, gst_validate_issue_new (id, \
 						       sum, desc, GST_VALIDATE_REPORT_LEVEL_##lvl))
 static void
 gst_validate_report_load_issues (void)
 {
+  GHashTable *issues;
+
   g_return_if_fail (_gst_validate_issues == NULL);
 
-  _gst_validate_issues = g_hash_table_new_full (g_direct_hash, g_direct_equal,
-      NULL, (GDestroyNotify) gst_validate_issue_unref);
+  issues = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   /* **
    * WARNING: The `summary` is used to define known issues in the testsuites.
@@ -414,95 +534,314 @@ gst_validate_report_load_issues (void)
   REGISTER_VALIDATE_ISSUE (CRITICAL, G_LOG_CRITICAL,
       "We got a g_log critical issue", NULL);
   REGISTER_VALIDATE_ISSUE (ISSUE, G_LOG_ISSUE, "We got a g_log issue", NULL);
+
+  g_atomic_pointer_set (&_gst_validate_issues, issues);
 }
 
-gboolean
-gst_validate_send (JsonNode * root)
+static gboolean
+_is_position_message (JsonNode * root)
 {
-  gboolean res = FALSE;
-  JsonGenerator *jgen;
-  gsize message_length;
-  gchar *object, *message;
+  JsonObject *object;
+
+  if (!JSON_NODE_HOLDS_OBJECT (root))
+    return FALSE;
+
+  object = json_node_get_object (root);
+
+  return json_object_has_member (object, "type") &&
+      !g_strcmp0 (json_object_get_string_member (object, "type"), "position");
+}
+
+/* Writes @batch as a single frame: a big endian 32 bits length followed by a
+ * JSON array of messages, or by the message itself when it is alone, which
+ * is what launchers not supporting batches expect */
+static gboolean
+gst_validate_server_write_batch (JsonGenerator * jgen, GString * frame,
+    JsonArray * batch)
+{
+  JsonNode *root;
+  gchar *data;
+  gsize length;
   GError *error = NULL;
+  gboolean res;
 
-  if (!server_ostream)
-    goto done;
+  if (json_array_get_length (batch) == 1) {
+    root = json_array_dup_element (batch, 0);
+  } else {
+    root = json_node_new (JSON_NODE_ARRAY);
+    json_node_set_array (root, batch);
+  }
 
-  jgen = json_generator_new ();
   json_generator_set_root (jgen, root);
+  data = json_generator_to_data (jgen, &length);
+  json_node_free (root);
 
-  object = json_generator_to_data (jgen, &message_length);
-  message = g_malloc0 (message_length + 5);
-  GST_WRITE_UINT32_BE (message, message_length);
-  strcpy (&message[4], object);
-  g_free (object);
+  g_string_set_size (frame, 4);
+  GST_WRITE_UINT32_BE (frame->str, length);
+  g_string_append_len (frame, data, length);
+  g_free (data);
 
-  res = g_output_stream_write_all (server_ostream, message, message_length + 4,
+  res = g_output_stream_write_all (server_ostream, frame->str, frame->len,
       NULL, NULL, &error);
+  if (!res)
+    GST_ERROR ("ERROR: Can't write to remote: %s", error->message);
+  else if (!(res = g_output_stream_flush (server_ostream, NULL, &error)))
+    GST_ERROR ("ERROR: Can't flush stream: %s", error->message);
+
+  g_clear_error (&error);
+
+  return res;
+}
+
+static gpointer
+gst_validate_server_thread_func (gpointer unused)
+{
+  JsonGenerator *jgen = json_generator_new ();
+  GString *frame = g_string_sized_new (4096);
+  gboolean connected = TRUE;
+
+  g_mutex_lock (&server_lock);
+  while (TRUE) {
+    JsonArray *batch;
+    JsonNode *root;
+
+    while (!server_stopping && g_queue_is_empty (&server_queue)
+        && !server_pending_position)
+      g_cond_wait (&server_cond, &server_lock);
 
-  if (!res) {
-    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PENDING)) {
-      GST_DEBUG ("Stream was busy, trying again later.");
+    /* Everything queued before the stop request is still sent */
+    if (g_queue_is_empty (&server_queue) && !server_pending_position)
+      break;
 
-      g_free (message);
-      g_object_unref (jgen);
-      if (error)
-        g_error_free (error);
-      g_idle_add ((GSourceFunc) gst_validate_send, root);
-      return G_SOURCE_REMOVE;
+    batch = json_array_new ();
+    while (json_array_get_length (batch) < SERVER_BATCH_MAX_SIZE &&
+        (root = g_queue_pop_head (&server_queue)))
+      json_array_add_element (batch, root);
+
+    /* The position is only sent once the queue is drained, so it can come
+     * after messages that were queued later than it. The launcher only uses
+     * it to detect stalled tests, where it keeps the latest value, so it
+     * does not depend on that ordering. */
+    if (g_queue_is_empty (&server_queue) && server_pending_position) {
+      json_array_add_element (batch, server_pending_position);
+      server_pending_position = NULL;
     }
+    g_mutex_unlock (&server_lock);
 
-    GST_ERROR ("ERROR: Can't write to remote: %s", error->message);
-  } else if (!g_output_stream_flush (server_ostream, NULL, &error)) {
-    GST_ERROR ("ERROR: Can't flush stream: %s", error->message);
+    if (connected)
+      connected = gst_validate_server_write_batch (jgen, frame, batch);
+    json_array_unref (batch);
+
+    g_mutex_lock (&server_lock);
   }
+  g_mutex_unlock (&server_lock);
 
-  g_free (message);
+  g_string_free (frame, TRUE);
   g_object_unref (jgen);
-  if (error)
-    g_error_free (error);
 
-done:
-  json_node_free (root);
+  return NULL;
+}
 
-  return G_SOURCE_REMOVE;
+static ReportsRing *
+gst_validate_ring_open (const gchar * path)
+{
+#ifdef G_OS_UNIX
+  gint fd;
+  guint8 *data;
+  ReportsRing *ring;
+  RingHeader *header;
+  gsize size = sizeof (RingHeader) + RING_CAPACITY;
+  gchar *tmp_path = g_strdup_printf ("%s.XXXXXX", path);
+
+  fd = g_mkstemp_full (tmp_path, O_RDWR, 0644);
+  if (fd < 0) {
+    GST_ERROR ("Could not create %s: %s", tmp_path, g_strerror (errno));
+    g_free (tmp_path);
+    return NULL;
+  }
+
+  if (ftruncate (fd, size) < 0) {
+    GST_ERROR ("Could not resize %s: %s", tmp_path, g_strerror (errno));
+    close (fd);
+    goto failed;
+  }
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED) {
+    GST_ERROR ("Could not map %s: %s", tmp_path, g_strerror (errno));
+    goto failed;
+  }
+
+  header = (RingHeader *) data;
+  header->version = RING_VERSION;
+  header->capacity = RING_CAPACITY;
+  header->pid = getpid ();
+  header->position = GST_CLOCK_TIME_NONE;
+  header->duration = GST_CLOCK_TIME_NONE;
+  header->speed = 1.0;
+  g_atomic_int_set (&header->reserved_offset, 0);
+  g_atomic_int_set (&header->write_offset, 0);
+  memcpy (header->magic, RING_MAGIC, sizeof (header->magic));
+
+  if (g_rename (tmp_path, path) < 0) {
+    GST_ERROR ("Could not rename %s to %s: %s", tmp_path, path,
+        g_strerror (errno));
+    munmap (data, size);
+    goto failed;
+  }
+  g_free (tmp_path);
+
+  ring = g_slice_new0 (ReportsRing);
+  ring->data = data;
+  ring->size = size;
+  ring->jgen = json_generator_new ();
+
+  return ring;
+
+failed:
+  g_unlink (tmp_path);
+  g_free (tmp_path);
+
+  return NULL;
+#else
+  GST_ERROR ("Reports rings are not supported on this platform");
+
+  return NULL;
+#endif
 }
 
-void
-gst_validate_report_init (void)
+static void
+gst_validate_ring_close (ReportsRing * ring)
 {
-  const gchar *var, *file_env, *server_env, *uuid;
-  const GDebugKey keys[] = {
-    {"fatal_criticals", GST_VALIDATE_FATAL_CRITICALS},
-    {"fatal_warnings", GST_VALIDATE_FATAL_WARNINGS},
-    {"fatal_issues", GST_VALIDATE_FATAL_ISSUES},
-    {"print_issues", GST_VALIDATE_PRINT_ISSUES},
-    {"print_warnings", GST_VALIDATE_PRINT_WARNINGS},
-    {"print_criticals", GST_VALIDATE_PRINT_CRITICALS}
-  };
+  RingHeader *header = (RingHeader *) ring->data;
 
-  GST_DEBUG_CATEGORY_INIT (gst_validate_report_debug, "gstvalidatereport",
-      GST_DEBUG_FG_YELLOW, "Gst validate reporting");
+  header->flags |= RING_FLAG_CLOSED;
+#ifdef G_OS_UNIX
+  munmap (ring->data, ring->size);
+#endif
+  g_object_unref (ring->jgen);
+  g_slice_free (ReportsRing, ring);
+}
 
-  _gst_validate_report_type = gst_validate_report_get_type ();
+static void
+gst_validate_ring_write (ReportsRing * ring, guint32 type,
+    const gchar * payload, guint32 size)
+{
+  RingHeader *header = (RingHeader *) ring->data;
+  guint32 offset = (guint32) g_atomic_int_get (&header->write_offset);
+  guint32 record_size = sizeof (RingRecord) + GST_ROUND_UP_8 (size);
+  guint32 pos = offset % RING_CAPACITY;
+  RingRecord *record;
+
+  if (record_size > RING_CAPACITY) {
+    GST_WARNING ("Message of %u bytes too big for the ring", size);
+    return;
+  }
 
-  if (_gst_validate_report_start_time == 0) {
-    _gst_validate_report_start_time = gst_util_get_timestamp ();
+  if (record_size > RING_CAPACITY - pos) {
+    g_atomic_int_set (&header->reserved_offset,
+        (gint) (offset + RING_CAPACITY - pos + record_size));
+    record = (RingRecord *) (ring->data + sizeof (RingHeader) + pos);
+    record->size = RING_CAPACITY - pos - sizeof (RingRecord);
+    record->type = RING_RECORD_PADDING;
+    offset += RING_CAPACITY - pos;
+    pos = 0;
+  } else {
+    g_atomic_int_set (&header->reserved_offset, (gint) (offset + record_size));
+  }
 
-    /* init the debug flags */
-    var = g_getenv ("GST_VALIDATE");
-    if (var && strlen (var) > 0) {
-      _gst_validate_flags =
-          g_parse_debug_string (var, keys, G_N_ELEMENTS (keys));
-    }
+  record = (RingRecord *) (ring->data + sizeof (RingHeader) + pos);
+  record->size = size;
+  record->type = type;
+  memcpy ((guint8 *) record + sizeof (RingRecord), payload, size);
 
-    gst_validate_report_load_issues ();
+  g_atomic_int_set (&header->write_offset, (gint) (offset + record_size));
+}
+
+static void
+gst_validate_ring_send (ReportsRing * ring, JsonNode * root)
+{
+  gchar *data;
+  gsize length;
+
+  if (_is_position_message (root)) {
+    RingHeader *header = (RingHeader *) ring->data;
+    JsonObject *object = json_node_get_object (root);
+
+    g_atomic_int_inc (&header->position_seq);
+    header->position = json_object_get_int_member (object, "position");
+    header->duration = json_object_get_int_member (object, "duration");
+    header->speed = json_object_get_double_member (object, "speed");
+    g_atomic_int_inc (&header->position_seq);
+
+    return;
+  }
+
+  json_generator_set_root (ring->jgen, root);
+  data = json_generator_to_data (ring->jgen, &length);
+  gst_validate_ring_write (ring, RING_RECORD_MESSAGE, data, length);
+  g_free (data);
+}
+
+gboolean
+gst_validate_send (JsonNode * root)
+{
+  g_mutex_lock (&server_lock);
+  if (server_ring) {
+    gst_validate_ring_send (server_ring, root);
+    json_node_free (root);
+  } else if (!server_thread || server_stopping) {
+    json_node_free (root);
+  } else if (_is_position_message (root)) {
+    if (server_pending_position)
+      json_node_free (server_pending_position);
+    server_pending_position = root;
+    g_cond_signal (&server_cond);
+  } else {
+    g_queue_push_tail (&server_queue, root);
+    g_cond_signal (&server_cond);
   }
+  g_mutex_unlock (&server_lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gst_validate_server_stop (void)
+{
+  if (!server_thread)
+    return;
+
+  g_mutex_lock (&server_lock);
+  server_stopping = TRUE;
+  g_cond_signal (&server_cond);
+  g_mutex_unlock (&server_lock);
+
+  g_thread_join (server_thread);
+  server_thread = NULL;
+  server_stopping = FALSE;
+}
+
+/* Connects to the server set in GST_VALIDATE_SERVER, announcing the test as
+ * GST_VALIDATE_UUID */
+static void
+gst_validate_server_connect (void)
+{
+  const gchar *server_env, *uuid;
 
   server_env = g_getenv ("GST_VALIDATE_SERVER");
   uuid = g_getenv ("GST_VALIDATE_UUID");
 
-  if (server_env && !uuid) {
+  if (server_env && g_str_has_prefix (server_env, "file://")) {
+    gchar *path = g_filename_from_uri (server_env, NULL, NULL);
+
+    if (!server_ring && path)
+      server_ring = gst_validate_ring_open (path);
+    else if (!path)
+      GST_ERROR ("Server URI not valid: %s", server_env);
+    g_free (path);
+  } else if (server_env && !uuid) {
     GST_INFO ("No GST_VALIDATE_UUID specified !");
   } else if (server_env) {
     GstUri *server_uri = gst_uri_from_string (server_env);
@@ -523,6 +862,8 @@ gst_validate_report_init (void)
       } else {
         server_ostream =
             g_io_stream_get_output_stream (G_IO_STREAM (server_connection));
+        server_thread = g_thread_new ("validate-server",
+            gst_validate_server_thread_func, NULL);
         jbuilder = json_builder_new ();
         json_builder_begin_object (jbuilder);
         json_builder_set_member_name (jbuilder, "uuid");
@@ -540,6 +881,40 @@ gst_validate_report_init (void)
       GST_ERROR ("Server URI not valid: %s", server_env);
     }
   }
+}
+
+void
+gst_validate_report_init (void)
+{
+  const gchar *var, *file_env;
+  const GDebugKey keys[] = {
+    {"fatal_criticals", GST_VALIDATE_FATAL_CRITICALS},
+    {"fatal_warnings", GST_VALIDATE_FATAL_WARNINGS},
+    {"fatal_issues", GST_VALIDATE_FATAL_ISSUES},
+    {"print_issues", GST_VALIDATE_PRINT_ISSUES},
+    {"print_warnings", GST_VALIDATE_PRINT_WARNINGS},
+    {"print_criticals", GST_VALIDATE_PRINT_CRITICALS}
+  };
+
+  GST_DEBUG_CATEGORY_INIT (gst_validate_report_debug, "gstvalidatereport",
+      GST_DEBUG_FG_YELLOW, "Gst validate reporting");
+
+  _gst_validate_report_type = gst_validate_report_get_type ();
+
+  if (_gst_validate_report_start_time == 0) {
+    _gst_validate_report_start_time = gst_util_get_timestamp ();
+
+    /* init the debug flags */
+    var = g_getenv ("GST_VALIDATE");
+    if (var && strlen (var) > 0) {
+      _gst_validate_flags =
+          g_parse_debug_string (var, keys, G_N_ELEMENTS (keys));
+    }
+
+    gst_validate_report_load_issues ();
+  }
+
+  gst_validate_server_connect ();
 
   file_env = g_getenv ("GST_VALIDATE_FILE");
   if (file_env != NULL && *file_env != '\0') {
@@ -583,9 +958,18 @@ gst_validate_report_init (void)
 #endif
 }
 
-void
-gst_validate_report_deinit (void)
+static void
+gst_validate_server_disconnect (void)
 {
+  gst_validate_server_stop ();
+
+  g_mutex_lock (&server_lock);
+  if (server_ring) {
+    gst_validate_ring_close (server_ring);
+    server_ring = NULL;
+  }
+  g_mutex_unlock (&server_lock);
+
   if (server_ostream) {
     g_output_stream_close (server_ostream, NULL, NULL);
     server_ostream = NULL;
@@ -595,10 +979,44 @@ gst_validate_report_deinit (void)
   g_clear_object (&server_connection);
 }
 
+/**
+ * gst_validate_report_reconnect_server:
+ *
+ * Closes the connection to the server GstValidate sends its reports to,
+ * and opens a new one according to the current values of the
+ * GST_VALIDATE_SERVER and GST_VALIDATE_UUID environment variables.
+ *
+ * This lets a process running several tests one after the other report
+ * each of them as a different test.
+ */
+void
+gst_validate_report_reconnect_server (void)
+{
+  gst_validate_server_disconnect ();
+  gst_validate_server_connect ();
+}
+
+void
+gst_validate_report_deinit (void)
+{
+  gst_validate_server_disconnect ();
+
+  g_mutex_lock (&_gst_validate_issues_lock);
+  g_list_free_full (_gst_validate_retired_issues,
+      (GDestroyNotify) g_hash_table_unref);
+  _gst_validate_retired_issues = NULL;
+  g_mutex_unlock (&_gst_validate_issues_lock);
+}
+
 GstValidateIssue *
 gst_validate_issue_from_id (GstValidateIssueId issue_id)
 {
-  return g_hash_table_lookup (_gst_validate_issues, (gpointer) issue_id);
+  GHashTable *issues = g_atomic_pointer_get (&_gst_validate_issues);
+
+  if (G_UNLIKELY (issues == NULL))
+    return NULL;
+
+  return g_hash_table_lookup (issues, (gpointer) issue_id);
 }
 
 /* TODO how are these functions going to work with extensions */
@@ -1080,6 +1498,16 @@ gst_validate_report_print_details (GstValidateReport * report)
   }
 }
 
+static void
+gst_validate_report_print_repeats (GstValidateReport * report)
+{
+  gint n_repeats = g_atomic_int_get (&report->n_repeats);
+
+  if (n_repeats)
+    gst_validate_printf (NULL, "%*s Repeated : %d more time%s\n", 12, "",
+        n_repeats, n_repeats > 1 ? "s" : "");
+}
+
 static void
 gst_validate_report_print_trace (GstValidateReport * report)
 {
@@ -1127,6 +1555,7 @@ gst_validate_report_printf (GstValidateReport * report)
   gst_validate_report_print_level (report);
   gst_validate_report_print_detected_on (report);
   gst_validate_report_print_details (report);
+  gst_validate_report_print_repeats (report);
   gst_validate_report_print_dotfile (report);
   gst_validate_report_print_trace (report);
 
@@ -194,7 +194,11 @@ struct _GstValidateReport {
   gchar *trace;
   gchar *dotfile_name;
 
-  gpointer _gst_reserved[GST_PADDING - 2];
+  /* n_repeats: The number of times the issue was reported again by the
+   * same reporter after this report. Accessed atomically. */
+  gint n_repeats;
+
+  gpointer _gst_reserved[GST_PADDING - 3];
 };
 
 void gst_validate_report_add_message (GstValidateReport *report,
@@ -214,6 +218,8 @@ void gst_validate_report_add_message (GstValidateReport *report,
 GST_VALIDATE_API
 void               gst_validate_report_init (void);
 GST_VALIDATE_API
+void               gst_validate_report_reconnect_server (void);
+GST_VALIDATE_API
 GstValidateIssue  *gst_validate_issue_from_id (GstValidateIssueId issue_id);
 GST_VALIDATE_API
 GstValidateIssueId gst_validate_issue_get_id (GstValidateIssue * issue);
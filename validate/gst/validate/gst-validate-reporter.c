@@ -35,6 +35,8 @@
 
 #define REPORTER_PRIVATE "gst-validate-reporter-private"
 
+static GQuark _Q_REPORTER_PRIVATE = 0;
+
 typedef struct _GstValidateReporterPrivate
 {
   GWeakRef runner;
@@ -51,6 +53,8 @@ G_DEFINE_INTERFACE (GstValidateReporter, gst_validate_reporter, G_TYPE_OBJECT);
 static void
 gst_validate_reporter_default_init (GstValidateReporterInterface * iface)
 {
+  _Q_REPORTER_PRIVATE = g_quark_from_static_string (REPORTER_PRIVATE);
+
   g_object_interface_install_property (iface,
       g_param_spec_object ("validate-runner", "Validate Runner",
           "The Validate runner to report errors to",
@@ -73,34 +77,40 @@ _free_priv (GstValidateReporterPrivate * priv)
   g_slice_free (GstValidateReporterPrivate, priv);
 }
 
+/* Called on every report, so the private data is looked up with its quark
+ * directly instead of going through the global quark table each time */
 static GstValidateReporterPrivate *
 gst_validate_reporter_get_priv (GstValidateReporter * reporter)
 {
   GstValidateReporterPrivate *priv;
 
-  priv = g_object_get_data (G_OBJECT (reporter), REPORTER_PRIVATE);
+  priv = g_object_get_qdata (G_OBJECT (reporter), _Q_REPORTER_PRIVATE);
 
-  if (priv == NULL) {
+  if (G_UNLIKELY (priv == NULL)) {
     priv = g_slice_new0 (GstValidateReporterPrivate);
     priv->reports = g_hash_table_new_full (g_direct_hash,
         g_direct_equal, NULL, (GDestroyNotify) gst_validate_report_unref);
 
     g_mutex_init (&priv->reports_lock);
-    g_object_set_data_full (G_OBJECT (reporter), REPORTER_PRIVATE, priv,
-        (GDestroyNotify) _free_priv);
+    if (!g_object_replace_qdata (G_OBJECT (reporter), _Q_REPORTER_PRIVATE,
+            NULL, priv, (GDestroyNotify) _free_priv, NULL)) {
+      /* Another thread beat us to it */
+      _free_priv (priv);
+      priv = g_object_get_qdata (G_OBJECT (reporter), _Q_REPORTER_PRIVATE);
+    }
   }
 
   return priv;
 }
 
-#define GST_VALIDATE_REPORTER_REPORTS_LOCK(r)			\
+#define GST_VALIDATE_REPORTER_REPORTS_LOCK(p)			\
   G_STMT_START {					\
-  (g_mutex_lock (&gst_validate_reporter_get_priv(GST_VALIDATE_REPORTER_CAST(r))->reports_lock));		\
+  (g_mutex_lock (&(p)->reports_lock));			\
   } G_STMT_END
 
-#define GST_VALIDATE_REPORTER_REPORTS_UNLOCK(r)			\
+#define GST_VALIDATE_REPORTER_REPORTS_UNLOCK(p)			\
   G_STMT_START {					\
-  (g_mutex_unlock (&gst_validate_reporter_get_priv(GST_VALIDATE_REPORTER_CAST(r))->reports_lock));		\
+  (g_mutex_unlock (&(p)->reports_lock));			\
   } G_STMT_END
 
 static GstValidateInterceptionReturn
@@ -157,32 +167,77 @@ gst_validate_reporter_get_report (GstValidateReporter * reporter,
   GstValidateReport *report;
   GstValidateReporterPrivate *priv = gst_validate_reporter_get_priv (reporter);
 
-  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
   report = g_hash_table_lookup (priv->reports, (gconstpointer) issue_id);
-  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
 
   return report;
 }
 
+/* Whether each repetition of an issue has to be kept with its message, or
+ * only counted on the first report of that issue */
+static gboolean
+gst_validate_reporter_keeps_repeated_reports (GstValidateReporter * reporter,
+    GstValidateRunner * runner)
+{
+  GstValidateReportingDetails reporter_level =
+      gst_validate_reporter_get_reporting_level (reporter);
+  GstValidateReportingDetails runner_level = GST_VALIDATE_SHOW_UNKNOWN;
+
+  if (reporter_level == GST_VALIDATE_SHOW_ALL)
+    return TRUE;
+
+  if (runner)
+    runner_level = gst_validate_runner_get_default_reporting_level (runner);
+
+  return runner_level == GST_VALIDATE_SHOW_ALL &&
+      reporter_level == GST_VALIDATE_SHOW_UNKNOWN;
+}
+
 void
 gst_validate_report_valist (GstValidateReporter * reporter,
     GstValidateIssueId issue_id, const gchar * format, va_list var_args)
 {
   GstValidateReport *report, *prev_report;
-  gchar *message, *combo;
+  gchar *message = NULL, *combo;
   va_list vacopy;
   GstValidateIssue *issue;
-  GstValidateReporterPrivate *priv = gst_validate_reporter_get_priv (reporter);
+  GstValidateReporterPrivate *priv;
   GstValidateInterceptionReturn int_ret;
   GstValidateRunner *runner = NULL;
+  gboolean keep_repeated;
 
   issue = gst_validate_issue_from_id (issue_id);
 
   g_return_if_fail (issue != NULL);
   g_return_if_fail (GST_IS_VALIDATE_REPORTER (reporter));
 
+  priv = gst_validate_reporter_get_priv (reporter);
+  runner = gst_validate_reporter_get_runner (reporter);
+  keep_repeated = gst_validate_reporter_keeps_repeated_reports (reporter,
+      runner);
+
+  /* An issue that was already reported by @reporter is only counted, without
+   * formatting its message or building a new report (and backtrace), unless
+   * @reporter intercepts reports: the hook is called for each of them */
+  if (!keep_repeated
+      && !GST_VALIDATE_REPORTER_GET_INTERFACE (reporter)->intercept_report) {
+    GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
+    prev_report = g_hash_table_lookup (priv->reports, (gconstpointer) issue_id);
+    if (prev_report)
+      g_atomic_int_inc (&prev_report->n_repeats);
+    GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
+
+    if (prev_report) {
+      GST_LOG ("<%s> %" GST_VALIDATE_ISSUE_FORMAT " repeated", priv->name,
+          GST_VALIDATE_ISSUE_ARGS (issue));
+      goto done;
+    }
+  }
+
   G_VA_COPY (vacopy, var_args);
   message = g_strdup_vprintf (format, vacopy);
+  va_end (vacopy);
   report = gst_validate_report_new (issue, reporter, message);
 
 #ifndef GST_DISABLE_GST_DEBUG
@@ -203,8 +258,8 @@ gst_validate_report_valist (GstValidateReporter * reporter,
     gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_DEBUG, __FILE__,
         GST_FUNCTION, __LINE__, NULL, combo, vacopy);
   g_free (combo);
-#endif
   va_end (vacopy);
+#endif
 
   int_ret = gst_validate_reporter_intercept_report (reporter, report);
 
@@ -213,30 +268,31 @@ gst_validate_report_valist (GstValidateReporter * reporter,
     goto done;
   }
 
+  /* Lookup and insertion are done at once so that concurrent reports of the
+   * same issue end up as repetitions of a single report */
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
   prev_report = g_hash_table_lookup (priv->reports, (gconstpointer) issue_id);
-
-  runner = gst_validate_reporter_get_runner (reporter);
   if (prev_report) {
-    GstValidateReportingDetails reporter_level =
-        gst_validate_reporter_get_reporting_level (reporter);
-    GstValidateReportingDetails runner_level = GST_VALIDATE_SHOW_UNKNOWN;
-
-    if (runner)
-      runner_level = gst_validate_runner_get_default_reporting_level (runner);
-
-    if (reporter_level == GST_VALIDATE_SHOW_ALL ||
-        (runner_level == GST_VALIDATE_SHOW_ALL &&
-            reporter_level == GST_VALIDATE_SHOW_UNKNOWN))
+    g_atomic_int_inc (&prev_report->n_repeats);
+    if (keep_repeated && runner)
+      gst_validate_report_ref (prev_report);
+    else if (keep_repeated)
       gst_validate_report_add_repeated_report (prev_report, report);
+  } else {
+    g_hash_table_insert (priv->reports, (gpointer) issue_id, report);
+  }
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
 
+  if (prev_report) {
+    /* The runner keeps count of the repetitions of its reports */
+    if (keep_repeated && runner) {
+      gst_validate_runner_add_repeated_report (runner, prev_report, report);
+      gst_validate_report_unref (prev_report);
+    }
     gst_validate_report_unref (report);
     goto done;
   }
 
-  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
-  g_hash_table_insert (priv->reports, (gpointer) issue_id, report);
-  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
-
   if (runner && int_ret == GST_VALIDATE_REPORTER_REPORT) {
     gst_validate_runner_add_report (runner, report);
   }
@@ -273,6 +329,7 @@ gst_validate_default_log_hanlder (const gchar * log_domain,
 static void
 gst_validate_reporter_destroyed (gpointer udata, GObject * freed_reporter)
 {
+  g_log_set_default_handler (g_log_default_handler, NULL);
   g_log_set_handler ("GStreamer",
       G_LOG_LEVEL_MASK, (GLogFunc) gst_validate_default_log_hanlder, NULL);
   g_log_set_handler ("GLib",
@@ -428,9 +485,9 @@ gst_validate_reporter_get_reports (GstValidateReporter * reporter)
   GList *reports, *tmp;
   GList *ret = NULL;
 
-  priv = g_object_get_data (G_OBJECT (reporter), REPORTER_PRIVATE);
+  priv = gst_validate_reporter_get_priv (reporter);
 
-  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
   reports = g_hash_table_get_values (priv->reports);
   for (tmp = reports; tmp; tmp = tmp->next) {
     ret =
@@ -438,7 +495,7 @@ gst_validate_reporter_get_reports (GstValidateReporter * reporter)
         gst_validate_report_ref ((GstValidateReport *) (tmp->data)));
   }
   g_list_free (reports);
-  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
 
   return ret;
 }
@@ -457,11 +514,11 @@ gst_validate_reporter_get_reports_count (GstValidateReporter * reporter)
   GstValidateReporterPrivate *priv;
   gint ret;
 
-  priv = g_object_get_data (G_OBJECT (reporter), REPORTER_PRIVATE);
+  priv = gst_validate_reporter_get_priv (reporter);
 
-  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
   ret = g_hash_table_size (priv->reports);
-  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
 
   return ret;
 }
@@ -478,9 +535,9 @@ gst_validate_reporter_purge_reports (GstValidateReporter * reporter)
 {
   GstValidateReporterPrivate *priv;
 
-  priv = g_object_get_data (G_OBJECT (reporter), REPORTER_PRIVATE);
+  priv = gst_validate_reporter_get_priv (reporter);
 
-  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (priv);
   g_hash_table_remove_all (priv->reports);
-  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (priv);
 }
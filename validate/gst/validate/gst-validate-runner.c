@@ -76,15 +76,53 @@ static GstValidateRunner *first_runner = NULL;
  * ]|
  */
 
+/* Reports are first staged in one of a fixed number of staging areas, picked
+ * by hashing the reporting thread, and are merged into the runner in batches
+ * so that streaming threads do not all contend on the runner lock for each
+ * report. Threads whose hashes collide share a staging area and its lock.
+ * Each staged report gets a sequence number and all the staging areas are
+ * merged at once, in that order, so the runner keeps the reports in the
+ * order they were added. */
+#define REPORTS_STAGING_AREAS 16
+#define REPORTS_STAGING_SIZE 32
+
+typedef struct
+{
+  GstValidateReport *report;
+  gboolean synthesize;
+  guint seqnum;
+} StagedReport;
+
+typedef struct
+{
+  GMutex lock;
+  StagedReport reports[REPORTS_STAGING_SIZE];
+  guint n_reports;
+} ReportsStaging;
+
 struct _GstValidateRunnerPrivate
 {
   GMutex mutex;
-  GList *reports;
+  /* GstValidateReport */
+  GPtrArray *reports;
+  /* The same reports, to find whether a repeated report belongs to them */
+  GHashTable *reports_set;
+  /* Number of reports in reports plus their repetitions */
+  guint n_reports;
   GstValidateReportingDetails default_level;
+  /* issue_id -> GPtrArray of GstValidateReport */
   GHashTable *reports_by_type;
 
+  ReportsStaging staging[REPORTS_STAGING_AREAS];
+  /* Sequence number of the next staged report */
+  volatile gint next_seqnum;
+
   /* A list of PatternLevel */
   GList *report_pattern_levels;
+  /* name -> GstValidateReportingDetails, as the same parent names get looked
+   * up for each new monitor */
+  GHashTable *reporting_levels_cache;
+  GMutex reporting_levels_lock;
 
   /* Whether the runner was create with GST_TRACERS=validate or not) */
   gboolean user_created;
@@ -93,6 +131,9 @@ struct _GstValidateRunnerPrivate
   gchar **pipeline_names_strv;
 };
 
+/* Bound the number of names for which the reporting level is kept around */
+#define REPORTING_LEVELS_CACHE_MAX_SIZE 4096
+
 /* Describes the reporting level to apply to a name pattern */
 typedef struct _PatternLevel
 {
@@ -305,33 +346,153 @@ _init_report_levels (GstValidateRunner * self)
     _set_report_levels_from_string (self, env);
 }
 
+static ReportsStaging *
+_get_reports_staging (GstValidateRunner * runner)
+{
+  guintptr thread = (guintptr) g_thread_self ();
+
+  return &runner->priv->staging[(thread >> 6) % REPORTS_STAGING_AREAS];
+}
+
+/* Must be called with the runner lock taken */
 static void
-_unref_report_list (gpointer unused, GList * reports, gpointer unused_too)
+_synthesize_report_unlocked (GstValidateRunner * runner,
+    GstValidateReport * report)
 {
-  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+  GstValidateIssueId issue_id = report->issue->issue_id;
+  GPtrArray *reports = g_hash_table_lookup (runner->priv->reports_by_type,
+      (gconstpointer) issue_id);
+
+  if (!reports) {
+    reports =
+        g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_validate_report_unref);
+    g_hash_table_insert (runner->priv->reports_by_type, (gpointer) issue_id,
+        reports);
+  }
+
+  g_ptr_array_add (reports, report);
+}
+
+/* Must be called with the runner lock taken */
+static void
+_add_report_unlocked (GstValidateRunner * runner, GstValidateReport * report)
+{
+  g_ptr_array_add (runner->priv->reports, report);
+  g_hash_table_add (runner->priv->reports_set, report);
+
+  /* Repetitions added while the report was staged were not counted yet */
+  runner->priv->n_reports += 1 + g_list_length (report->repeated_reports);
+}
+
+static gint
+_compare_staged_reports (const StagedReport * a, const StagedReport * b,
+    gpointer unused)
+{
+  return (gint) (a->seqnum - b->seqnum);
+}
+
+/* Makes sure all staged reports are visible in the runner. Must be called
+ * without any staging lock taken, the runner lock is always taken after the
+ * staging locks */
+static void
+_flush_reports (GstValidateRunner * runner)
+{
+  StagedReport *staged;
+  guint i, n_staged = 0;
+
+  /* Sequence numbers are taken with a staging lock held, so once they are all
+   * held every report staged so far is in there and the ones staged after
+   * the merge come after those in the runner */
+  for (i = 0; i < REPORTS_STAGING_AREAS; i++) {
+    g_mutex_lock (&runner->priv->staging[i].lock);
+    n_staged += runner->priv->staging[i].n_reports;
+  }
+
+  if (!n_staged)
+    goto done;
+
+  staged = g_new (StagedReport, n_staged);
+  n_staged = 0;
+  for (i = 0; i < REPORTS_STAGING_AREAS; i++) {
+    ReportsStaging *staging = &runner->priv->staging[i];
+
+    memcpy (staged + n_staged, staging->reports,
+        staging->n_reports * sizeof (StagedReport));
+    n_staged += staging->n_reports;
+    staging->n_reports = 0;
+  }
+  g_qsort_with_data (staged, n_staged, sizeof (StagedReport),
+      (GCompareDataFunc) _compare_staged_reports, NULL);
+
+  GST_VALIDATE_RUNNER_LOCK (runner);
+  for (i = 0; i < n_staged; i++) {
+    if (staged[i].synthesize)
+      _synthesize_report_unlocked (runner, staged[i].report);
+    else
+      _add_report_unlocked (runner, staged[i].report);
+  }
+  GST_VALIDATE_RUNNER_UNLOCK (runner);
+  g_free (staged);
+
+done:
+  for (i = REPORTS_STAGING_AREAS; i > 0; i--)
+    g_mutex_unlock (&runner->priv->staging[i - 1].lock);
+}
+
+static void
+_stage_report (GstValidateRunner * runner, GstValidateReport * report,
+    gboolean synthesize)
+{
+  ReportsStaging *staging = _get_reports_staging (runner);
+  gboolean full;
+
+  g_mutex_lock (&staging->lock);
+  while (staging->n_reports == REPORTS_STAGING_SIZE) {
+    /* Filled up by other threads since we flushed it */
+    g_mutex_unlock (&staging->lock);
+    _flush_reports (runner);
+    g_mutex_lock (&staging->lock);
+  }
+
+  staging->reports[staging->n_reports].report =
+      gst_validate_report_ref (report);
+  staging->reports[staging->n_reports].synthesize = synthesize;
+  staging->reports[staging->n_reports].seqnum =
+      (guint) g_atomic_int_add (&runner->priv->next_seqnum, 1);
+  full = ++staging->n_reports == REPORTS_STAGING_SIZE;
+  g_mutex_unlock (&staging->lock);
+
+  if (full)
+    _flush_reports (runner);
 }
 
 static void
 gst_validate_runner_finalize (GObject * object)
 {
+  guint i;
   GstValidateRunner *runner = GST_VALIDATE_RUNNER_CAST (object);
 
   if (!runner->priv->user_created)
     gst_validate_runner_exit (runner, TRUE);
 
-  g_list_free_full (runner->priv->reports,
-      (GDestroyNotify) gst_validate_report_unref);
+  _flush_reports (runner);
+  for (i = 0; i < REPORTS_STAGING_AREAS; i++)
+    g_mutex_clear (&runner->priv->staging[i].lock);
+
+  g_hash_table_unref (runner->priv->reports_set);
+  g_ptr_array_unref (runner->priv->reports);
 
   g_list_free_full (runner->priv->report_pattern_levels,
       (GDestroyNotify) _free_report_pattern_level);
+  g_hash_table_unref (runner->priv->reporting_levels_cache);
+  g_mutex_clear (&runner->priv->reporting_levels_lock);
 
   g_mutex_clear (&runner->priv->mutex);
 
   g_free (runner->priv->pipeline_names);
   g_strfreev (runner->priv->pipeline_names_strv);
 
-  g_hash_table_foreach (runner->priv->reports_by_type, (GHFunc)
-      _unref_report_list, NULL);
   g_hash_table_destroy (runner->priv->reports_by_type);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -438,10 +599,21 @@ gst_validate_runner_class_init (GstValidateRunnerClass * klass)
 static void
 gst_validate_runner_init (GstValidateRunner * runner)
 {
+  guint i;
+
   runner->priv = gst_validate_runner_get_instance_private (runner);
 
-  runner->priv->reports_by_type = g_hash_table_new (g_direct_hash,
-      g_direct_equal);
+  runner->priv->reports =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_validate_report_unref);
+  runner->priv->reports_set = g_hash_table_new (NULL, NULL);
+  runner->priv->reports_by_type = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+  for (i = 0; i < REPORTS_STAGING_AREAS; i++)
+    g_mutex_init (&runner->priv->staging[i].lock);
+  runner->priv->reporting_levels_cache = g_hash_table_new_full (g_str_hash,
+      g_str_equal, g_free, NULL);
+  g_mutex_init (&runner->priv->reporting_levels_lock);
 
   runner->priv->default_level = GST_VALIDATE_SHOW_DEFAULT;
   _init_report_levels (runner);
@@ -523,41 +695,50 @@ gst_validate_runner_get_reporting_level_for_name (GstValidateRunner * runner,
 {
   GList *tmp;
   gchar *fixed_name;
+  gpointer cached;
+  GstValidateReportingDetails level = GST_VALIDATE_SHOW_UNKNOWN;
 
   g_return_val_if_fail (GST_IS_VALIDATE_RUNNER (runner),
       GST_VALIDATE_SHOW_UNKNOWN);
 
+  if (!runner->priv->report_pattern_levels || !name)
+    return GST_VALIDATE_SHOW_UNKNOWN;
+
+  g_mutex_lock (&runner->priv->reporting_levels_lock);
+  if (g_hash_table_lookup_extended (runner->priv->reporting_levels_cache, name,
+          NULL, &cached)) {
+    g_mutex_unlock (&runner->priv->reporting_levels_lock);
+
+    return GPOINTER_TO_INT (cached);
+  }
+  g_mutex_unlock (&runner->priv->reporting_levels_lock);
+
   fixed_name = g_strdup (name);
   _replace_double_colons (fixed_name);
   for (tmp = runner->priv->report_pattern_levels; tmp; tmp = tmp->next) {
     PatternLevel *pattern_level = (PatternLevel *) tmp->data;
     if (g_pattern_match_string (pattern_level->pattern, fixed_name)) {
-      g_free (fixed_name);
-
-      return pattern_level->level;
+      level = pattern_level->level;
+      break;
     }
   }
-
   g_free (fixed_name);
-  return GST_VALIDATE_SHOW_UNKNOWN;
-}
 
-static void
-synthesize_reports (GstValidateRunner * runner, GstValidateReport * report)
-{
-  GstValidateIssueId issue_id;
-  GList *reports;
+  g_mutex_lock (&runner->priv->reporting_levels_lock);
+  if (g_hash_table_size (runner->priv->reporting_levels_cache) >=
+      REPORTING_LEVELS_CACHE_MAX_SIZE)
+    g_hash_table_remove_all (runner->priv->reporting_levels_cache);
+  g_hash_table_insert (runner->priv->reporting_levels_cache, g_strdup (name),
+      GINT_TO_POINTER (level));
+  g_mutex_unlock (&runner->priv->reporting_levels_lock);
 
-  issue_id = report->issue->issue_id;
+  return level;
+}
 
-  GST_VALIDATE_RUNNER_LOCK (runner);
-  reports =
-      g_hash_table_lookup (runner->priv->reports_by_type,
-      (gconstpointer) issue_id);
-  reports = g_list_append (reports, gst_validate_report_ref (report));
-  g_hash_table_insert (runner->priv->reports_by_type, (gpointer) issue_id,
-      reports);
-  GST_VALIDATE_RUNNER_UNLOCK (runner);
+gboolean
+gst_validate_runner_has_reporting_level_patterns (GstValidateRunner * runner)
+{
+  return runner->priv->report_pattern_levels != NULL;
 }
 
 static void
@@ -658,13 +839,13 @@ gst_validate_runner_add_report (GstValidateRunner * runner,
         if (!gst_validate_report_check_abort (report) &&
             report->level != GST_VALIDATE_REPORT_LEVEL_CRITICAL &&
             !report->trace) {
-          synthesize_reports (runner, report);
+          _stage_report (runner, report, TRUE);
           return;
         }
         break;
       case GST_VALIDATE_SHOW_SYNTHETIC:
         if (!report->trace) {
-          synthesize_reports (runner, report);
+          _stage_report (runner, report, TRUE);
           return;
         }
       default:
@@ -675,14 +856,26 @@ gst_validate_runner_add_report (GstValidateRunner * runner,
     return;
   }
 
-  GST_VALIDATE_RUNNER_LOCK (runner);
-  runner->priv->reports =
-      g_list_append (runner->priv->reports, gst_validate_report_ref (report));
-  GST_VALIDATE_RUNNER_UNLOCK (runner);
+  _stage_report (runner, report, FALSE);
 
+  /* All the readers merge the staged reports first, so the report is already
+   * visible to the handlers, in order */
   g_signal_emit (runner, _signals[REPORT_ADDED_SIGNAL], 0, report);
 }
 
+/* Adds @repeated_report to the repetitions of @report, counting it if
+ * @report was added to @runner */
+void
+gst_validate_runner_add_repeated_report (GstValidateRunner * runner,
+    GstValidateReport * report, GstValidateReport * repeated_report)
+{
+  GST_VALIDATE_RUNNER_LOCK (runner);
+  gst_validate_report_add_repeated_report (report, repeated_report);
+  if (g_hash_table_contains (runner->priv->reports_set, report))
+    runner->priv->n_reports++;
+  GST_VALIDATE_RUNNER_UNLOCK (runner);
+}
+
 /**
  * gst_validate_runner_get_reports_count:
  * @runner: The $GstValidateRunner to get the number of reports from
@@ -694,17 +887,14 @@ gst_validate_runner_add_report (GstValidateRunner * runner,
 guint
 gst_validate_runner_get_reports_count (GstValidateRunner * runner)
 {
-  GList *tmp;
   guint l;
 
   g_return_val_if_fail (GST_IS_VALIDATE_RUNNER (runner), 0);
 
+  _flush_reports (runner);
+
   GST_VALIDATE_RUNNER_LOCK (runner);
-  l = g_list_length (runner->priv->reports);
-  for (tmp = runner->priv->reports; tmp; tmp = tmp->next) {
-    GstValidateReport *report = (GstValidateReport *) tmp->data;
-    l += g_list_length (report->repeated_reports);
-  }
+  l = runner->priv->n_reports;
   l += g_hash_table_size (runner->priv->reports_by_type);
   GST_VALIDATE_RUNNER_UNLOCK (runner);
 
@@ -720,12 +910,16 @@ gst_validate_runner_get_reports_count (GstValidateRunner * runner)
 GList *
 gst_validate_runner_get_reports (GstValidateRunner * runner)
 {
-  GList *ret;
+  guint i;
+  GList *ret = NULL;
+
+  _flush_reports (runner);
 
   GST_VALIDATE_RUNNER_LOCK (runner);
-  ret =
-      g_list_copy_deep (runner->priv->reports,
-      (GCopyFunc) gst_validate_report_ref, NULL);
+  for (i = runner->priv->reports->len; i > 0; i--)
+    ret = g_list_prepend (ret,
+        gst_validate_report_ref (g_ptr_array_index (runner->priv->reports,
+                i - 1)));
   GST_VALIDATE_RUNNER_UNLOCK (runner);
 
   return ret;
@@ -734,23 +928,26 @@ gst_validate_runner_get_reports (GstValidateRunner * runner)
 static GList *
 _do_report_synthesis (GstValidateRunner * runner)
 {
+  guint i;
   GHashTableIter iter;
-  GList *reports, *tmp;
+  GPtrArray *reports;
   gpointer key, value;
   GList *criticals = NULL;
 
+  _flush_reports (runner);
+
   /* Take the lock so the hash table won't be modified while we are iterating
    * over it */
   GST_VALIDATE_RUNNER_LOCK (runner);
   g_hash_table_iter_init (&iter, runner->priv->reports_by_type);
   while (g_hash_table_iter_next (&iter, &key, &value)) {
     GstValidateReport *report;
-    reports = (GList *) value;
+    reports = (GPtrArray *) value;
 
-    if (!reports)
+    if (!reports->len)
       continue;
 
-    report = (GstValidateReport *) (reports->data);
+    report = g_ptr_array_index (reports, 0);
 
     gst_validate_report_print_level (report);
     gst_validate_report_print_detected_on (report);
@@ -760,8 +957,8 @@ _do_report_synthesis (GstValidateRunner * runner)
       gst_validate_report_print_details (report);
     }
 
-    for (tmp = g_list_next (reports); tmp; tmp = tmp->next) {
-      report = (GstValidateReport *) tmp->data;
+    for (i = 1; i < reports->len; i++) {
+      report = g_ptr_array_index (reports, i);
       gst_validate_report_print_detected_on (report);
 
       if (report->level == GST_VALIDATE_REPORT_LEVEL_CRITICAL) {
@@ -769,7 +966,7 @@ _do_report_synthesis (GstValidateRunner * runner)
         gst_validate_report_print_details (report);
       }
     }
-    report = (GstValidateReport *) (reports->data);
+    report = g_ptr_array_index (reports, 0);
     gst_validate_report_print_description (report);
     gst_validate_printf (NULL, "\n");
   }
@@ -829,6 +1026,40 @@ gst_validate_runner_printf (GstValidateRunner * runner)
   return ret;
 }
 
+/**
+ * gst_validate_runner_reset:
+ * @runner: The #GstValidateRunner to reset
+ *
+ * Drops all the reports of @runner and reloads its reporting details from
+ * the environment so that it can be used to run another test. Only one
+ * #GstValidateRunner can be created once elements exist, so tools running
+ * several tests in the same process reuse it that way. Nothing must be
+ * reporting to @runner while it is being reset.
+ */
+void
+gst_validate_runner_reset (GstValidateRunner * runner)
+{
+  g_return_if_fail (GST_IS_VALIDATE_RUNNER (runner));
+
+  _flush_reports (runner);
+
+  GST_VALIDATE_RUNNER_LOCK (runner);
+  g_hash_table_remove_all (runner->priv->reports_set);
+  g_ptr_array_set_size (runner->priv->reports, 0);
+  runner->priv->n_reports = 0;
+  g_hash_table_remove_all (runner->priv->reports_by_type);
+  GST_VALIDATE_RUNNER_UNLOCK (runner);
+
+  g_mutex_lock (&runner->priv->reporting_levels_lock);
+  g_list_free_full (runner->priv->report_pattern_levels,
+      (GDestroyNotify) _free_report_pattern_level);
+  runner->priv->report_pattern_levels = NULL;
+  g_hash_table_remove_all (runner->priv->reporting_levels_cache);
+  runner->priv->default_level = GST_VALIDATE_SHOW_DEFAULT;
+  _init_report_levels (runner);
+  g_mutex_unlock (&runner->priv->reporting_levels_lock);
+}
+
 int
 gst_validate_runner_exit (GstValidateRunner * runner, gboolean print_result)
 {
@@ -838,12 +1069,16 @@ gst_validate_runner_exit (GstValidateRunner * runner, gboolean print_result)
   if (print_result) {
     ret = gst_validate_runner_printf (runner);
   } else {
-    GList *tmp;
-    for (tmp = runner->priv->reports; tmp; tmp = tmp->next) {
-      GstValidateReport *report = (GstValidateReport *) tmp->data;
+    guint i;
+
+    _flush_reports (runner);
+    GST_VALIDATE_RUNNER_LOCK (runner);
+    for (i = 0; i < runner->priv->reports->len; i++) {
+      GstValidateReport *report = g_ptr_array_index (runner->priv->reports, i);
       if (report->level == GST_VALIDATE_REPORT_LEVEL_CRITICAL)
         ret = 18;
     }
+    GST_VALIDATE_RUNNER_UNLOCK (runner);
   }
 
   return ret;
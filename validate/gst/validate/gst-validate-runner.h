@@ -89,6 +89,8 @@ GST_VALIDATE_API
 int             gst_validate_runner_printf (GstValidateRunner * runner);
 GST_VALIDATE_API
 int             gst_validate_runner_exit (GstValidateRunner * runner, gboolean print_result);
+GST_VALIDATE_API
+void            gst_validate_runner_reset (GstValidateRunner * runner);
 
 GST_VALIDATE_API
 GstValidateReportingDetails gst_validate_runner_get_default_reporting_level (GstValidateRunner *runner);
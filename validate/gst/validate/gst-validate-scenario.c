@@ -35,6 +35,10 @@
  *    milliseconds (1/1000ths of a second), between which actions
  *    will be executed, setting it to 0 means "execute in idle".
  *    The default value is 10ms.
+ *  * scenario-clock-scheduling: When set to %TRUE, instead of checking the
+ *    position at every interval, the scenario waits on the pipeline clock
+ *    until the playback time of the next action is reached. The wait is
+ *    re-armed on seeks and state changes.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -45,6 +49,7 @@
 #include <gio/gio.h>
 #include <string.h>
 #include <errno.h>
+#include <glib/gstdio.h>
 
 #include "gst-validate-internal.h"
 #include "gst-validate-scenario.h"
@@ -59,6 +64,12 @@
 #define GST_VALIDATE_SCENARIO_SUFFIX ".scenario"
 #define GST_VALIDATE_SCENARIO_DIRECTORY "scenarios"
 
+/* Maximum time to wait on the clock before checking the position again, in
+ * case it jumped without us being notified */
+#define MAX_CLOCK_WAIT (500 * GST_MSECOND)
+/* How often a sink held back in fast-forward mode rechecks whether it
+ * should keep waiting, in microseconds */
+#define FAST_FORWARD_POLL_INTERVAL (20 * G_TIME_SPAN_MILLISECOND)
 #define DEFAULT_SEEK_TOLERANCE (1 * GST_MSECOND)        /* tolerance seek interval
                                                            TODO make it overridable  */
 
@@ -110,6 +121,24 @@ _fill_action (GstValidateScenario * scenario, GstValidateAction * action,
     GstStructure * structure, gboolean add_to_lists);
 static gboolean _action_set_done (GstValidateAction * action);
 
+/* State shared with the probes installed on the sinks in fast-forward mode,
+ * which might outlive the scenario */
+typedef struct
+{
+  gint refcount;
+
+  GMutex lock;
+  GCond cond;
+  GWeakRef scenario;
+  gboolean stopped;
+
+  /* Playback time of the next action, sinks do not render data past it
+   * until it has been executed */
+  GstClockTime target;
+  /* Furthest stream time that reached a sink */
+  GstClockTime position;
+} FastForward;
+
 /* GstValidateScenario is not really thread safe and
  * everything should be done from the thread GstValidate
  * was inited from, unless stated otherwise.
@@ -146,10 +175,25 @@ struct _GstValidateScenarioPrivate
   gboolean handles_state;
 
   guint execute_actions_source_id;      /* MT safe. Protect with SCENARIO_LOCK */
+  /* Single shot clock wait for the playback time of the next action, used
+   * instead of execute_actions_source_id when clock_scheduling is set */
+  gboolean clock_scheduling;
+  GstClockID clock_id;          /* MT safe. Protect with SCENARIO_LOCK */
+  /* The thread default main context when the scenario was created, which
+   * is where clock and streaming threads hand work over to */
+  GMainContext *context;
   guint wait_id;
   guint signal_handler_id;
   guint action_execution_interval;
 
+  /* Whether consecutive untimed actions completing synchronously are all
+   * executed from the same dispatch */
+  gboolean batch_actions;
+
+  /* Set when sinks run unsynchronised and are held back at the playback
+   * time of the next action instead, see _setup_fast_forward_sink() */
+  FastForward *fast_forward;
+
   /* Name of message the wait action is waiting for */
   const gchar *message_type;
 
@@ -173,6 +217,11 @@ struct _GstValidateScenarioPrivate
 
   GstStructure *vars;
 
+  /* Expression string -> GstValidateExpression, so that action times and
+   * repeat counts are only parsed once for the whole scenario */
+  GHashTable *expressions;
+  GMutex expressions_lock;
+
   GWeakRef ref_pipeline;
 };
 
@@ -244,6 +293,8 @@ struct _GstValidateActionPrivate
 
   GstClockTime execution_time;
   GstClockTime timeout;
+  /* Whether the action started being executed */
+  gboolean executed;
 
   GWeakRef scenario;
   gboolean needs_playback_parsing;
@@ -288,6 +339,8 @@ gst_validate_action_get_type (void)
 }
 
 static gboolean execute_next_action (GstValidateScenario * scenario);
+static void _unschedule_clock_id (GstValidateScenario * scenario);
+static void _remove_execute_actions_source (GstValidateScenario * scenario);
 static gboolean
 gst_validate_scenario_load (GstValidateScenario * scenario,
     const gchar * scenario_name, const gchar * relative_scenario);
@@ -504,24 +557,31 @@ static gchar *
 _replace_variables_in_string (GstValidateScenario * scenario,
     GstValidateAction * action, const gchar * in_string)
 {
-  GRegex *regex;
-  gint varname_len;
-  GMatchInfo *match_info;
-  const gchar *var_value;
-  gchar *tmpstring, *string = g_strdup (in_string);
+  const gchar *p, *start;
+  GString *string;
 
   _update_well_known_vars (scenario);
-  regex = g_regex_new ("\\$\\((\\w+)\\)", 0, 0, NULL);
-  g_regex_match (regex, string, 0, &match_info);
-  while (g_match_info_matches (match_info)) {
-    GRegex *replace_regex;
-    gchar *tmp, *varname, *pvarname = g_match_info_fetch (match_info, 0);
 
-    varname_len = strlen (pvarname);
-    varname = g_malloc (sizeof (gchar) * varname_len - 3);
-    strncpy (varname, &pvarname[2], varname_len - 3);
-    varname[varname_len - 3] = '\0';
+  if (!strstr (in_string, "$("))
+    return g_strdup (in_string);
 
+  string = g_string_sized_new (strlen (in_string));
+  for (p = in_string; *p;) {
+    const gchar *var_value;
+    gchar *varname;
+
+    if (p[0] != '$' || p[1] != '(') {
+      g_string_append_c (string, *p++);
+      continue;
+    }
+
+    for (start = p + 2; g_ascii_isalnum (*start) || *start == '_'; start++);
+    if (*start != ')' || start == p + 2) {
+      g_string_append_c (string, *p++);
+      continue;
+    }
+
+    varname = g_strndup (p + 2, start - p - 2);
     if (gst_structure_has_field_typed (scenario->priv->vars, varname,
             G_TYPE_DOUBLE)) {
       var_value = varname;
@@ -531,26 +591,19 @@ _replace_variables_in_string (GstValidateScenario * scenario,
         g_error ("Trying to use undefined variable : %s (%s)", varname,
             gst_structure_to_string (scenario->priv->vars));
 
+        g_free (varname);
+        g_string_free (string, TRUE);
         return NULL;
       }
     }
 
-    tmp = g_strdup_printf ("\\$\\(%s\\)", varname);
-    replace_regex = g_regex_new (tmp, 0, 0, NULL);
-    tmpstring = string;
-    string = g_regex_replace (replace_regex, string, -1, 0, var_value, 0, NULL);
-
     GST_INFO_OBJECT (action, "Setting variable %s to %s", varname, var_value);
-    g_free (tmpstring);
-    g_regex_unref (replace_regex);
-    g_free (pvarname);
-
-    g_match_info_next (match_info, NULL);
+    g_string_append (string, var_value);
+    g_free (varname);
+    p = start + 1;
   }
-  g_match_info_free (match_info);
-  g_regex_unref (regex);
 
-  return string;
+  return g_string_free (string, FALSE);
 }
 
 static gboolean
@@ -564,6 +617,36 @@ _set_variable_func (const gchar * name, double *value, gpointer user_data)
   return TRUE;
 }
 
+static gdouble
+_evaluate_expression (GstValidateScenario * scenario, const gchar * expr,
+    gchar ** error)
+{
+  GstValidateExpression *compiled;
+
+  if (!scenario)
+    return gst_validate_utils_parse_expression (expr, _set_variable_func,
+        scenario, error);
+
+  g_mutex_lock (&scenario->priv->expressions_lock);
+  compiled = g_hash_table_lookup (scenario->priv->expressions, expr);
+  if (!compiled) {
+    compiled = gst_validate_utils_compile_expression (expr, error);
+    if (!compiled) {
+      g_mutex_unlock (&scenario->priv->expressions_lock);
+
+      return -1.0;
+    }
+    g_hash_table_insert (scenario->priv->expressions, g_strdup (expr),
+        compiled);
+  }
+  g_mutex_unlock (&scenario->priv->expressions_lock);
+
+  /* Compiled expressions are never removed before finalize and evaluating
+   * them does not modify them */
+  return gst_validate_expression_evaluate (compiled, _set_variable_func,
+      scenario, error);
+}
+
 /* Check that @list doesn't contain any non-optional actions */
 static gboolean
 actions_list_is_done (GList * list)
@@ -633,9 +716,7 @@ gst_validate_action_get_clocktime (GstValidateScenario * scenario,
     if (!strval)
       return FALSE;
 
-    val =
-        gst_validate_utils_parse_expression (strval, _set_variable_func,
-        scenario, &error);
+    val = _evaluate_expression (scenario, strval, &error);
     if (error) {
       GST_WARNING ("Error while parsing %s: %s (%" GST_PTR_FORMAT ")",
           strval, error, scenario->priv->vars);
@@ -922,10 +1003,8 @@ _execute_stop (GstValidateScenario * scenario, GstValidateAction * action)
 
   bus = gst_element_get_bus (pipeline);
   SCENARIO_LOCK (scenario);
-  if (priv->execute_actions_source_id) {
-    g_source_remove (priv->execute_actions_source_id);
-    priv->execute_actions_source_id = 0;
-  }
+  _remove_execute_actions_source (scenario);
+  _unschedule_clock_id (scenario);
   SCENARIO_UNLOCK (scenario);
 
   gst_validate_scenario_check_dropped (scenario);
@@ -1532,21 +1611,58 @@ _execute_set_rank (GstValidateScenario * scenario, GstValidateAction * action)
   return GST_VALIDATE_EXECUTE_ACTION_OK;
 }
 
+/* Must be called with SCENARIO_LOCK taken */
+static void
+_unschedule_clock_id (GstValidateScenario * scenario)
+{
+  GstValidateScenarioPrivate *priv = scenario->priv;
+
+  if (priv->clock_id) {
+    gst_clock_id_unschedule (priv->clock_id);
+    gst_clock_id_unref (priv->clock_id);
+    priv->clock_id = NULL;
+  }
+}
+
+/* Must be called with SCENARIO_LOCK taken */
+static void
+_remove_execute_actions_source (GstValidateScenario * scenario)
+{
+  GstValidateScenarioPrivate *priv = scenario->priv;
+  GSource *source;
+
+  if (!priv->execute_actions_source_id)
+    return;
+
+  source = g_main_context_find_source_by_id (priv->context,
+      priv->execute_actions_source_id);
+  if (source)
+    g_source_destroy (source);
+  priv->execute_actions_source_id = 0;
+}
+
 static inline gboolean
 _add_execute_actions_gsource (GstValidateScenario * scenario)
 {
+  GSource *source;
   GstValidateScenarioPrivate *priv = scenario->priv;
 
   SCENARIO_LOCK (scenario);
+  /* Something happened (seek, state change, action done...), check the
+   * position right away instead of waiting for the clock */
+  _unschedule_clock_id (scenario);
   if (priv->execute_actions_source_id == 0 && priv->wait_id == 0
       && priv->signal_handler_id == 0 && priv->message_type == NULL) {
+    /* Dispatched from the context the scenario was created in, like the
+     * actions executed from other threads */
     if (!scenario->priv->action_execution_interval)
-      priv->execute_actions_source_id =
-          g_idle_add ((GSourceFunc) execute_next_action, scenario);
+      source = g_idle_source_new ();
     else
-      priv->execute_actions_source_id =
-          g_timeout_add (scenario->priv->action_execution_interval,
-          (GSourceFunc) execute_next_action, scenario);
+      source = g_timeout_source_new (scenario->priv->action_execution_interval);
+    g_source_set_callback (source, (GSourceFunc) execute_next_action,
+        scenario, NULL);
+    priv->execute_actions_source_id = g_source_attach (source, priv->context);
+    g_source_unref (source);
     SCENARIO_UNLOCK (scenario);
 
     GST_DEBUG_OBJECT (scenario, "Start checking position again");
@@ -1582,6 +1698,21 @@ _get_position (GstValidateScenario * scenario,
       (gint64 *) & duration)
       && GST_CLOCK_TIME_IS_VALID (duration);
 
+  /* Unsynchronised sinks report the position from the clock, use the
+   * position of the data they actually got instead */
+  if (priv->fast_forward) {
+    GstClockTime ff_position;
+
+    g_mutex_lock (&priv->fast_forward->lock);
+    ff_position = priv->fast_forward->position;
+    g_mutex_unlock (&priv->fast_forward->lock);
+
+    if (GST_CLOCK_TIME_IS_VALID (ff_position)) {
+      *position = ff_position;
+      has_pos = TRUE;
+    }
+  }
+
   if (!has_pos && GST_STATE (pipeline) >= GST_STATE_PAUSED &&
       act && GST_CLOCK_TIME_IS_VALID (act->playback_time)) {
     GST_INFO_OBJECT (scenario, "Unknown position: %" GST_TIME_FORMAT,
@@ -1753,6 +1884,324 @@ no:
   return FALSE;
 }
 
+static gboolean
+_clock_id_reached_main_thread (GstValidateScenario * scenario)
+{
+  GST_LOG_OBJECT (scenario, "Clock wait over, checking position");
+  _add_execute_actions_gsource (scenario);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called from the clock thread */
+static gboolean
+_clock_id_reached_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    GstValidateScenario * scenario)
+{
+  g_main_context_invoke_full (scenario->priv->context, G_PRIORITY_DEFAULT,
+      (GSourceFunc) _clock_id_reached_main_thread,
+      gst_object_ref (scenario), gst_object_unref);
+
+  return TRUE;
+}
+
+static FastForward *
+fast_forward_new (GstValidateScenario * scenario)
+{
+  FastForward *ff = g_new0 (FastForward, 1);
+
+  ff->refcount = 1;
+  g_mutex_init (&ff->lock);
+  g_cond_init (&ff->cond);
+  g_weak_ref_init (&ff->scenario, scenario);
+  ff->target = GST_CLOCK_TIME_NONE;
+  ff->position = GST_CLOCK_TIME_NONE;
+
+  return ff;
+}
+
+static FastForward *
+fast_forward_ref (FastForward * ff)
+{
+  g_atomic_int_inc (&ff->refcount);
+
+  return ff;
+}
+
+static void
+fast_forward_unref (FastForward * ff)
+{
+  if (!g_atomic_int_dec_and_test (&ff->refcount))
+    return;
+
+  g_weak_ref_clear (&ff->scenario);
+  g_cond_clear (&ff->cond);
+  g_mutex_clear (&ff->lock);
+  g_free (ff);
+}
+
+static void
+fast_forward_stop (FastForward * ff)
+{
+  g_mutex_lock (&ff->lock);
+  ff->stopped = TRUE;
+  g_cond_broadcast (&ff->cond);
+  g_mutex_unlock (&ff->lock);
+
+  fast_forward_unref (ff);
+}
+
+/* Publishes the earliest playback time at which an action that was not
+ * executed yet is due to the sinks, releasing them if they were waiting for
+ * an earlier one. Actions run in order, so an action is never due before the
+ * ones preceding it, which makes it the playback time of the first pending
+ * action having one. Actions without a playback time, or whose playback time
+ * is not known yet, do not hold the data back. */
+static void
+_fast_forward_update_target (GstValidateScenario * scenario)
+{
+  GList *tmp;
+  GstClockTime target = GST_CLOCK_TIME_NONE;
+  FastForward *ff = scenario->priv->fast_forward;
+
+  if (!ff)
+    return;
+
+  for (tmp = scenario->priv->actions; tmp; tmp = tmp->next) {
+    GstValidateAction *act = tmp->data;
+
+    if (act->priv->executed || act->priv->needs_playback_parsing
+        || !GST_CLOCK_TIME_IS_VALID (act->playback_time))
+      continue;
+
+    target = act->playback_time;
+    break;
+  }
+
+  g_mutex_lock (&ff->lock);
+  if (ff->target != target) {
+    GST_LOG_OBJECT (scenario, "Next action due at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (target));
+    ff->target = target;
+    g_cond_broadcast (&ff->cond);
+  }
+  g_mutex_unlock (&ff->lock);
+}
+
+/* Data can only be held back once the sink prerolled and goes to, or is in,
+ * PLAYING, it has to preroll or flush otherwise. Holding it while PAUSED to
+ * PLAYING is pending too keeps it from running past the target before the
+ * state change is committed */
+static gboolean
+_fast_forward_can_hold (GstPad * pad)
+{
+  gboolean res;
+  GstElement *sink;
+
+  GST_OBJECT_LOCK (pad);
+  res = !GST_PAD_IS_FLUSHING (pad);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (!res || !(sink = gst_pad_get_parent_element (pad)))
+    return FALSE;
+
+  GST_OBJECT_LOCK (sink);
+  res = (GST_STATE (sink) == GST_STATE_PLAYING
+      && GST_STATE_PENDING (sink) == GST_STATE_VOID_PENDING)
+      || (GST_STATE (sink) == GST_STATE_PAUSED
+      && GST_STATE_PENDING (sink) == GST_STATE_PLAYING);
+  GST_OBJECT_UNLOCK (sink);
+  gst_object_unref (sink);
+
+  return res;
+}
+
+static gboolean
+_fast_forward_reached (GstClockTime stream_time, gdouble rate,
+    GstClockTime target)
+{
+  if (!GST_CLOCK_TIME_IS_VALID (target))
+    return FALSE;
+
+  return rate > 0 ? stream_time >= target : stream_time <= target;
+}
+
+/* Called from the streaming threads */
+static GstPadProbeReturn
+_fast_forward_probe (GstPad * pad, GstPadProbeInfo * info, FastForward * ff)
+{
+  GstBuffer *buffer = NULL;
+  GstEvent *event;
+  const GstSegment *segment;
+  GstClockTime stream_time;
+  gdouble rate;
+  gboolean notified = FALSE;
+
+  if (info->type & (GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+          GST_PAD_PROBE_TYPE_EVENT_FLUSH)) {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    g_mutex_lock (&ff->lock);
+    if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START)
+      g_cond_broadcast (&ff->cond);
+    else if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP
+        || GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT)
+      ff->position = GST_CLOCK_TIME_NONE;
+    g_mutex_unlock (&ff->lock);
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER)
+    buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  else if (gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info)))
+    buffer = gst_buffer_list_get (GST_PAD_PROBE_INFO_BUFFER_LIST (info), 0);
+
+  if (!buffer || !GST_BUFFER_PTS_IS_VALID (buffer))
+    return GST_PAD_PROBE_OK;
+
+  event = gst_pad_get_sticky_event (pad, GST_EVENT_SEGMENT, 0);
+  if (!event)
+    return GST_PAD_PROBE_OK;
+
+  gst_event_parse_segment (event, &segment);
+  if (segment->format != GST_FORMAT_TIME) {
+    gst_event_unref (event);
+    return GST_PAD_PROBE_OK;
+  }
+
+  rate = segment->rate;
+  stream_time = gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+      GST_BUFFER_PTS (buffer));
+  gst_event_unref (event);
+
+  if (!GST_CLOCK_TIME_IS_VALID (stream_time))
+    return GST_PAD_PROBE_OK;
+
+  g_mutex_lock (&ff->lock);
+  if (!GST_CLOCK_TIME_IS_VALID (ff->position)
+      || (rate > 0 ? stream_time > ff->position : stream_time < ff->position))
+    ff->position = stream_time;
+
+  while (!ff->stopped && _fast_forward_reached (stream_time, rate, ff->target)
+      && _fast_forward_can_hold (pad)) {
+    if (!notified) {
+      GstValidateScenario *scenario = g_weak_ref_get (&ff->scenario);
+
+      GST_LOG_OBJECT (pad, "Holding data at %" GST_TIME_FORMAT " until the"
+          " action due at %" GST_TIME_FORMAT " is executed",
+          GST_TIME_ARGS (stream_time), GST_TIME_ARGS (ff->target));
+
+      /* Let the scenario check the position right away */
+      if (scenario)
+        g_main_context_invoke_full (scenario->priv->context,
+            G_PRIORITY_DEFAULT, (GSourceFunc) _clock_id_reached_main_thread,
+            scenario, gst_object_unref);
+      notified = TRUE;
+    }
+
+    g_cond_wait_until (&ff->cond, &ff->lock,
+        g_get_monotonic_time () + FAST_FORWARD_POLL_INTERVAL);
+  }
+  g_mutex_unlock (&ff->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+_fast_forward_add_probe (GstElement * sink, GstPad * pad, FastForward * ff)
+{
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+      GST_PAD_PROBE_TYPE_EVENT_FLUSH, (GstPadProbeCallback) _fast_forward_probe,
+      fast_forward_ref (ff), (GDestroyNotify) fast_forward_unref);
+
+  return TRUE;
+}
+
+/* In fast-forward mode, sinks do not wait on the clock and render data as
+ * soon as they get it, but hold it back once it reaches the playback time of
+ * the next action, until that action has been executed. */
+static void
+_setup_fast_forward_sink (GstValidateScenario * scenario, GstElement * element)
+{
+  if (GST_IS_BIN (element)
+      || !GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SINK))
+    return;
+
+  GST_DEBUG_OBJECT (scenario, "Fast-forwarding %" GST_PTR_FORMAT, element);
+
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (element), "sync"))
+    g_object_set (element, "sync", FALSE, NULL);
+
+  gst_element_foreach_sink_pad (element,
+      (GstElementForeachPadFunc) _fast_forward_add_probe,
+      scenario->priv->fast_forward);
+}
+
+/* Stops checking the position periodically and waits on the pipeline clock
+ * until @act is due. Returns FALSE if the position should be checked
+ * periodically instead. */
+static gboolean
+_schedule_action_on_clock (GstValidateScenario * scenario,
+    GstValidateAction * act, GstClockTime position, gdouble rate)
+{
+  GstClock *clock;
+  GstState state, pending;
+  GstClockTime remaining, now;
+  GstValidateScenarioPrivate *priv = scenario->priv;
+  GstElement *pipeline;
+
+  if (!priv->clock_scheduling || priv->fast_forward || !act
+      || !GST_CLOCK_TIME_IS_VALID (position)
+      || !GST_CLOCK_TIME_IS_VALID (act->playback_time) || rate == 0.0)
+    return FALSE;
+
+  pipeline = gst_validate_scenario_get_pipeline (scenario);
+  if (!pipeline)
+    return FALSE;
+
+  GST_OBJECT_LOCK (pipeline);
+  state = GST_STATE (pipeline);
+  pending = GST_STATE_PENDING (pipeline);
+  GST_OBJECT_UNLOCK (pipeline);
+
+  clock = gst_element_get_clock (pipeline);
+  gst_object_unref (pipeline);
+
+  if (state < GST_STATE_PAUSED || pending != GST_STATE_VOID_PENDING) {
+    if (clock)
+      gst_object_unref (clock);
+    return FALSE;
+  }
+
+  SCENARIO_LOCK (scenario);
+  _remove_execute_actions_source (scenario);
+  _unschedule_clock_id (scenario);
+
+  /* In PAUSED the position does not move, the next state change will get
+   * us going again */
+  if (state == GST_STATE_PLAYING && clock) {
+    remaining = rate > 0 ? act->playback_time - position :
+        position - act->playback_time;
+    remaining = MIN ((GstClockTime) (remaining / ABS (rate)), MAX_CLOCK_WAIT);
+    now = gst_clock_get_time (clock);
+
+    GST_DEBUG_OBJECT (scenario, "Waiting %" GST_TIME_FORMAT " on the clock "
+        "for action %s", GST_TIME_ARGS (remaining), act->type);
+    priv->clock_id = gst_clock_new_single_shot_id (clock, now + remaining);
+    gst_clock_id_wait_async (priv->clock_id,
+        (GstClockCallback) _clock_id_reached_cb, gst_object_ref (scenario),
+        gst_object_unref);
+  }
+  SCENARIO_UNLOCK (scenario);
+
+  if (clock)
+    gst_object_unref (clock);
+
+  return TRUE;
+}
+
 static gboolean
 _set_action_playback_time (GstValidateScenario * scenario,
     GstValidateAction * action)
@@ -1780,11 +2229,11 @@ gst_validate_parse_next_action_playback_time (GstValidateScenario * self)
   GstValidateScenarioPrivate *priv = self->priv;
 
   if (!priv->actions)
-    return TRUE;
+    goto done;
 
   action = (GstValidateAction *) priv->actions->data;
   if (!action->priv->needs_playback_parsing)
-    return TRUE;
+    goto done;
 
   if (!_set_action_playback_time (self, action)) {
     GST_ERROR_OBJECT (self, "Could not set playback_time!");
@@ -1793,6 +2242,9 @@ gst_validate_parse_next_action_playback_time (GstValidateScenario * self)
   }
   action->priv->needs_playback_parsing = FALSE;
 
+done:
+  _fast_forward_update_target (self);
+
   return TRUE;
 }
 
@@ -1821,6 +2273,7 @@ gst_validate_execute_action (GstValidateActionType * action_type,
   gst_validate_print_action (action, NULL);
 
   action->priv->execution_time = gst_util_get_timestamp ();
+  action->priv->executed = TRUE;
   action->priv->state = GST_VALIDATE_EXECUTE_ACTION_IN_PROGRESS;
   res = action_type->execute (scenario, action);
   gst_object_unref (scenario);
@@ -2020,6 +2473,33 @@ done:
 }
 
 
+/* Maximum number of actions executed from a single dispatch in batch mode,
+ * so that bus messages still get a chance to be handled */
+#define MAX_ACTIONS_BATCH_SIZE 256
+
+/* Whether @act can be executed right after the previous action completed,
+ * from the same dispatch, without checking the position again */
+static gboolean
+_can_batch_action (GstValidateScenario * scenario, GstValidateAction * act)
+{
+  GstValidateScenarioPrivate *priv = scenario->priv;
+  gboolean res;
+
+  if (!act || GST_CLOCK_TIME_IS_VALID (act->playback_time)
+      || act->priv->needs_playback_parsing)
+    return FALSE;
+
+  if (priv->buffering || priv->changing_state || priv->needs_async_done)
+    return FALSE;
+
+  SCENARIO_LOCK (scenario);
+  res = priv->wait_id == 0 && priv->signal_handler_id == 0
+      && priv->message_type == NULL;
+  SCENARIO_UNLOCK (scenario);
+
+  return res;
+}
+
 /* This is the main action execution function
  * it checks whether it is time to run the next action
  * and if it is the case executes it.
@@ -2036,6 +2516,7 @@ execute_next_action (GstValidateScenario * scenario)
   GstClockTime position = -1;
   GstValidateAction *act = NULL;
   GstValidateActionType *type;
+  guint batch_size = 0;
 
   GstValidateScenarioPrivate *priv = scenario->priv;
 
@@ -2104,15 +2585,20 @@ execute_next_action (GstValidateScenario * scenario)
     }
   }
 
+  _fast_forward_update_target (scenario);
   if (!_check_position (scenario, act, &position, &rate))
     return G_SOURCE_CONTINUE;
 
   if (!_should_execute_action (scenario, act, position, rate)) {
+    if (_schedule_action_on_clock (scenario, act, position, rate))
+      return G_SOURCE_REMOVE;
+
     _add_execute_actions_gsource (scenario);
 
     return G_SOURCE_CONTINUE;
   }
 
+execute:
   type = _find_action_type (act->type);
 
   GST_DEBUG_OBJECT (scenario, "Executing %" GST_PTR_FORMAT
@@ -2160,6 +2646,28 @@ execute_next_action (GstValidateScenario * scenario)
 
     g_list_free (tmp);
 
+    /* In batch mode, run the following untimed actions right away instead of
+     * going back to the main loop between each of them, the position
+     * checked before the first one is still valid for them */
+    if (priv->batch_actions && priv->actions
+        && _can_batch_action (scenario, priv->actions->data)) {
+      if (++batch_size == MAX_ACTIONS_BATCH_SIZE) {
+        GST_DEBUG_OBJECT (scenario, "Executed %u actions in a row, letting"
+            " the main loop run", batch_size);
+        _add_execute_actions_gsource (scenario);
+
+        return G_SOURCE_CONTINUE;
+      }
+
+      act = priv->actions->data;
+      if (_should_execute_action (scenario, act, position, rate)) {
+        GST_LOG_OBJECT (scenario, "Batching execution of %" GST_PTR_FORMAT,
+            act->structure);
+
+        goto execute;
+      }
+    }
+
     /* Recurse to the next action if it is possible
      * to execute right away */
     if (!scenario->priv->execute_on_idle) {
@@ -2263,10 +2771,8 @@ _execute_timed_wait (GstValidateScenario * scenario, GstValidateAction * action)
   duration *= wait_multiplier;
 
   SCENARIO_LOCK (scenario);
-  if (priv->execute_actions_source_id) {
-    g_source_remove (priv->execute_actions_source_id);
-    priv->execute_actions_source_id = 0;
-  }
+  _remove_execute_actions_source (scenario);
+  _unschedule_clock_id (scenario);
   SCENARIO_UNLOCK (scenario);
 
   SCENARIO_LOCK (scenario);
@@ -2301,10 +2807,10 @@ _execute_wait_for_signal (GstValidateScenario * scenario,
 
   gst_validate_printf (action, "Waiting for '%s' signal\n", signal_name);
 
-  if (priv->execute_actions_source_id) {
-    g_source_remove (priv->execute_actions_source_id);
-    priv->execute_actions_source_id = 0;
-  }
+  SCENARIO_LOCK (scenario);
+  _remove_execute_actions_source (scenario);
+  _unschedule_clock_id (scenario);
+  SCENARIO_UNLOCK (scenario);
 
   priv->signal_handler_id =
       g_signal_connect (target, signal_name, (GCallback) stop_waiting_signal,
@@ -2327,10 +2833,10 @@ _execute_wait_for_message (GstValidateScenario * scenario,
 
   gst_validate_printf (action, "Waiting for '%s' message\n", message_type);
 
-  if (priv->execute_actions_source_id) {
-    g_source_remove (priv->execute_actions_source_id);
-    priv->execute_actions_source_id = 0;
-  }
+  SCENARIO_LOCK (scenario);
+  _remove_execute_actions_source (scenario);
+  _unschedule_clock_id (scenario);
+  SCENARIO_UNLOCK (scenario);
 
   priv->message_type = g_strdup (message_type);
   gst_object_unref (pipeline);
@@ -2974,9 +3480,7 @@ gst_validate_action_default_prepare_func (GstValidateAction * action)
     return FALSE;
   }
 
-  action->repeat =
-      gst_validate_utils_parse_expression (repeat_expr, _set_variable_func,
-      scenario, &error);
+  action->repeat = _evaluate_expression (scenario, repeat_expr, &error);
   if (error) {
     g_error ("Invalid value for 'repeat' in %s: %s",
         gst_structure_to_string (action->structure), error);
@@ -3118,6 +3622,9 @@ message_cb (GstBus * bus, GstMessage * message, GstValidateScenario * scenario)
 
         if (pstate == GST_STATE_READY && nstate == GST_STATE_PAUSED)
           _add_execute_actions_gsource (scenario);
+        else if (priv->clock_scheduling)
+          /* The position will now move differently, reschedule */
+          _add_execute_actions_gsource (scenario);
 
         /* GstBin only send a new latency message when reaching PLAYING if
          * async-handling=true so check the latency manually. */
@@ -3377,6 +3884,8 @@ _load_scenario_file (GstValidateScenario * scenario,
       gst_structure_get_boolean (structure, "is-config", is_config);
       gst_structure_get_boolean (structure, "handles-states",
           &priv->handles_state);
+      gst_structure_get_boolean (structure, "batch-actions",
+          &priv->batch_actions);
 
       if (!priv->handles_state)
         priv->target_state = GST_STATE_PLAYING;
@@ -3697,12 +4206,17 @@ gst_validate_scenario_init (GstValidateScenario * scenario)
   priv->segment_stop = GST_CLOCK_TIME_NONE;
   priv->action_execution_interval = 10;
   priv->vars = gst_structure_new_empty ("vars");
+  priv->expressions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) gst_validate_expression_free);
   priv->needs_playback_parsing = TRUE;
   g_weak_ref_init (&scenario->priv->ref_pipeline, NULL);
   priv->max_latency = GST_CLOCK_TIME_NONE;
   priv->max_dropped = -1;
 
+  priv->context = g_main_context_ref_thread_default ();
+
   g_mutex_init (&priv->lock);
+  g_mutex_init (&priv->expressions_lock);
 }
 
 static void
@@ -3714,6 +4228,15 @@ gst_validate_scenario_dispose (GObject * object)
     gst_event_unref (priv->last_seek);
   g_weak_ref_clear (&priv->ref_pipeline);
 
+  SCENARIO_LOCK (GST_VALIDATE_SCENARIO (object));
+  _unschedule_clock_id (GST_VALIDATE_SCENARIO (object));
+  SCENARIO_UNLOCK (GST_VALIDATE_SCENARIO (object));
+
+  if (priv->fast_forward) {
+    fast_forward_stop (priv->fast_forward);
+    priv->fast_forward = NULL;
+  }
+
   if (priv->bus) {
     gst_bus_remove_signal_watch (priv->bus);
     gst_object_unref (priv->bus);
@@ -3740,6 +4263,9 @@ gst_validate_scenario_finalize (GObject * object)
       (GDestroyNotify) gst_mini_object_unref);
   g_free (priv->pipeline_name);
   gst_structure_free (priv->vars);
+  g_hash_table_unref (priv->expressions);
+  g_main_context_unref (priv->context);
+  g_mutex_clear (&priv->expressions_lock);
   g_mutex_clear (&priv->lock);
 
   G_OBJECT_CLASS (gst_validate_scenario_parent_class)->finalize (object);
@@ -3830,6 +4356,9 @@ _element_added_cb (GstBin * bin, GstElement * element,
 
   _check_scenario_is_done (scenario);
 
+  if (priv->fast_forward)
+    _setup_fast_forward_sink (scenario, element);
+
   /* If it's a bin, listen to the child */
   if (GST_IS_BIN (element)) {
     g_signal_connect (element, "element-added", (GCallback) _element_added_cb,
@@ -3838,6 +4367,26 @@ _element_added_cb (GstBin * bin, GstElement * element,
   }
 }
 
+static gboolean
+_fast_forward_enabled (void)
+{
+  GList *config;
+  gboolean enabled = FALSE;
+  const gchar *env = g_getenv ("GST_VALIDATE_SCENARIO_FAST_FORWARD");
+
+  if (env)
+    return g_strcmp0 (env, "0") != 0;
+
+  for (config = gst_validate_plugin_get_config (NULL); config;
+      config = config->next) {
+    if (gst_structure_get_boolean (config->data, "scenario-fast-forward",
+            &enabled))
+      break;
+  }
+
+  return enabled;
+}
+
 /**
  * gst_validate_scenario_factory_create:
  * @runner: The #GstValidateRunner to use to report issues
@@ -3878,6 +4427,12 @@ gst_validate_scenario_factory_create (GstValidateRunner *
   gst_validate_reporter_set_name (GST_VALIDATE_REPORTER (scenario),
       g_strdup (scenario_name));
 
+  if (_fast_forward_enabled ()) {
+    GST_INFO_OBJECT (scenario, "Fast-forwarding the pipeline");
+    scenario->priv->fast_forward = fast_forward_new (scenario);
+    _fast_forward_update_target (scenario);
+  }
+
   g_signal_connect (pipeline, "element-added", (GCallback) _element_added_cb,
       scenario);
 
@@ -3892,6 +4447,11 @@ gst_validate_scenario_factory_create (GstValidateRunner *
       config = config->next) {
     gint interval;
 
+    if (gst_structure_get_boolean (config->data, "scenario-clock-scheduling",
+            &scenario->priv->clock_scheduling))
+      GST_DEBUG_OBJECT (scenario, "Clock scheduling: %d",
+          scenario->priv->clock_scheduling);
+
     if (gst_structure_get_uint (config->data,
             "scenario-action-execution-interval",
             &scenario->priv->action_execution_interval)) {
@@ -3945,29 +4505,137 @@ _add_description (GQuark field_id, const GValue * value, KeyFileGroupName * kfg)
 }
 
 
+/* What gst_validate_list_scenarios() needs from each scenario is cached on
+ * disk, keyed by path and checked against the modification time and size of
+ * the file, so that listing does not have to parse all the scenarios */
+typedef struct
+{
+  GKeyFile *kf;
+  gchar *path;
+  gboolean dirty;
+} ScenariosCache;
+
+static void
+_scenarios_cache_init (ScenariosCache * cache)
+{
+  cache->kf = g_key_file_new ();
+  cache->path = g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-" GST_API_VERSION, "validate", "scenarios.cache", NULL);
+  cache->dirty = FALSE;
+
+  g_key_file_load_from_file (cache->kf, cache->path, G_KEY_FILE_NONE, NULL);
+}
+
+static void
+_scenarios_cache_clear (ScenariosCache * cache)
+{
+  if (cache->dirty) {
+    gsize length;
+    gchar *dir = g_path_get_dirname (cache->path);
+    gchar *data = g_key_file_to_data (cache->kf, &length, NULL);
+
+    if (g_mkdir_with_parents (dir, 0755) != 0 ||
+        !g_file_set_contents (cache->path, data, length, NULL))
+      GST_INFO ("Could not save the scenarios cache to %s", cache->path);
+
+    g_free (data);
+    g_free (dir);
+  }
+
+  g_key_file_free (cache->kf);
+  g_free (cache->path);
+}
+
+/* Gets the description of the scenario in @f, and the names of all its
+ * other structures */
+static void
+_get_scenario_description (ScenariosCache * cache, GFile * f,
+    GstStructure ** desc, gchar *** action_types)
+{
+  GStatBuf st;
+  GList *tmp, *structures;
+  GPtrArray *types;
+  gchar *desc_str, *path = g_file_get_path (f);
+  gboolean cacheable = path && !strpbrk (path, "[]") &&
+      g_stat (path, &st) == 0;
+
+  *desc = NULL;
+  *action_types = NULL;
+
+  if (cacheable && g_key_file_has_group (cache->kf, path) &&
+      g_key_file_get_int64 (cache->kf, path, "mtime-ns", NULL) ==
+      gst_validate_utils_get_mtime (&st) &&
+      g_key_file_get_int64 (cache->kf, path, "size", NULL) == st.st_size) {
+    desc_str = g_key_file_get_string (cache->kf, path, "description", NULL);
+    if (desc_str)
+      *desc = gst_structure_from_string (desc_str, NULL);
+
+    if (!desc_str || *desc) {
+      *action_types = g_key_file_get_string_list (cache->kf, path,
+          "action-types", NULL, NULL);
+      g_free (desc_str);
+      goto done;
+    }
+
+    g_free (desc_str);
+  }
+
+  types = g_ptr_array_new ();
+  structures = gst_validate_structs_parse_from_gfile (f);
+  for (tmp = structures; tmp; tmp = tmp->next) {
+    GstStructure *_struct = (GstStructure *) tmp->data;
+
+    if (!*desc && gst_structure_has_name (_struct, "description"))
+      *desc = gst_structure_copy (_struct);
+    else
+      g_ptr_array_add (types, g_strdup (gst_structure_get_name (_struct)));
+  }
+  g_ptr_array_add (types, NULL);
+  *action_types = (gchar **) g_ptr_array_free (types, FALSE);
+  g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+
+  if (cacheable) {
+    g_key_file_remove_group (cache->kf, path, NULL);
+    g_key_file_set_int64 (cache->kf, path, "mtime-ns",
+        gst_validate_utils_get_mtime (&st));
+    g_key_file_set_int64 (cache->kf, path, "size", st.st_size);
+    if (*desc) {
+      desc_str = gst_structure_to_string (*desc);
+      g_key_file_set_string (cache->kf, path, "description", desc_str);
+      g_free (desc_str);
+    }
+    g_key_file_set_string_list (cache->kf, path, "action-types",
+        (const gchar * const *) *action_types,
+        g_strv_length (*action_types));
+    cache->dirty = TRUE;
+  }
+
+done:
+  g_free (path);
+}
+
 static gboolean
-_parse_scenario (GFile * f, GKeyFile * kf)
+_parse_scenario (GFile * f, GKeyFile * kf, ScenariosCache * cache)
 {
   gboolean ret = FALSE;
   gchar *fname = g_file_get_basename (f);
 
   if (g_str_has_suffix (fname, GST_VALIDATE_SCENARIO_SUFFIX)) {
     gboolean needs_clock_sync = FALSE;
-    GstStructure *desc = NULL;
+    GstStructure *desc;
+    gchar **action_types;
+    guint i;
 
     gchar **name = g_strsplit (fname, GST_VALIDATE_SCENARIO_SUFFIX, 0);
-    GList *tmp, *structures = gst_validate_structs_parse_from_gfile (f);
 
-    for (tmp = structures; tmp; tmp = tmp->next) {
-      GstStructure *_struct = (GstStructure *) tmp->data;
-      GstValidateActionType *type =
-          _find_action_type (gst_structure_get_name (_struct));
+    _get_scenario_description (cache, f, &desc, &action_types);
+    for (i = 0; action_types && action_types[i]; i++) {
+      GstValidateActionType *type = _find_action_type (action_types[i]);
 
-      if (!desc && gst_structure_has_name (_struct, "description"))
-        desc = gst_structure_copy (_struct);
-      else if (type && type->flags & GST_VALIDATE_ACTION_TYPE_NEEDS_CLOCK)
+      if (type && type->flags & GST_VALIDATE_ACTION_TYPE_NEEDS_CLOCK)
         needs_clock_sync = TRUE;
     }
+    g_strfreev (action_types);
 
     if (needs_clock_sync) {
       if (desc)
@@ -3989,7 +4657,6 @@ _parse_scenario (GFile * f, GKeyFile * kf)
     } else {
       g_key_file_set_string (kf, name[0], "noinfo", "nothing");
     }
-    g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
     g_strfreev (name);
 
     ret = TRUE;
@@ -4000,7 +4667,7 @@ _parse_scenario (GFile * f, GKeyFile * kf)
 }
 
 static void
-_list_scenarios_in_dir (GFile * dir, GKeyFile * kf)
+_list_scenarios_in_dir (GFile * dir, GKeyFile * kf, ScenariosCache * cache)
 {
   GFileEnumerator *fenum;
   GFileInfo *info;
@@ -4015,7 +4682,7 @@ _list_scenarios_in_dir (GFile * dir, GKeyFile * kf)
       info; info = g_file_enumerator_next_file (fenum, NULL, NULL)) {
     GFile *f = g_file_enumerator_get_child (fenum, info);
 
-    _parse_scenario (f, kf);
+    _parse_scenario (f, kf, cache);
     gst_object_unref (f);
   }
 
@@ -4031,6 +4698,7 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
 
   GError *err = NULL;
   GKeyFile *kf = NULL;
+  ScenariosCache cache;
   gint res = 0;
   const gchar *envvar;
   gchar **env_scenariodir = NULL;
@@ -4040,13 +4708,14 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
   GFile *dir = g_file_new_for_path (tldir);
 
   kf = g_key_file_new ();
+  _scenarios_cache_init (&cache);
   if (num_scenarios > 0) {
     gint i;
     GFile *file;
 
     for (i = 0; i < num_scenarios; i++) {
       file = g_file_new_for_path (scenarios[i]);
-      if (!_parse_scenario (file, kf)) {
+      if (!_parse_scenario (file, kf, &cache)) {
         GST_ERROR ("Could not parse scenario: %s", scenarios[i]);
 
         gst_object_unref (file);
@@ -4061,14 +4730,14 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
   if (envvar)
     env_scenariodir = g_strsplit (envvar, ":", 0);
 
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
   g_free (tldir);
 
   tldir = g_build_filename (GST_DATADIR, "gstreamer-" GST_API_VERSION,
       "validate", GST_VALIDATE_SCENARIO_DIRECTORY, NULL);
   dir = g_file_new_for_path (tldir);
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
   g_free (tldir);
 
@@ -4077,14 +4746,14 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
 
     for (i = 0; env_scenariodir[i]; i++) {
       dir = g_file_new_for_path (env_scenariodir[i]);
-      _list_scenarios_in_dir (dir, kf);
+      _list_scenarios_in_dir (dir, kf, &cache);
       g_object_unref (dir);
     }
   }
 
   /* Hack to make it work uninstalled */
   dir = g_file_new_for_path ("data/scenarios");
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
 
 done:
@@ -4107,6 +4776,7 @@ done:
   }
 
   g_key_file_free (kf);
+  _scenarios_cache_clear (&cache);
 
   return res;
 }
@@ -4117,12 +4787,23 @@ _check_last_sample_checksum (GstValidateScenario * scenario,
 {
   GstSample *sample;
   gchar *sum;
-  GstMapInfo map;
   GstBuffer *buffer;
-  const gchar *target_sum;
+  const gchar *target_sum, *checksum_type_name;
+  GstValidateChecksumType checksum_type = GST_VALIDATE_CHECKSUM_TYPE_SHA1;
   GstValidateExecuteActionReturn res = GST_VALIDATE_EXECUTE_ACTION_OK;
 
   target_sum = gst_structure_get_string (action->structure, "checksum");
+  checksum_type_name =
+      gst_structure_get_string (action->structure, "checksum-type");
+  if (checksum_type_name &&
+      !gst_validate_checksum_type_from_name (checksum_type_name,
+          &checksum_type)) {
+    GST_VALIDATE_REPORT (scenario, SCENARIO_ACTION_EXECUTION_ERROR,
+        "Unknown checksum type '%s'", checksum_type_name);
+
+    return GST_VALIDATE_EXECUTE_ACTION_ERROR_REPORTED;
+  }
+
   g_object_get (sink, "last-sample", &sample, NULL);
   if (sample == NULL) {
     GST_VALIDATE_REPORT (scenario, SCENARIO_ACTION_EXECUTION_ERROR,
@@ -4135,15 +4816,14 @@ _check_last_sample_checksum (GstValidateScenario * scenario,
   }
 
   buffer = gst_sample_get_buffer (sample);
-  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+  sum = gst_validate_compute_checksum_for_buffer (checksum_type, buffer);
+  gst_sample_unref (sample);
+  if (!sum) {
     GST_VALIDATE_REPORT (scenario, SCENARIO_ACTION_EXECUTION_ERROR,
         "Last sample buffer could not be mapped, action can't run.");
     goto done;
   }
 
-  sum = g_compute_checksum_for_data (G_CHECKSUM_SHA1, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
-
   if (g_strcmp0 (sum, target_sum)) {
     GST_VALIDATE_REPORT (scenario, SCENARIO_ACTION_EXECUTION_ERROR,
         "Last buffer checksum '%s' is different than the expected one: '%s'",
@@ -4661,6 +5341,17 @@ init_scenarios (void)
         .possible_variables = NULL,
         .def = "false"
       },
+      {
+        .name = "batch-actions",
+        .description = "Whether consecutive actions without a playback time that complete\n"
+                       "synchronously should be executed one after the other without going\n"
+                       "back to the main loop in between, which speeds up scenarios with\n"
+                       "many quick actions such as property changes",
+        .mandatory = FALSE,
+        .types = "boolean",
+        .possible_variables = NULL,
+        .def = "false"
+      },
       {
         .name = "need-clock-sync",
         .description = "Whether the scenario needs the execution to be synchronized with the pipeline's\n"
@@ -5185,6 +5876,15 @@ init_scenarios (void)
           .types = "string",
           NULL
         },
+        {
+          .name = "checksum-type",
+          .description = "The algorithm used to compute the checksum, "
+            "can be 'md5', 'sha1', 'sha256' or 'xxh64'.",
+          .mandatory = FALSE,
+          .types = "string",
+          .possible_variables = NULL,
+          .def = "sha1"
+        },
         {NULL}
       }),
       "Checks the last-sample checksum on declared Sink element."
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #ifdef G_OS_UNIX
 #include <glib-unix.h>
@@ -39,13 +40,65 @@
 #endif
 
 #include "gst-validate-utils.h"
+#include "gst-validate-internal.h"
 #include <gst/gst.h>
 
 #define PARSER_BOOLEAN_EQUALITY_THRESHOLD (1e-10)
 #define PARSER_MAX_TOKEN_SIZE 256
 #define PARSER_MAX_ARGUMENT_COUNT 10
 
-static GRegex *_clean_structs_lines = NULL;
+/* Parsed structures of the files loaded so far, keyed by path, see
+ * gst_validate_utils_structs_parse_from_filename() */
+typedef struct
+{
+  gint64 mtime;
+  gint64 size;
+  guint64 ino;
+  GList *structures;
+} StructsCacheEntry;
+
+static GHashTable *_structs_cache = NULL;
+static GMutex _structs_cache_lock;
+
+/* Expressions are compiled to a small stack machine program, variables being
+ * looked up once per evaluation and referenced through their slot */
+typedef enum
+{
+  OP_PUSH,
+  OP_PUSH_VARIABLE,
+  OP_NEGATE,
+  OP_ADD,
+  OP_SUBTRACT,
+  OP_MULTIPLY,
+  OP_DIVIDE,
+  OP_POWER,
+  OP_LESS,
+  OP_GREATER,
+  OP_LESS_EQUAL,
+  OP_GREATER_EQUAL,
+  OP_EQUAL,
+  OP_NOT_EQUAL,
+  OP_AND,
+  OP_OR,
+  OP_MIN,
+  OP_MAX,
+} ExpressionOp;
+
+typedef struct
+{
+  ExpressionOp op;
+  gdouble value;
+  guint slot;
+} ExpressionInstruction;
+
+struct _GstValidateExpression
+{
+  ExpressionInstruction *code;
+  guint n_code;
+  gchar **variables;
+  guint n_variables;
+  guint stack_size;
+};
 
 typedef struct
 {
@@ -54,11 +107,14 @@ typedef struct
   gint pos;
   jmp_buf err_jmp_buf;
   const gchar *error;
-  void *user_data;
-  GstValidateParseVariableFunc variable_func;
+
+  GArray *code;
+  GPtrArray *variables;
+  guint depth;
+  guint max_depth;
 } MathParser;
 
-static gdouble _read_power (MathParser * parser);
+static void _read_power (MathParser * parser);
 
 static void
 _error (MathParser * parser, const gchar * err)
@@ -94,7 +150,42 @@ _next (MathParser * parser)
   return '\0';
 }
 
-static gdouble
+/* Operations pop two values and push one, the others push one value */
+static void
+_emit (MathParser * parser, ExpressionOp op, gdouble value, guint slot)
+{
+  ExpressionInstruction instruction;
+
+  instruction.op = op;
+  instruction.value = value;
+  instruction.slot = slot;
+  g_array_append_val (parser->code, instruction);
+
+  if (op == OP_PUSH || op == OP_PUSH_VARIABLE) {
+    parser->depth++;
+    parser->max_depth = MAX (parser->max_depth, parser->depth);
+  } else if (op != OP_NEGATE) {
+    parser->depth--;
+  }
+}
+
+static void
+_emit_variable (MathParser * parser, const gchar * name)
+{
+  guint slot;
+
+  for (slot = 0; slot < parser->variables->len; slot++) {
+    if (!g_strcmp0 (g_ptr_array_index (parser->variables, slot), name))
+      break;
+  }
+
+  if (slot == parser->variables->len)
+    g_ptr_array_add (parser->variables, g_strdup (name));
+
+  _emit (parser, OP_PUSH_VARIABLE, 0.0, slot);
+}
+
+static void
 _read_double (MathParser * parser)
 {
   gchar c, token[PARSER_MAX_TOKEN_SIZE];
@@ -133,70 +224,56 @@ _read_double (MathParser * parser)
   if (pos == 0 || sscanf (token, "%lf", &val) != 1)
     _error (parser, "Failed to read real number");
 
-  return val;
+  _emit (parser, OP_PUSH, val, 0);
 }
 
-static gdouble
+static void
 _read_term (MathParser * parser)
 {
-  gdouble v0;
   gchar c;
 
-  v0 = _read_power (parser);
+  _read_power (parser);
   c = _peek (parser);
 
   while (c == '*' || c == '/') {
     _next (parser);
-    if (c == '*') {
-      v0 *= _read_power (parser);
-    } else if (c == '/') {
-      v0 /= _read_power (parser);
-    }
+    _read_power (parser);
+    _emit (parser, c == '*' ? OP_MULTIPLY : OP_DIVIDE, 0.0, 0);
     c = _peek (parser);
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_expr (MathParser * parser)
 {
-  gdouble v0 = 0.0;
   gchar c;
 
   c = _peek (parser);
   if (c == '+' || c == '-') {
     _next (parser);
-    if (c == '+')
-      v0 += _read_term (parser);
-    else if (c == '-')
-      v0 -= _read_term (parser);
+    _emit (parser, OP_PUSH, 0.0, 0);
+    _read_term (parser);
+    _emit (parser, c == '+' ? OP_ADD : OP_SUBTRACT, 0.0, 0);
   } else {
-    v0 = _read_term (parser);
+    _read_term (parser);
   }
 
   c = _peek (parser);
   while (c == '+' || c == '-') {
     _next (parser);
-    if (c == '+') {
-      v0 += _read_term (parser);
-    } else if (c == '-') {
-      v0 -= _read_term (parser);
-    }
+    _read_term (parser);
+    _emit (parser, c == '+' ? OP_ADD : OP_SUBTRACT, 0.0, 0);
 
     c = _peek (parser);
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_comparison (MathParser * parser)
 {
   gchar c, oper[] = { '\0', '\0', '\0' };
-  gdouble v0, v1;
-
 
-  v0 = _read_expr (parser);
+  _read_expr (parser);
   c = _peek (parser);
   if (c == '>' || c == '<') {
     oper[0] = _next (parser);
@@ -205,30 +282,28 @@ _read_boolean_comparison (MathParser * parser)
       oper[1] = _next (parser);
 
 
-    v1 = _read_expr (parser);
+    _read_expr (parser);
 
     if (g_strcmp0 (oper, "<") == 0) {
-      v0 = (v0 < v1) ? 1.0 : 0.0;
+      _emit (parser, OP_LESS, 0.0, 0);
     } else if (g_strcmp0 (oper, ">") == 0) {
-      v0 = (v0 > v1) ? 1.0 : 0.0;
+      _emit (parser, OP_GREATER, 0.0, 0);
     } else if (g_strcmp0 (oper, "<=") == 0) {
-      v0 = (v0 <= v1) ? 1.0 : 0.0;
+      _emit (parser, OP_LESS_EQUAL, 0.0, 0);
     } else if (g_strcmp0 (oper, ">=") == 0) {
-      v0 = (v0 >= v1) ? 1.0 : 0.0;
+      _emit (parser, OP_GREATER_EQUAL, 0.0, 0);
     } else {
       _error (parser, "Unknown operation!");
     }
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_equality (MathParser * parser)
 {
   gchar c, oper[] = { '\0', '\0', '\0' };
-  gdouble v0, v1;
 
-  v0 = _read_boolean_comparison (parser);
+  _read_boolean_comparison (parser);
   c = _peek (parser);
   if (c == '=' || c == '!') {
     if (c == '!') {
@@ -236,7 +311,7 @@ _read_boolean_equality (MathParser * parser)
         oper[0] = _next (parser);
         oper[1] = _next (parser);
       } else {
-        return v0;
+        return;
       }
     } else {
       oper[0] = _next (parser);
@@ -245,25 +320,23 @@ _read_boolean_equality (MathParser * parser)
         _error (parser, "Expected a '=' for boolean '==' operator!");
       oper[1] = _next (parser);
     }
-    v1 = _read_boolean_comparison (parser);
+    _read_boolean_comparison (parser);
     if (g_strcmp0 (oper, "==") == 0) {
-      v0 = (fabs (v0 - v1) < PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+      _emit (parser, OP_EQUAL, 0.0, 0);
     } else if (g_strcmp0 (oper, "!=") == 0) {
-      v0 = (fabs (v0 - v1) > PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+      _emit (parser, OP_NOT_EQUAL, 0.0, 0);
     } else {
       _error (parser, "Unknown operation!");
     }
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_and (MathParser * parser)
 {
   gchar c;
-  gdouble v0, v1;
 
-  v0 = _read_boolean_equality (parser);
+  _read_boolean_equality (parser);
 
   c = _peek (parser);
   while (c == '&') {
@@ -274,23 +347,19 @@ _read_boolean_and (MathParser * parser)
       _error (parser, "Expected '&' to follow '&' in logical and operation!");
     _next (parser);
 
-    v1 = _read_boolean_equality (parser);
-    v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
-        && fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+    _read_boolean_equality (parser);
+    _emit (parser, OP_AND, 0.0, 0);
 
     c = _peek (parser);
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_or (MathParser * parser)
 {
   gchar c;
-  gdouble v0, v1;
 
-  v0 = _read_boolean_and (parser);
+  _read_boolean_and (parser);
 
   c = _peek (parser);
   while (c == '|') {
@@ -299,70 +368,64 @@ _read_boolean_or (MathParser * parser)
     if (c != '|')
       _error (parser, "Expected '|' to follow '|' in logical or operation!");
     _next (parser);
-    v1 = _read_boolean_and (parser);
-    v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
-        || fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+    _read_boolean_and (parser);
+    _emit (parser, OP_OR, 0.0, 0);
     c = _peek (parser);
   }
-
-  return v0;
 }
 
 static gboolean
-_init (MathParser * parser, const gchar * str,
-    GstValidateParseVariableFunc variable_func, void *user_data)
+_init (MathParser * parser, const gchar * str)
 {
   parser->str = str;
   parser->len = strlen (str) + 1;
   parser->pos = 0;
   parser->error = NULL;
-  parser->user_data = user_data;
-  parser->variable_func = variable_func;
+  parser->code = g_array_new (FALSE, FALSE, sizeof (ExpressionInstruction));
+  parser->variables = g_ptr_array_new_with_free_func (g_free);
+  parser->depth = 0;
+  parser->max_depth = 0;
 
   return TRUE;
 }
 
-static gdouble
+static gboolean
 _parse (MathParser * parser)
 {
-  gdouble result = 0.0;
-
   if (!setjmp (parser->err_jmp_buf)) {
-    result = _read_expr (parser);
+    _read_expr (parser);
     if (parser->pos < parser->len - 1) {
       _error (parser,
           "Failed to reach end of input expression, likely malformed input");
     } else
-      return result;
+      return TRUE;
   }
 
-  return -1.0;
+  return FALSE;
 }
 
-static gdouble
+static void
 _read_argument (MathParser * parser)
 {
   gchar c;
-  gdouble val;
 
-  val = _read_expr (parser);
+  _read_expr (parser);
   c = _peek (parser);
   if (c == ',')
     _next (parser);
-
-  return val;
 }
 
-static gdouble
+static void
 _read_builtin (MathParser * parser)
 {
-  gdouble v0 = 0.0, v1 = 0.0;
   gchar c, token[PARSER_MAX_TOKEN_SIZE];
   gint pos = 0;
 
   c = _peek (parser);
   if (isalpha (c) || c == '_' || c == '$') {
     while (isalpha (c) || isdigit (c) || c == '_' || c == '$') {
+      if (pos == PARSER_MAX_TOKEN_SIZE - 1)
+        _error (parser, "Name too long!");
       token[pos++] = _next (parser);
       c = _peek (parser);
     }
@@ -371,13 +434,13 @@ _read_builtin (MathParser * parser)
     if (_peek (parser) == '(') {
       _next (parser);
       if (g_strcmp0 (token, "min") == 0) {
-        v0 = _read_argument (parser);
-        v1 = _read_argument (parser);
-        v0 = MIN (v0, v1);
+        _read_argument (parser);
+        _read_argument (parser);
+        _emit (parser, OP_MIN, 0.0, 0);
       } else if (g_strcmp0 (token, "max") == 0) {
-        v0 = _read_argument (parser);
-        v1 = _read_argument (parser);
-        v0 = MAX (v0, v1);
+        _read_argument (parser);
+        _read_argument (parser);
+        _emit (parser, OP_MAX, 0.0, 0);
       } else {
         _error (parser, "Tried to call unknown built-in function!");
       }
@@ -385,80 +448,229 @@ _read_builtin (MathParser * parser)
       if (_next (parser) != ')')
         _error (parser, "Expected ')' in built-in call!");
     } else {
-      if (parser->variable_func != NULL
-          && parser->variable_func (token, &v1, parser->user_data)) {
-        v0 = v1;
-      } else {
-        gchar *err =
-            g_strdup_printf ("Could not look up value for variable %s!", token);
-        _error (parser, err);
-        g_free (err);
-      }
+      _emit_variable (parser, token);
     }
   } else {
-    v0 = _read_double (parser);
+    _read_double (parser);
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_parenthesis (MathParser * parser)
 {
-  gdouble val;
-
   if (_peek (parser) == '(') {
     _next (parser);
-    val = _read_boolean_or (parser);
+    _read_boolean_or (parser);
     if (_peek (parser) != ')')
       _error (parser, "Expected ')'!");
     _next (parser);
   } else {
-    val = _read_builtin (parser);
+    _read_builtin (parser);
   }
-
-  return val;
 }
 
-static gdouble
+static void
 _read_unary (MathParser * parser)
 {
   gchar c;
-  gdouble v0 = 0.0;
 
   c = _peek (parser);
   if (c == '!') {
     _error (parser, "Expected '+' or '-' for unary expression, got '!'");
   } else if (c == '-') {
     _next (parser);
-    v0 = -_read_parenthesis (parser);
+    _read_parenthesis (parser);
+    _emit (parser, OP_NEGATE, 0.0, 0);
   } else if (c == '+') {
     _next (parser);
-    v0 = _read_parenthesis (parser);
+    _read_parenthesis (parser);
   } else {
-    v0 = _read_parenthesis (parser);
+    _read_parenthesis (parser);
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_power (MathParser * parser)
 {
-  gdouble v0, v1 = 1.0, s = 1.0;
+  gboolean negate = FALSE;
 
-  v0 = _read_unary (parser);
+  _read_unary (parser);
 
   while (_peek (parser) == '^') {
     _next (parser);
     if (_peek (parser) == '-') {
       _next (parser);
-      s = -1.0;
+      negate = TRUE;
     }
-    v1 = s * _read_power (parser);
-    v0 = pow (v0, v1);
+    _read_power (parser);
+    if (negate)
+      _emit (parser, OP_NEGATE, 0.0, 0);
+    _emit (parser, OP_POWER, 0.0, 0);
+  }
+}
+
+/**
+ * gst_validate_utils_compile_expression: (skip):
+ * @expr: The expression to compile
+ * @error: (out) (optional): Return location for an error message
+ *
+ * Compiles @expr so that it can be evaluated any number of times with
+ * gst_validate_expression_evaluate() without being parsed again.
+ *
+ * Returns: (transfer full) (nullable): The compiled expression, to be freed
+ * with gst_validate_expression_free(), or %NULL if @expr could not be parsed
+ */
+GstValidateExpression *
+gst_validate_utils_compile_expression (const gchar * expr, gchar ** error)
+{
+  MathParser parser;
+  GstValidateExpression *compiled = NULL;
+  gchar **spl = g_strsplit (expr, " ", -1);
+  gchar *expr_nospace = g_strjoinv ("", spl);
+
+  _init (&parser, expr_nospace);
+  if (_parse (&parser)) {
+    compiled = g_slice_new (GstValidateExpression);
+    compiled->n_code = parser.code->len;
+    compiled->code = (ExpressionInstruction *)
+        g_array_free (parser.code, FALSE);
+    compiled->n_variables = parser.variables->len;
+    g_ptr_array_add (parser.variables, NULL);
+    compiled->variables = (gchar **) g_ptr_array_free (parser.variables,
+        FALSE);
+    compiled->stack_size = parser.max_depth;
+  } else {
+    g_array_free (parser.code, TRUE);
+    g_ptr_array_free (parser.variables, TRUE);
   }
+  g_strfreev (spl);
+  g_free (expr_nospace);
+
+  if (error)
+    *error = g_strdup (parser.error);
 
-  return v0;
+  return compiled;
+}
+
+/**
+ * gst_validate_expression_evaluate: (skip):
+ * @expr: A compiled expression
+ * @variable_func: (scope call) (allow-none): The function used to get the
+ *   current value of the variables used in @expr
+ * @user_data: The data to pass to @variable_func
+ * @error: (out) (optional): Return location for an error message
+ *
+ * Returns: The value of @expr, or -1.0 if one of its variables could not be
+ * looked up
+ */
+gdouble
+gst_validate_expression_evaluate (GstValidateExpression * expr,
+    GstValidateParseVariableFunc variable_func, gpointer user_data,
+    gchar ** error)
+{
+  guint i, top = 0;
+  gdouble *values = g_newa (gdouble, expr->n_variables + 1);
+  gdouble *stack = g_newa (gdouble, expr->stack_size + 1);
+
+  if (error)
+    *error = NULL;
+
+  for (i = 0; i < expr->n_variables; i++) {
+    if (variable_func == NULL
+        || !variable_func (expr->variables[i], &values[i], user_data)) {
+      if (error)
+        *error = g_strdup_printf ("Could not look up value for variable %s!",
+            expr->variables[i]);
+      return -1.0;
+    }
+  }
+
+  for (i = 0; i < expr->n_code; i++) {
+    const ExpressionInstruction *instruction = &expr->code[i];
+    gdouble v0, v1;
+
+    switch (instruction->op) {
+      case OP_PUSH:
+        stack[top++] = instruction->value;
+        continue;
+      case OP_PUSH_VARIABLE:
+        stack[top++] = values[instruction->slot];
+        continue;
+      case OP_NEGATE:
+        stack[top - 1] = -stack[top - 1];
+        continue;
+      default:
+        break;
+    }
+
+    v1 = stack[--top];
+    v0 = stack[top - 1];
+    switch (instruction->op) {
+      case OP_ADD:
+        v0 += v1;
+        break;
+      case OP_SUBTRACT:
+        v0 -= v1;
+        break;
+      case OP_MULTIPLY:
+        v0 *= v1;
+        break;
+      case OP_DIVIDE:
+        v0 /= v1;
+        break;
+      case OP_POWER:
+        v0 = pow (v0, v1);
+        break;
+      case OP_LESS:
+        v0 = (v0 < v1) ? 1.0 : 0.0;
+        break;
+      case OP_GREATER:
+        v0 = (v0 > v1) ? 1.0 : 0.0;
+        break;
+      case OP_LESS_EQUAL:
+        v0 = (v0 <= v1) ? 1.0 : 0.0;
+        break;
+      case OP_GREATER_EQUAL:
+        v0 = (v0 >= v1) ? 1.0 : 0.0;
+        break;
+      case OP_EQUAL:
+        v0 = (fabs (v0 - v1) < PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case OP_NOT_EQUAL:
+        v0 = (fabs (v0 - v1) > PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case OP_AND:
+        v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
+            && fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case OP_OR:
+        v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
+            || fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case OP_MIN:
+        v0 = MIN (v0, v1);
+        break;
+      case OP_MAX:
+        v0 = MAX (v0, v1);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+    stack[top - 1] = v0;
+  }
+
+  return stack[0];
+}
+
+/**
+ * gst_validate_expression_free: (skip):
+ */
+void
+gst_validate_expression_free (GstValidateExpression * expr)
+{
+  g_free (expr->code);
+  g_strfreev (expr->variables);
+  g_slice_free (GstValidateExpression, expr);
 }
 
 /**
@@ -470,21 +682,16 @@ gst_validate_utils_parse_expression (const gchar * expr,
     gchar ** error)
 {
   gdouble val;
-  MathParser parser;
-  gchar **spl = g_strsplit (expr, " ", -1);
-  gchar *expr_nospace = g_strjoinv ("", spl);
+  GstValidateExpression *compiled;
 
-  _init (&parser, expr_nospace, variable_func, user_data);
-  val = _parse (&parser);
-  g_strfreev (spl);
-  g_free (expr_nospace);
+  compiled = gst_validate_utils_compile_expression (expr, error);
+  if (!compiled)
+    return -1.0;
+
+  val = gst_validate_expression_evaluate (compiled, variable_func, user_data,
+      error);
+  gst_validate_expression_free (compiled);
 
-  if (error) {
-    if (parser.error)
-      *error = g_strdup (parser.error);
-    else
-      *error = NULL;
-  }
   return val;
 }
 
@@ -541,113 +748,181 @@ gst_validate_utils_enum_from_str (GType type, const gchar * str_enum,
   return TRUE;
 }
 
-/* Parse file that contains a list of GStructures */
-static gchar **
-_file_get_lines (GFile * file)
+static GstStructure *
+_copy_structure (const GstStructure * structure, gpointer unused)
 {
-  gsize size;
-
-  GError *err = NULL;
-  gchar *content = NULL, *escaped_content = NULL, **lines = NULL;
-
-  /* TODO Handle GCancellable */
-  if (!g_file_load_contents (file, NULL, &content, &size, NULL, &err)) {
-    GST_WARNING ("Failed to load contents: %d %s", err->code, err->message);
-    g_error_free (err);
-    return NULL;
-  }
-  if (g_strcmp0 (content, "") == 0) {
-    g_free (content);
-    return NULL;
-  }
-
-  if (_clean_structs_lines == NULL)
-    _clean_structs_lines =
-        g_regex_new ("\\\\\n|#.*\n", G_REGEX_CASELESS, 0, NULL);
-
-  escaped_content =
-      g_regex_replace (_clean_structs_lines, content, -1, 0, "", 0, NULL);
-  g_free (content);
-
-  lines = g_strsplit (escaped_content, "\n", 0);
-  g_free (escaped_content);
-
-  return lines;
+  return gst_structure_copy (structure);
 }
 
-static gchar **
-_get_lines (const gchar * scenario_file)
+static void
+_structs_cache_entry_free (StructsCacheEntry * entry)
 {
-  GFile *file = NULL;
-  gchar **lines = NULL;
-
-  GST_DEBUG ("Trying to load %s", scenario_file);
-  if ((file = g_file_new_for_path (scenario_file)) == NULL) {
-    GST_WARNING ("%s wrong uri", scenario_file);
-    return NULL;
-  }
-
-  lines = _file_get_lines (file);
+  g_list_free_full (entry->structures, (GDestroyNotify) gst_structure_free);
+  g_slice_free (StructsCacheEntry, entry);
+}
 
-  g_object_unref (file);
+/* Modification time of @st in nanoseconds, so that a file rewritten within
+ * the same second is not mistaken for its previous version when it keeps
+ * the same size */
+gint64
+gst_validate_utils_get_mtime (const GStatBuf * st)
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+  return (gint64) st->st_mtim.tv_sec * G_GINT64_CONSTANT (1000000000) +
+      st->st_mtim.tv_nsec;
+#else
+  return (gint64) st->st_mtime * G_GINT64_CONSTANT (1000000000);
+#endif
+}
 
-  return lines;
+void
+gst_validate_utils_deinit (void)
+{
+  g_mutex_lock (&_structs_cache_lock);
+  if (_structs_cache)
+    g_hash_table_unref (_structs_cache);
+  _structs_cache = NULL;
+  g_mutex_unlock (&_structs_cache_lock);
 }
 
-/* Returns: (transfer full): a #GList of #GstStructure */
+/* Parses the structures in @content, one per line, in a single pass.
+ * Escaped newlines join lines and everything from a '#' up to and including
+ * the end of its line is dropped.
+ *
+ * Returns: (transfer full): a #GList of #GstStructure, or %NULL if any of
+ * them could not be parsed */
 static GList *
-_lines_get_structures (gchar ** lines)
+_parse_structures (const gchar * content, gsize size)
 {
-  gint i;
+  const gchar *c = content, *end = content + size;
+  GString *line = g_string_sized_new (256);
   GList *structures = NULL;
 
-  if (lines == NULL)
-    return NULL;
-
-  for (i = 0; lines[i]; i++) {
+  while (c < end) {
     GstStructure *structure;
 
-    if (g_strcmp0 (lines[i], "") == 0)
+    g_string_truncate (line, 0);
+    while (c < end && *c != '\n') {
+      if (*c == '\\' && c + 1 < end && c[1] == '\n') {
+        c += 2;
+      } else if (*c == '#' && memchr (c, '\n', end - c)) {
+        c = (const gchar *) memchr (c, '\n', end - c) + 1;
+      } else {
+        const gchar *next = c + 1;
+
+        while (next < end && *next != '\n' && *next != '\\' && *next != '#')
+          next++;
+        g_string_append_len (line, c, next - c);
+        c = next;
+      }
+    }
+    c++;
+
+    if (line->len == 0)
       continue;
 
-    structure = gst_structure_from_string (lines[i], NULL);
+    structure = gst_structure_from_string (line->str, NULL);
     if (structure == NULL) {
-      GST_ERROR ("Could not parse action %s", lines[i]);
-      goto failed;
+      GST_ERROR ("Could not parse action %s", line->str);
+      g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+      structures = NULL;
+      break;
     }
 
-    structures = g_list_append (structures, structure);
+    structures = g_list_prepend (structures, structure);
   }
 
-done:
-  g_strfreev (lines);
+  g_string_free (line, TRUE);
 
-  return structures;
+  return g_list_reverse (structures);
+}
 
-failed:
-  if (structures)
-    g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
-  structures = NULL;
+/* Parse file that contains a list of GStructures */
+static GList *
+_file_get_structures (GFile * file)
+{
+  gsize size;
+  GList *structures;
+  GError *err = NULL;
+  gchar *content = NULL;
 
-  goto done;
+  /* TODO Handle GCancellable */
+  if (!g_file_load_contents (file, NULL, &content, &size, NULL, &err)) {
+    GST_WARNING ("Failed to load contents: %d %s", err->code, err->message);
+    g_error_free (err);
+    return NULL;
+  }
+
+  structures = _parse_structures (content, size);
+  g_free (content);
+
+  return structures;
 }
 
 /**
  * gst_validate_utils_structs_parse_from_filename: (skip):
+ *
+ * The structures of each file are kept around as long as its inode,
+ * modification time and size do not change, so loading it again only copies
+ * them.
  */
 GList *
 gst_validate_utils_structs_parse_from_filename (const gchar * scenario_file)
 {
-  gchar **lines;
+  GFile *file;
+  GList *structures;
+  GStatBuf st;
+  StructsCacheEntry *entry;
+  gboolean cacheable;
+
+  GST_DEBUG ("Trying to load %s", scenario_file);
+  cacheable = g_stat (scenario_file, &st) == 0;
+  if (cacheable) {
+    g_mutex_lock (&_structs_cache_lock);
+    entry = _structs_cache ? g_hash_table_lookup (_structs_cache,
+        scenario_file) : NULL;
+    if (entry && entry->mtime == gst_validate_utils_get_mtime (&st)
+        && entry->size == st.st_size && entry->ino == (guint64) st.st_ino) {
+      structures = g_list_copy_deep (entry->structures,
+          (GCopyFunc) _copy_structure, NULL);
+      g_mutex_unlock (&_structs_cache_lock);
+
+      return structures;
+    }
+    g_mutex_unlock (&_structs_cache_lock);
+  }
+
+  if ((file = g_file_new_for_path (scenario_file)) == NULL) {
+    GST_WARNING ("%s wrong uri", scenario_file);
+    return NULL;
+  }
 
-  lines = _get_lines (scenario_file);
+  structures = _file_get_structures (file);
+  g_object_unref (file);
 
-  if (lines == NULL) {
-    GST_DEBUG ("Got no line for file: %s", scenario_file);
+  if (structures == NULL) {
+    GST_DEBUG ("Got no structure for file: %s", scenario_file);
     return NULL;
   }
 
-  return _lines_get_structures (lines);
+  if (!cacheable)
+    return structures;
+
+  entry = g_slice_new (StructsCacheEntry);
+  entry->mtime = gst_validate_utils_get_mtime (&st);
+  entry->size = st.st_size;
+  entry->ino = st.st_ino;
+  entry->structures = g_list_copy_deep (structures,
+      (GCopyFunc) _copy_structure, NULL);
+
+  g_mutex_lock (&_structs_cache_lock);
+  if (!_structs_cache)
+    _structs_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) _structs_cache_entry_free);
+  g_hash_table_insert (_structs_cache, g_strdup (scenario_file), entry);
+  g_mutex_unlock (&_structs_cache_lock);
+
+  return structures;
 }
 
 /**
@@ -656,14 +931,16 @@ gst_validate_utils_structs_parse_from_filename (const gchar * scenario_file)
 GList *
 gst_validate_structs_parse_from_gfile (GFile * scenario_file)
 {
-  gchar **lines;
+  GList *structures;
+  gchar *path = g_file_get_path (scenario_file);
 
-  lines = _file_get_lines (scenario_file);
+  if (!path)
+    return _file_get_structures (scenario_file);
 
-  if (lines == NULL)
-    return NULL;
+  structures = gst_validate_utils_structs_parse_from_filename (path);
+  g_free (path);
 
-  return _lines_get_structures (lines);
+  return structures;
 }
 
 static gboolean
@@ -20,15 +20,125 @@
  */
 
 #include "media-descriptor-parser.h"
+#include "gst-validate-internal.h"
+#include <errno.h>
 #include <string.h>
+#include <glib/gstdio.h>
+
+/* The compiled form of a descriptor, stored next to it with a .bin
+ * suffix, all the integers being little endian:
+ *
+ *   header | streams | segments | frames | tags | strings
+ *
+ * Records have a fixed size, multiple of 8 so that all the tables are
+ * aligned in the mapped file. Strings are referenced by their offset in
+ * the NUL separated string pool, and tags by their index in the tags
+ * table which holds the offsets of their serialized taglists. */
+#define BINARY_MAGIC "GSTVMDB"
+#define BINARY_VERSION 2
+#define BINARY_SUFFIX ".bin"
+#define BINARY_NO_STRING G_MAXUINT32
+
+#define BINARY_FILE_FRAME_DETECTION (1 << 0)
+#define BINARY_FILE_SKIP_PARSERS (1 << 1)
+#define BINARY_FILE_SEEKABLE (1 << 2)
+#define BINARY_HAS_TAGS (1 << 3)
+#define BINARY_FILE_CHECKSUM_VIDEO_FRAMES (1 << 4)
+
+typedef struct
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 flags;
+  /* Size and modification time, in nanoseconds where available, of the
+   * XML descriptor it was compiled from, used to detect stale compiled
+   * forms */
+  guint64 xml_size;
+  gint64 xml_mtime;
+  guint64 id;
+  guint64 duration;
+  guint32 checksum_type;
+  guint32 uri;
+  guint32 tags;
+  guint32 n_tags;
+  guint32 n_streams;
+  guint32 n_segments;
+  guint32 n_frames;
+  guint32 n_all_tags;
+  guint32 strings_size;
+  guint32 padding;
+} BinaryHeader;
+
+typedef struct
+{
+  guint32 id;
+  guint32 caps;
+  guint32 padname;
+  guint32 flags;
+  guint32 tags;
+  guint32 n_tags;
+  guint32 segments;
+  guint32 n_segments;
+  guint32 frames;
+  guint32 n_frames;
+} BinaryStream;
+
+typedef struct
+{
+  gint32 next_frame_id;
+  guint32 format;
+  guint32 flags;
+  guint32 padding;
+  guint64 rate;
+  guint64 applied_rate;
+  guint64 base;
+  guint64 offset;
+  guint64 start;
+  guint64 stop;
+  guint64 time;
+  guint64 position;
+  guint64 duration;
+} BinarySegment;
+
+typedef struct
+{
+  guint64 id;
+  guint64 offset;
+  guint64 offset_end;
+  guint64 duration;
+  guint64 pts;
+  guint64 dts;
+  guint64 running_time;
+  guint32 is_keyframe;
+  guint8 digest_size;
+  guint8 padding[3];
+  guint8 digest[GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE];
+} BinaryFrame;
+
+G_STATIC_ASSERT (sizeof (BinaryHeader) % 8 == 0);
+G_STATIC_ASSERT (sizeof (BinaryStream) % 8 == 0);
+G_STATIC_ASSERT (sizeof (BinarySegment) % 8 == 0);
+G_STATIC_ASSERT (sizeof (BinaryFrame) % 8 == 0);
 
 struct _GstValidateMediaDescriptorParserPrivate
 {
   gchar *xmlpath;
 
   gboolean in_stream;
+  /* Whether the algorithm used for the frames checksums is known, either
+   * from the file node or from the size of the first frame checksum */
+  gboolean has_checksum_type;
   gchar *xmlcontent;
   GMarkupParseContext *parsecontext;
+
+  /* The compiled form the descriptor was loaded from, if any */
+  GMappedFile *binary;
+  const BinaryStream *binary_streams;
+  const BinarySegment *binary_segments;
+  const BinaryFrame *binary_frames;
+  const guint32 *binary_tags;
+  const gchar *binary_strings;
+  guint32 binary_strings_size;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GstValidateMediaDescriptorParser,
@@ -55,10 +165,11 @@ compare_frames (GstValidateMediaFrameNode * frm,
   return 1;
 }
 
-static void
+static gboolean
     deserialize_filenode
     (GstValidateMediaFileNode *
-    filenode, const gchar ** names, const gchar ** values)
+    filenode, const gchar ** names, const gchar ** values,
+    gboolean * has_checksum_type, GError ** error)
 {
   gint i;
   for (i = 0; names[i] != NULL; i++) {
@@ -72,7 +183,86 @@ static void
       filenode->duration = g_ascii_strtoull (values[i], NULL, 0);
     else if (g_strcmp0 (names[i], "seekable") == 0)
       filenode->seekable = (g_strcmp0 (values[i], "true") == 0);
+    else if (g_strcmp0 (names[i], "checksum-video-frames") == 0)
+      filenode->checksum_video_frames = (g_strcmp0 (values[i], "true") == 0);
+    else if (g_strcmp0 (names[i], "checksum-type") == 0) {
+      if (!gst_validate_checksum_type_from_name (values[i],
+              &filenode->checksum_type)) {
+        g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+            "Unknown checksum type: %s", values[i]);
+
+        return FALSE;
+      }
+      *has_checksum_type = TRUE;
+    }
+  }
+
+  return TRUE;
+}
+
+static gsize
+_checksum_type_get_size (GstValidateChecksumType type)
+{
+  switch (type) {
+    case GST_VALIDATE_CHECKSUM_TYPE_MD5:
+      return 16;
+    case GST_VALIDATE_CHECKSUM_TYPE_SHA1:
+      return 20;
+    case GST_VALIDATE_CHECKSUM_TYPE_SHA256:
+      return 32;
+    case GST_VALIDATE_CHECKSUM_TYPE_XXH64:
+      return 8;
+  }
+
+  return 0;
+}
+
+/* Makes sure @checksum was computed with the algorithm of @filenode. When
+ * the file node does not specify it, the descriptor was written before the
+ * algorithm was recorded, and it is guessed from the size of the first frame
+ * checksum so that SHA-1 or SHA-256 ones do not get compared as MD5.
+ * Checksums that are not hexadecimal digests are left alone, they will
+ * simply never match */
+static gboolean
+_check_frame_checksum (GstValidateMediaDescriptorParserPrivate * priv,
+    GstValidateMediaFileNode * filenode, const gchar * checksum,
+    GError ** error)
+{
+  GstValidateChecksumType type;
+  guint8 digest[GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE];
+  gsize size = gst_validate_media_descriptor_parse_checksum (checksum, digest);
+
+  if (!size)
+    return TRUE;
+
+  if (!priv->has_checksum_type) {
+    for (type = GST_VALIDATE_CHECKSUM_TYPE_MD5;
+        type <= GST_VALIDATE_CHECKSUM_TYPE_XXH64; type++) {
+      if (_checksum_type_get_size (type) == size) {
+        filenode->checksum_type = type;
+        priv->has_checksum_type = TRUE;
+        break;
+      }
+    }
   }
+
+  if (!priv->has_checksum_type) {
+    g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+        "Frame checksum %s was not computed with any known algorithm",
+        checksum);
+
+    return FALSE;
+  }
+
+  if (_checksum_type_get_size (filenode->checksum_type) != size) {
+    g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+        "Frame checksum %s is not a %s checksum", checksum,
+        gst_validate_checksum_type_get_name (filenode->checksum_type));
+
+    return FALSE;
+  }
+
+  return TRUE;
 }
 
 static GstValidateMediaStreamNode *
@@ -153,6 +343,27 @@ deserialize_tagnode (const gchar ** names, const gchar ** values)
   return tagnode;
 }
 
+/* Wraps the checksum in a buffer with the frame's metadata, as
+ * #gst_validate_media_descriptor_get_buffers hands them out */
+static void
+_framenode_set_buffer (GstValidateMediaFrameNode * framenode)
+{
+  framenode->buf = gst_buffer_new_wrapped (framenode->checksum,
+      strlen (framenode->checksum) + 1);
+
+  GST_BUFFER_OFFSET (framenode->buf) = framenode->offset;
+  GST_BUFFER_OFFSET_END (framenode->buf) = framenode->offset_end;
+  GST_BUFFER_DURATION (framenode->buf) = framenode->duration;
+  GST_BUFFER_PTS (framenode->buf) = framenode->pts;
+  GST_BUFFER_DTS (framenode->buf) = framenode->dts;
+
+  if (framenode->is_keyframe) {
+    GST_BUFFER_FLAG_UNSET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  } else {
+    GST_BUFFER_FLAG_SET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  }
+}
+
 static GstValidateMediaFrameNode *
 deserialize_framenode (const gchar ** names, const gchar ** values)
 {
@@ -191,20 +402,7 @@ deserialize_framenode (const gchar ** names, const gchar ** values)
   }
 /* *INDENT-ON* */
 
-  framenode->buf = gst_buffer_new_wrapped (framenode->checksum,
-      strlen (framenode->checksum) + 1);
-
-  GST_BUFFER_OFFSET (framenode->buf) = framenode->offset;
-  GST_BUFFER_OFFSET_END (framenode->buf) = framenode->offset_end;
-  GST_BUFFER_DURATION (framenode->buf) = framenode->duration;
-  GST_BUFFER_PTS (framenode->buf) = framenode->pts;
-  GST_BUFFER_DTS (framenode->buf) = framenode->dts;
-
-  if (framenode->is_keyframe) {
-    GST_BUFFER_FLAG_UNSET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
-  } else {
-    GST_BUFFER_FLAG_SET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
-  }
+  _framenode_set_buffer (framenode);
 
   return framenode;
 }
@@ -234,7 +432,8 @@ on_start_element_cb (GMarkupParseContext * context,
       GST_VALIDATE_MEDIA_DESCRIPTOR_PARSER (user_data)->priv;
 
   if (g_strcmp0 (element_name, "file") == 0) {
-    deserialize_filenode (filenode, attribute_names, attribute_values);
+    deserialize_filenode (filenode, attribute_names, attribute_values,
+        &priv->has_checksum_type, error);
   } else if (g_strcmp0 (element_name, "stream") == 0) {
     GstValidateMediaStreamNode
         * node = deserialize_streamnode (attribute_names, attribute_values);
@@ -249,11 +448,13 @@ on_start_element_cb (GMarkupParseContext * context,
 
   } else if (g_strcmp0 (element_name, "frame") == 0) {
     GstValidateMediaStreamNode *streamnode = filenode->streams->data;
+    GstValidateMediaFrameNode *framenode =
+        deserialize_framenode (attribute_names, attribute_values);
 
     streamnode->cframe = streamnode->frames =
-        g_list_insert_sorted (streamnode->frames,
-        deserialize_framenode (attribute_names, attribute_values),
+        g_list_insert_sorted (streamnode->frames, framenode,
         (GCompareFunc) compare_frames);
+    _check_frame_checksum (priv, filenode, framenode->checksum, error);
   } else if (g_strcmp0 (element_name, "tags") == 0) {
     if (priv->in_stream) {
       GstValidateMediaStreamNode *snode = (GstValidateMediaStreamNode *)
@@ -314,6 +515,368 @@ failed:
   return FALSE;
 }
 
+static const gchar *
+_binary_string (GstValidateMediaDescriptorParserPrivate * priv,
+    guint32 offset)
+{
+  offset = GUINT32_FROM_LE (offset);
+
+  if (offset == BINARY_NO_STRING || offset >= priv->binary_strings_size)
+    return NULL;
+
+  return priv->binary_strings + offset;
+}
+
+static gdouble
+_binary_double (guint64 value)
+{
+  union
+  {
+    guint64 i;
+    gdouble d;
+  } u;
+
+  u.i = GUINT64_FROM_LE (value);
+
+  return u.d;
+}
+
+static GstValidateMediaTagsNode *
+_binary_tagsnode (GstValidateMediaDescriptorParserPrivate * priv,
+    guint32 first, guint32 n_tags)
+{
+  guint32 i;
+  GstValidateMediaTagsNode *tagsnode = g_slice_new0 (GstValidateMediaTagsNode);
+
+  for (i = 0; i < n_tags; i++) {
+    const gchar *content = _binary_string (priv, priv->binary_tags[first + i]);
+    GstValidateMediaTagNode *tagnode = g_slice_new0 (GstValidateMediaTagNode);
+
+    if (content)
+      tagnode->taglist = gst_tag_list_new_from_string (content);
+    tagsnode->tags = g_list_append (tagsnode->tags, tagnode);
+  }
+
+  return tagsnode;
+}
+
+static GstValidateSegmentNode *
+_binary_segmentnode (const BinarySegment * record)
+{
+  GstValidateSegmentNode *node = g_slice_new0 (GstValidateSegmentNode);
+
+  node->next_frame_id = GINT32_FROM_LE (record->next_frame_id);
+  node->segment.format = GUINT32_FROM_LE (record->format);
+  node->segment.flags = GUINT32_FROM_LE (record->flags);
+  node->segment.rate = _binary_double (record->rate);
+  node->segment.applied_rate = _binary_double (record->applied_rate);
+  node->segment.base = GUINT64_FROM_LE (record->base);
+  node->segment.offset = GUINT64_FROM_LE (record->offset);
+  node->segment.start = GUINT64_FROM_LE (record->start);
+  node->segment.stop = GUINT64_FROM_LE (record->stop);
+  node->segment.time = GUINT64_FROM_LE (record->time);
+  node->segment.position = GUINT64_FROM_LE (record->position);
+  node->segment.duration = GUINT64_FROM_LE (record->duration);
+
+  return node;
+}
+
+/* Only the digest of the frames checksums is stored, checksums that were
+ * not hexadecimal digests come back empty, they would not match anyway */
+static gchar *
+_binary_checksum (const BinaryFrame * record)
+{
+  guint8 i, size = MIN (record->digest_size,
+      GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE);
+  gchar *checksum = g_malloc (size * 2 + 1);
+
+  for (i = 0; i < size; i++)
+    g_snprintf (checksum + i * 2, 3, "%02x", record->digest[i]);
+  checksum[size * 2] = '\0';
+
+  return checksum;
+}
+
+static GstValidateMediaFrameNode *
+_binary_framenode (const BinaryFrame * record)
+{
+  GstValidateMediaFrameNode *framenode =
+      g_slice_new0 (GstValidateMediaFrameNode);
+
+  framenode->id = GUINT64_FROM_LE (record->id);
+  framenode->offset = GUINT64_FROM_LE (record->offset);
+  framenode->offset_end = GUINT64_FROM_LE (record->offset_end);
+  framenode->duration = GUINT64_FROM_LE (record->duration);
+  framenode->pts = GUINT64_FROM_LE (record->pts);
+  framenode->dts = GUINT64_FROM_LE (record->dts);
+  framenode->running_time = GUINT64_FROM_LE (record->running_time);
+  framenode->is_keyframe = GUINT32_FROM_LE (record->is_keyframe);
+  framenode->checksum = _binary_checksum (record);
+
+  _framenode_set_buffer (framenode);
+
+  return framenode;
+}
+
+/* GstValidateMediaDescriptorFramesLoader reading the frames table of the
+ * compiled form, either into the stream node or straight into the expected
+ * frames without building any node */
+static void
+_binary_load_frames (GstValidateMediaDescriptor * descriptor,
+    GstValidateMediaStreamNode * streamnode, GArray * expected_frames)
+{
+  guint32 i, first, n_frames;
+  const BinaryStream *stream;
+  GstValidateMediaDescriptorParserPrivate *priv =
+      GST_VALIDATE_MEDIA_DESCRIPTOR_PARSER (descriptor)->priv;
+  gint index = g_list_index (descriptor->filenode->streams, streamnode);
+
+  g_assert (index >= 0);
+  stream = &priv->binary_streams[index];
+  first = GUINT32_FROM_LE (stream->frames);
+  n_frames = GUINT32_FROM_LE (stream->n_frames);
+
+  if (!expected_frames) {
+    for (i = 0; i < n_frames; i++)
+      streamnode->frames = g_list_prepend (streamnode->frames,
+          _binary_framenode (&priv->binary_frames[first + i]));
+    streamnode->cframe = streamnode->frames =
+        g_list_reverse (streamnode->frames);
+
+    return;
+  }
+
+  g_array_set_size (expected_frames, n_frames);
+  for (i = 0; i < n_frames; i++) {
+    const BinaryFrame *record = &priv->binary_frames[first + i];
+    GstValidateMediaExpectedFrame *frame =
+        &g_array_index (expected_frames, GstValidateMediaExpectedFrame, i);
+
+    memset (frame, 0, sizeof (GstValidateMediaExpectedFrame));
+    frame->pts = GUINT64_FROM_LE (record->pts);
+    frame->dts = GUINT64_FROM_LE (record->dts);
+    frame->duration = GUINT64_FROM_LE (record->duration);
+    frame->is_keyframe = GUINT32_FROM_LE (record->is_keyframe) != FALSE;
+    frame->checksum_size = MIN (record->digest_size,
+        GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE);
+    memcpy (frame->checksum, record->digest, frame->checksum_size);
+  }
+}
+
+/* Checks that the tables referenced by the streams are in bounds, so that
+ * nothing has to be checked when loading them */
+static gboolean
+_binary_check_streams (const BinaryHeader * header,
+    const BinaryStream * streams)
+{
+  guint32 i;
+  guint64 n_segments = GUINT32_FROM_LE (header->n_segments),
+      n_frames = GUINT32_FROM_LE (header->n_frames),
+      n_all_tags = GUINT32_FROM_LE (header->n_all_tags);
+
+  if ((guint64) GUINT32_FROM_LE (header->tags) +
+      GUINT32_FROM_LE (header->n_tags) > n_all_tags)
+    return FALSE;
+
+  for (i = 0; i < GUINT32_FROM_LE (header->n_streams); i++) {
+    const BinaryStream *stream = &streams[i];
+
+    if ((guint64) GUINT32_FROM_LE (stream->tags) +
+        GUINT32_FROM_LE (stream->n_tags) > n_all_tags
+        || (guint64) GUINT32_FROM_LE (stream->segments) +
+        GUINT32_FROM_LE (stream->n_segments) > n_segments
+        || (guint64) GUINT32_FROM_LE (stream->frames) +
+        GUINT32_FROM_LE (stream->n_frames) > n_frames)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Loads the compiled form of the descriptor at @xmlpath if there is an up to
+ * date one, mapping it and only building the nodes of the file and its
+ * streams. The frames are loaded when needed. */
+static gboolean
+_load_binary (GstValidateMediaDescriptorParser * parser, const gchar * xmlpath)
+{
+  gsize size;
+  guint32 i;
+  GStatBuf xmlstat;
+  const gchar *data;
+  const BinaryHeader *header;
+  guint64 streams_offset, segments_offset, frames_offset, tags_offset,
+      strings_offset;
+  GError *err = NULL;
+  GstValidateMediaDescriptorParserPrivate *priv = parser->priv;
+  GstValidateMediaFileNode *filenode =
+      ((GstValidateMediaDescriptor *) parser)->filenode;
+  gchar *path = g_strconcat (xmlpath, BINARY_SUFFIX, NULL);
+
+  if (!g_file_test (path, G_FILE_TEST_IS_REGULAR))
+    goto fallback;
+
+  priv->binary = g_mapped_file_new (path, FALSE, &err);
+  if (!priv->binary) {
+    GST_INFO ("Could not map %s: %s", path, err->message);
+    g_clear_error (&err);
+    goto fallback;
+  }
+
+  data = g_mapped_file_get_contents (priv->binary);
+  size = g_mapped_file_get_length (priv->binary);
+  header = (const BinaryHeader *) data;
+  if (size < sizeof (BinaryHeader)
+      || memcmp (header->magic, BINARY_MAGIC, sizeof (BINARY_MAGIC))
+      || GUINT32_FROM_LE (header->version) != BINARY_VERSION) {
+    GST_INFO ("%s is not a compiled media descriptor we can read", path);
+    goto fallback;
+  }
+
+  if (!g_stat (xmlpath, &xmlstat)
+      && ((guint64) xmlstat.st_size != GUINT64_FROM_LE (header->xml_size)
+          || gst_validate_utils_get_mtime (&xmlstat) !=
+          GINT64_FROM_LE (header->xml_mtime))) {
+    GST_INFO ("%s is outdated, loading %s", path, xmlpath);
+    goto fallback;
+  }
+
+  streams_offset = sizeof (BinaryHeader);
+  segments_offset = streams_offset +
+      (guint64) GUINT32_FROM_LE (header->n_streams) * sizeof (BinaryStream);
+  frames_offset = segments_offset +
+      (guint64) GUINT32_FROM_LE (header->n_segments) * sizeof (BinarySegment);
+  tags_offset = frames_offset +
+      (guint64) GUINT32_FROM_LE (header->n_frames) * sizeof (BinaryFrame);
+  strings_offset = tags_offset +
+      (guint64) GUINT32_FROM_LE (header->n_all_tags) * sizeof (guint32);
+  priv->binary_strings_size = GUINT32_FROM_LE (header->strings_size);
+
+  if (strings_offset + priv->binary_strings_size != size
+      || (priv->binary_strings_size && data[size - 1] != '\0')
+      || !_binary_check_streams (header,
+          (const BinaryStream *) (data + streams_offset))) {
+    GST_WARNING ("%s is corrupted, loading %s", path, xmlpath);
+    goto fallback;
+  }
+
+  priv->binary_streams = (const BinaryStream *) (data + streams_offset);
+  priv->binary_segments = (const BinarySegment *) (data + segments_offset);
+  priv->binary_frames = (const BinaryFrame *) (data + frames_offset);
+  priv->binary_tags = (const guint32 *) (data + tags_offset);
+  priv->binary_strings = data + strings_offset;
+
+  filenode->id = GUINT64_FROM_LE (header->id);
+  filenode->uri = g_strdup (_binary_string (priv, header->uri));
+  filenode->duration = GUINT64_FROM_LE (header->duration);
+  filenode->frame_detection =
+      (GUINT32_FROM_LE (header->flags) & BINARY_FILE_FRAME_DETECTION) != 0;
+  filenode->skip_parsers =
+      (GUINT32_FROM_LE (header->flags) & BINARY_FILE_SKIP_PARSERS) != 0;
+  filenode->seekable =
+      (GUINT32_FROM_LE (header->flags) & BINARY_FILE_SEEKABLE) != 0;
+  filenode->checksum_video_frames =
+      (GUINT32_FROM_LE (header->flags) & BINARY_FILE_CHECKSUM_VIDEO_FRAMES)
+      != 0;
+  filenode->checksum_type = GUINT32_FROM_LE (header->checksum_type);
+  if (GUINT32_FROM_LE (header->flags) & BINARY_HAS_TAGS)
+    filenode->tags = _binary_tagsnode (priv, GUINT32_FROM_LE (header->tags),
+        GUINT32_FROM_LE (header->n_tags));
+
+  for (i = 0; i < GUINT32_FROM_LE (header->n_streams); i++) {
+    guint32 j;
+    const gchar *caps;
+    const BinaryStream *stream = &priv->binary_streams[i];
+    GstValidateMediaStreamNode *streamnode =
+        g_slice_new0 (GstValidateMediaStreamNode);
+
+    streamnode->id = g_strdup (_binary_string (priv, stream->id));
+    streamnode->padname = g_strdup (_binary_string (priv, stream->padname));
+    caps = _binary_string (priv, stream->caps);
+    if (caps)
+      streamnode->caps = gst_caps_from_string (caps);
+
+    for (j = 0; j < GUINT32_FROM_LE (stream->n_segments); j++)
+      streamnode->segments = g_list_append (streamnode->segments,
+          _binary_segmentnode (&priv->binary_segments
+              [GUINT32_FROM_LE (stream->segments) + j]));
+
+    if (GUINT32_FROM_LE (stream->flags) & BINARY_HAS_TAGS)
+      streamnode->tags = _binary_tagsnode (priv,
+          GUINT32_FROM_LE (stream->tags), GUINT32_FROM_LE (stream->n_tags));
+
+    filenode->streams = g_list_append (filenode->streams, streamnode);
+  }
+
+  gst_validate_media_descriptor_set_frames_loader ((GstValidateMediaDescriptor
+          *) parser, _binary_load_frames);
+  GST_DEBUG ("Loaded compiled media descriptor %s", path);
+  g_free (path);
+
+  return TRUE;
+
+fallback:
+  g_clear_pointer (&priv->binary, g_mapped_file_unref);
+  g_free (path);
+
+  return FALSE;
+}
+
+static guint32
+_add_string (GString * strings, GHashTable * offsets, const gchar * str)
+{
+  gpointer offset;
+
+  if (!str)
+    return GUINT32_TO_LE (BINARY_NO_STRING);
+
+  if (!g_hash_table_lookup_extended (offsets, str, NULL, &offset)) {
+    offset = GUINT_TO_POINTER (strings->len);
+    g_string_append_len (strings, str, strlen (str) + 1);
+    g_hash_table_insert (offsets, (gpointer) str, offset);
+  }
+
+  return GUINT32_TO_LE (GPOINTER_TO_UINT (offset));
+}
+
+static guint64
+_double_to_binary (gdouble value)
+{
+  union
+  {
+    guint64 i;
+    gdouble d;
+  } u;
+
+  u.d = value;
+
+  return GUINT64_TO_LE (u.i);
+}
+
+static guint32
+_add_tags (GstValidateMediaTagsNode * tagsnode, GArray * tags,
+    GString * strings, GHashTable * offsets, GPtrArray * allocated,
+    guint32 * n_tags)
+{
+  GList *tmp;
+  guint32 first = tags->len;
+
+  for (tmp = tagsnode->tags; tmp; tmp = tmp->next) {
+    GstValidateMediaTagNode *tagnode = tmp->data;
+    gchar *content = NULL;
+    guint32 offset;
+
+    if (tagnode->taglist) {
+      content = gst_tag_list_to_string (tagnode->taglist);
+      g_ptr_array_add (allocated, content);
+    }
+    offset = _add_string (strings, offsets, content);
+    g_array_append_val (tags, offset);
+  }
+  *n_tags = GUINT32_TO_LE (tags->len - first);
+
+  return GUINT32_TO_LE (first);
+}
+
 static gboolean
 set_xml_path (GstValidateMediaDescriptorParser * parser, const gchar * path,
     GError ** error)
@@ -324,6 +887,11 @@ set_xml_path (GstValidateMediaDescriptorParser * parser, const gchar * path,
   GstValidateMediaDescriptorParserPrivate *priv = parser->priv;
   gboolean result;
 
+  if (_load_binary (parser, path)) {
+    priv->xmlpath = g_strdup (path);
+    return TRUE;
+  }
+
   if (!g_file_get_contents (path, &content, &xmlsize, &err))
     goto failed;
 
@@ -359,6 +927,9 @@ finalize (GstValidateMediaDescriptorParser * parser)
   if (priv->parsecontext != NULL)
     g_markup_parse_context_free (priv->parsecontext);
 
+  if (priv->binary)
+    g_mapped_file_unref (priv->binary);
+
   G_OBJECT_CLASS (gst_validate_media_descriptor_parser_parent_class)->finalize
       (G_OBJECT (parser));
 }
@@ -449,6 +1020,176 @@ gst_validate_media_descriptor_parser_new_from_xml (GstValidateRunner * runner,
   return parser;
 }
 
+/**
+ * gst_validate_media_descriptor_parser_write_binary:
+ * @parser: A #GstValidateMediaDescriptorParser
+ * @xmlpath: The path of the XML descriptor @parser was loaded from
+ * @error: (out) (allow-none): A #GError location for the error
+ *
+ * Writes the compiled form of @parser next to @xmlpath, with a `.bin`
+ * suffix. It is a compact binary form which
+ * #gst_validate_media_descriptor_parser_new will then map and load lazily
+ * instead of parsing @xmlpath, as long as @xmlpath is not modified.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ */
+gboolean
+gst_validate_media_descriptor_parser_write_binary
+    (GstValidateMediaDescriptorParser * parser, const gchar * xmlpath,
+    GError ** error) {
+  GList *tmp, *tmp2;
+  GStatBuf xmlstat;
+  BinaryHeader header = { {0,}, };
+  GArray *streams, *segments, *frames, *tags;
+  GString *strings, *content;
+  GHashTable *offsets;
+  GPtrArray *allocated;
+  gchar *path;
+  gboolean ret;
+  GstValidateMediaFileNode *filenode;
+
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR_PARSER (parser),
+      FALSE);
+  g_return_val_if_fail (xmlpath, FALSE);
+
+  if (g_stat (xmlpath, &xmlstat)) {
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+        "Could not stat %s: %s", xmlpath, g_strerror (errno));
+    return FALSE;
+  }
+
+  gst_validate_media_descriptor_ensure_frames ((GstValidateMediaDescriptor *)
+      parser);
+  filenode = ((GstValidateMediaDescriptor *) parser)->filenode;
+
+  streams = g_array_new (FALSE, TRUE, sizeof (BinaryStream));
+  segments = g_array_new (FALSE, TRUE, sizeof (BinarySegment));
+  frames = g_array_new (FALSE, TRUE, sizeof (BinaryFrame));
+  tags = g_array_new (FALSE, FALSE, sizeof (guint32));
+  strings = g_string_new (NULL);
+  offsets = g_hash_table_new (g_str_hash, g_str_equal);
+  allocated = g_ptr_array_new_with_free_func (g_free);
+
+  for (tmp = filenode->streams; tmp; tmp = tmp->next) {
+    GstValidateMediaStreamNode *streamnode = tmp->data;
+    BinaryStream stream = { 0, };
+    gchar *caps = NULL;
+
+    if (streamnode->caps) {
+      caps = gst_caps_to_string (streamnode->caps);
+      g_ptr_array_add (allocated, caps);
+    }
+
+    stream.id = _add_string (strings, offsets, streamnode->id);
+    stream.caps = _add_string (strings, offsets, caps);
+    stream.padname = _add_string (strings, offsets, streamnode->padname);
+    if (streamnode->tags) {
+      stream.flags = GUINT32_TO_LE (BINARY_HAS_TAGS);
+      stream.tags = _add_tags (streamnode->tags, tags, strings, offsets,
+          allocated, &stream.n_tags);
+    }
+
+    stream.segments = GUINT32_TO_LE (segments->len);
+    for (tmp2 = streamnode->segments; tmp2; tmp2 = tmp2->next) {
+      GstValidateSegmentNode *segmentnode = tmp2->data;
+      BinarySegment segment = { 0, };
+
+      segment.next_frame_id = GINT32_TO_LE (segmentnode->next_frame_id);
+      segment.format = GUINT32_TO_LE (segmentnode->segment.format);
+      segment.flags = GUINT32_TO_LE (segmentnode->segment.flags);
+      segment.rate = _double_to_binary (segmentnode->segment.rate);
+      segment.applied_rate =
+          _double_to_binary (segmentnode->segment.applied_rate);
+      segment.base = GUINT64_TO_LE (segmentnode->segment.base);
+      segment.offset = GUINT64_TO_LE (segmentnode->segment.offset);
+      segment.start = GUINT64_TO_LE (segmentnode->segment.start);
+      segment.stop = GUINT64_TO_LE (segmentnode->segment.stop);
+      segment.time = GUINT64_TO_LE (segmentnode->segment.time);
+      segment.position = GUINT64_TO_LE (segmentnode->segment.position);
+      segment.duration = GUINT64_TO_LE (segmentnode->segment.duration);
+      g_array_append_val (segments, segment);
+    }
+    stream.n_segments =
+        GUINT32_TO_LE (segments->len - GUINT32_FROM_LE (stream.segments));
+
+    stream.frames = GUINT32_TO_LE (frames->len);
+    for (tmp2 = streamnode->frames; tmp2; tmp2 = tmp2->next) {
+      GstValidateMediaFrameNode *framenode = tmp2->data;
+      BinaryFrame frame = { 0, };
+
+      frame.id = GUINT64_TO_LE (framenode->id);
+      frame.offset = GUINT64_TO_LE (framenode->offset);
+      frame.offset_end = GUINT64_TO_LE (framenode->offset_end);
+      frame.duration = GUINT64_TO_LE (framenode->duration);
+      frame.pts = GUINT64_TO_LE (framenode->pts);
+      frame.dts = GUINT64_TO_LE (framenode->dts);
+      frame.running_time = GUINT64_TO_LE (framenode->running_time);
+      frame.is_keyframe = GUINT32_TO_LE (framenode->is_keyframe);
+      frame.digest_size =
+          gst_validate_media_descriptor_parse_checksum (framenode->checksum,
+          frame.digest);
+      g_array_append_val (frames, frame);
+    }
+    stream.n_frames =
+        GUINT32_TO_LE (frames->len - GUINT32_FROM_LE (stream.frames));
+
+    g_array_append_val (streams, stream);
+  }
+
+  memcpy (header.magic, BINARY_MAGIC, sizeof (BINARY_MAGIC));
+  header.version = GUINT32_TO_LE (BINARY_VERSION);
+  header.flags = GUINT32_TO_LE ((filenode->frame_detection ?
+          BINARY_FILE_FRAME_DETECTION : 0) | (filenode->skip_parsers ?
+          BINARY_FILE_SKIP_PARSERS : 0) | (filenode->seekable ?
+          BINARY_FILE_SEEKABLE : 0) | (filenode->tags ? BINARY_HAS_TAGS : 0)
+      | (filenode->checksum_video_frames ?
+          BINARY_FILE_CHECKSUM_VIDEO_FRAMES : 0));
+  header.xml_size = GUINT64_TO_LE (xmlstat.st_size);
+  header.xml_mtime = GINT64_TO_LE (gst_validate_utils_get_mtime (&xmlstat));
+  header.id = GUINT64_TO_LE (filenode->id);
+  header.duration = GUINT64_TO_LE (filenode->duration);
+  header.checksum_type = GUINT32_TO_LE (filenode->checksum_type);
+  header.uri = _add_string (strings, offsets, filenode->uri);
+  if (filenode->tags)
+    header.tags = _add_tags (filenode->tags, tags, strings, offsets,
+        allocated, &header.n_tags);
+  header.n_streams = GUINT32_TO_LE (streams->len);
+  header.n_segments = GUINT32_TO_LE (segments->len);
+  header.n_frames = GUINT32_TO_LE (frames->len);
+  header.n_all_tags = GUINT32_TO_LE (tags->len);
+  header.strings_size = GUINT32_TO_LE (strings->len);
+
+  content = g_string_sized_new (sizeof (BinaryHeader) +
+      streams->len * sizeof (BinaryStream) +
+      segments->len * sizeof (BinarySegment) +
+      frames->len * sizeof (BinaryFrame) + tags->len * sizeof (guint32) +
+      strings->len);
+  g_string_append_len (content, (const gchar *) &header, sizeof (header));
+  g_string_append_len (content, streams->data,
+      streams->len * sizeof (BinaryStream));
+  g_string_append_len (content, segments->data,
+      segments->len * sizeof (BinarySegment));
+  g_string_append_len (content, frames->data,
+      frames->len * sizeof (BinaryFrame));
+  g_string_append_len (content, tags->data, tags->len * sizeof (guint32));
+  g_string_append_len (content, strings->str, strings->len);
+
+  path = g_strconcat (xmlpath, BINARY_SUFFIX, NULL);
+  ret = g_file_set_contents (path, content->str, content->len, error);
+
+  g_free (path);
+  g_string_free (content, TRUE);
+  g_ptr_array_unref (allocated);
+  g_hash_table_unref (offsets);
+  g_string_free (strings, TRUE);
+  g_array_unref (tags);
+  g_array_unref (frames);
+  g_array_unref (segments);
+  g_array_unref (streams);
+
+  return ret;
+}
+
 gchar *gst_validate_media_descriptor_parser_get_xml_path
     (GstValidateMediaDescriptorParser * parser)
 {
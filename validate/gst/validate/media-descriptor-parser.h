@@ -66,6 +66,10 @@ gst_validate_media_descriptor_parser_new_from_xml                   (GstValidate
 GST_VALIDATE_API
 gchar * gst_validate_media_descriptor_parser_get_xml_path        (GstValidateMediaDescriptorParser *parser);
 GST_VALIDATE_API
+gboolean gst_validate_media_descriptor_parser_write_binary       (GstValidateMediaDescriptorParser *parser,
+                                                                  const gchar * xmlpath,
+                                                                  GError **error);
+GST_VALIDATE_API
 gboolean gst_validate_media_descriptor_parser_add_stream         (GstValidateMediaDescriptorParser *parser,
                                                                   GstPad *pad);
 GST_VALIDATE_API
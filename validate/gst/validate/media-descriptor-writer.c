@@ -126,9 +126,12 @@ serialize_filenode (GstValidateMediaDescriptorWriter * writer)
       * filenode = ((GstValidateMediaDescriptor *) writer)->filenode;
 
   tmpstr = g_markup_printf_escaped ("<file duration=\"%" G_GUINT64_FORMAT
-      "\" frame-detection=\"%i\" skip-parsers=\"%i\" uri=\"%s\" seekable=\"%s\">\n",
+      "\" frame-detection=\"%i\" skip-parsers=\"%i\" uri=\"%s\" seekable=\"%s\""
+      " checksum-type=\"%s\" checksum-video-frames=\"%s\">\n",
       filenode->duration, filenode->frame_detection, filenode->skip_parsers,
-      filenode->uri, filenode->seekable ? "true" : "false");
+      filenode->uri, filenode->seekable ? "true" : "false",
+      gst_validate_checksum_type_get_name (filenode->checksum_type),
+      filenode->checksum_video_frames ? "true" : "false");
 
   if (filenode->caps)
     caps_str = gst_caps_to_string (filenode->caps);
@@ -588,14 +591,21 @@ _run_frame_analysis (GstValidateMediaDescriptorWriter * writer,
   monitor =
       gst_validate_monitor_factory_create (GST_OBJECT_CAST (writer->
           priv->pipeline), runner, NULL);
-  gst_validate_reporter_set_handle_g_logs (GST_VALIDATE_REPORTER (monitor));
+  /* The g_log handler is global, it is left alone when several analyses run
+   * at the same time */
+  if (!FLAG_IS_SET (writer,
+          GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_CONCURRENT))
+    gst_validate_reporter_set_handle_g_logs (GST_VALIDATE_REPORTER (monitor));
 
   g_object_set (uridecodebin, "uri", uri, "caps", writer->priv->raw_caps, NULL);
   g_signal_connect (uridecodebin, "pad-added", G_CALLBACK (pad_added_cb),
       writer);
   gst_bin_add (GST_BIN (writer->priv->pipeline), uridecodebin);
 
-  writer->priv->loop = g_main_loop_new (NULL, FALSE);
+  /* Run in the thread default context so that several files can be
+   * analyzed concurrently, each from its own thread */
+  writer->priv->loop =
+      g_main_loop_new (g_main_context_get_thread_default (), FALSE);
   bus = gst_element_get_bus (writer->priv->pipeline);
   gst_bus_add_signal_watch (bus);
   g_signal_connect (bus, "message", (GCallback) bus_callback, writer);
@@ -702,6 +712,14 @@ gst_validate_media_descriptor_writer_new_discover (GstValidateRunner * runner,
         gst_discoverer_info_get_seekable (info));
 
     writer->priv->flags = flags;
+    if (FLAG_IS_SET (writer,
+            GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM))
+      ((GstValidateMediaDescriptor *) writer)->filenode->checksum_type =
+          GST_VALIDATE_CHECKSUM_TYPE_XXH64;
+    ((GstValidateMediaDescriptor *) writer)->filenode->checksum_video_frames =
+        FLAG_IS_SET (writer,
+        GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_VIDEO_FRAME_CHECKSUM);
+
     if (FLAG_IS_SET (writer,
             GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_HANDLE_GLOGS))
       gst_validate_reporter_set_handle_g_logs (GST_VALIDATE_REPORTER (writer));
@@ -908,12 +926,34 @@ gboolean
   return FALSE;
 }
 
+static gchar *
+_compute_checksum (GstValidateMediaFileNode * filenode, GstPad * pad,
+    GstBuffer * buf)
+{
+  GstCaps *caps;
+  gchar *res = NULL;
+  GstValidateChecksum *checksum;
+
+  if (!filenode->checksum_video_frames)
+    return gst_validate_compute_checksum_for_buffer (filenode->checksum_type,
+        buf);
+
+  caps = gst_pad_get_current_caps (pad);
+  checksum = gst_validate_checksum_new (filenode->checksum_type);
+  if (gst_validate_checksum_update_video_buffer (checksum, buf, caps))
+    res = g_strdup (gst_validate_checksum_get_string (checksum));
+  gst_validate_checksum_free (checksum);
+  if (caps)
+    gst_caps_unref (caps);
+
+  return res;
+}
+
 gboolean
 gst_validate_media_descriptor_writer_add_frame (GstValidateMediaDescriptorWriter
     * writer, GstPad * pad, GstBuffer * buf)
 {
   GstValidateMediaStreamNode *streamnode;
-  GstMapInfo map;
   gchar *checksum;
   guint id;
   GstSegment *segment;
@@ -930,6 +970,15 @@ gst_validate_media_descriptor_writer_add_frame (GstValidateMediaDescriptorWriter
   filenode->skip_parsers =
       FLAG_IS_SET (writer,
       GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER);
+
+  /* Hashing does not need the lock, so the streams are hashed concurrently */
+  checksum = _compute_checksum (filenode, pad, buf);
+  if (!checksum) {
+    GST_WARNING_OBJECT (writer, "Could not map %" GST_PTR_FORMAT
+        ", not adding it as a frame", buf);
+    return FALSE;
+  }
+
   GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK (writer);
   streamnode =
       gst_validate_media_descriptor_find_stream_node_by_pad (
@@ -937,17 +986,13 @@ gst_validate_media_descriptor_writer_add_frame (GstValidateMediaDescriptorWriter
       writer, pad);
   if (streamnode == NULL) {
     GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (writer);
+    g_free (checksum);
     return FALSE;
   }
 
   id = g_list_length (streamnode->frames);
   fnode = g_slice_new0 (GstValidateMediaFrameNode);
 
-  g_assert (gst_buffer_map (buf, &map, GST_MAP_READ));
-  checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-      (const guchar *) map.data, map.size);
-  gst_buffer_unmap (buf, &map);
-
   fnode->id = id;
   fnode->offset = GST_BUFFER_OFFSET (buf);
   fnode->offset_end = GST_BUFFER_OFFSET_END (buf);
@@ -1001,6 +1046,27 @@ gst_validate_media_descriptor_writer_write (GstValidateMediaDescriptorWriter *
   if (g_file_set_contents (filename, serialized, -1, NULL) == TRUE)
     ret = TRUE;
 
+  /* The compiled form is built from what parsing the XML gives, so that
+   * loading either of them results in the same descriptor */
+  if (ret && FLAG_IS_SET (writer,
+          GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_BINARY)) {
+    GError *err = NULL;
+    GstValidateMediaDescriptorParser *parser =
+        gst_validate_media_descriptor_parser_new_from_xml (NULL, serialized,
+        &err);
+
+    if (!parser || !gst_validate_media_descriptor_parser_write_binary (parser,
+            filename, &err)) {
+      GST_ERROR_OBJECT (writer, "Could not write the compiled form of %s: %s",
+          filename, err ? err->message : "unknown error");
+      ret = FALSE;
+    }
+
+    g_clear_error (&err);
+    if (parser)
+      gst_object_unref (parser);
+  }
+
 
   g_free (serialized);
 
@@ -62,6 +62,10 @@ typedef enum
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER    = 1 << 1,
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FULL         = 1 << 2,
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_HANDLE_GLOGS = 1 << 3,
+    GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM = 1 << 4,
+    GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_BINARY       = 1 << 5,
+    GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_VIDEO_FRAME_CHECKSUM = 1 << 6,
+    GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_CONCURRENT   = 1 << 7,
 } GstValidateMediaDescriptorWriterFlags;
 
 GST_VALIDATE_API
@@ -22,10 +22,12 @@
 
 #include <string.h>
 #include "media-descriptor.h"
+#include "gst-validate-internal.h"
 
 struct _GstValidateMediaDescriptorPrivate
 {
-  gpointer dummy;
+  /* Set by descriptors which load their frames on demand */
+  GstValidateMediaDescriptorFramesLoader frames_loader;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstValidateMediaDescriptor,
@@ -557,6 +559,36 @@ compare_streams (GstValidateMediaDescriptor * ref,
   return TRUE;
 }
 
+void
+gst_validate_media_descriptor_set_frames_loader (GstValidateMediaDescriptor *
+    self, GstValidateMediaDescriptorFramesLoader loader)
+{
+  GstValidateMediaDescriptorPrivate *priv =
+      gst_validate_media_descriptor_get_instance_private (self);
+
+  GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK (self);
+  priv->frames_loader = loader;
+  GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (self);
+}
+
+/* Makes sure the frames of every stream are in the filenode */
+void
+gst_validate_media_descriptor_ensure_frames (GstValidateMediaDescriptor *
+    self)
+{
+  GList *tmp;
+  GstValidateMediaDescriptorPrivate *priv =
+      gst_validate_media_descriptor_get_instance_private (self);
+
+  GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK (self);
+  if (priv->frames_loader) {
+    for (tmp = self->filenode->streams; tmp; tmp = tmp->next)
+      priv->frames_loader (self, tmp->data, NULL);
+    priv->frames_loader = NULL;
+  }
+  GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (self);
+}
+
 gboolean
 gst_validate_media_descriptors_compare (GstValidateMediaDescriptor * ref,
     GstValidateMediaDescriptor * compared)
@@ -565,6 +597,9 @@ gst_validate_media_descriptors_compare (GstValidateMediaDescriptor * ref,
   GstValidateMediaFileNode
       * rfilenode = ref->filenode, *cfilenode = compared->filenode;
 
+  gst_validate_media_descriptor_ensure_frames (ref);
+  gst_validate_media_descriptor_ensure_frames (compared);
+
   if (rfilenode->duration != cfilenode->duration) {
     GST_VALIDATE_REPORT (ref, FILE_DURATION_INCORRECT,
         "Duration %" GST_TIME_FORMAT " is different from the reference %"
@@ -634,6 +669,7 @@ gst_validate_media_descriptor_get_buffers (GstValidateMediaDescriptor * self,
   g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self), FALSE);
   g_return_val_if_fail (self->filenode, FALSE);
 
+  gst_validate_media_descriptor_ensure_frames (self);
   for (tmpstream = self->filenode->streams;
       tmpstream; tmpstream = tmpstream->next) {
     GstValidateMediaStreamNode
@@ -677,11 +713,194 @@ done:
   return ret;
 }
 
+/* Converts an hexadecimal checksum to the digest it represents, returning
+ * its size or 0 if @str is not a valid checksum */
+guint8
+gst_validate_media_descriptor_parse_checksum (const gchar * str,
+    guint8 * digest)
+{
+  guint8 len = 0;
+
+  if (!str)
+    return 0;
+
+  while (len < GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE
+      && g_ascii_isxdigit (str[0]) && g_ascii_isxdigit (str[1])) {
+    digest[len++] = (g_ascii_xdigit_value (str[0]) << 4)
+        | g_ascii_xdigit_value (str[1]);
+    str += 2;
+  }
+
+  /* Not an hexadecimal checksum, it will never match */
+  if (*str)
+    return 0;
+
+  return len;
+}
+
+/**
+ * gst_validate_media_descriptor_get_expected_frames: (skip):
+ * @self: A #GstValidateMediaDescriptor
+ * @pad: The pad the frames are expected on
+ *
+ * Returns: (transfer full) (nullable): The frames expected on @pad, or %NULL
+ * if the descriptor has no stream matching @pad. Free with
+ * #gst_validate_media_expected_frames_free.
+ */
+GstValidateMediaExpectedFrames *
+gst_validate_media_descriptor_get_expected_frames (GstValidateMediaDescriptor *
+    self, GstPad * pad)
+{
+  GList *tmpstream, *tmpframe;
+  GstValidateMediaStreamNode *streamnode = NULL;
+  GstValidateMediaExpectedFrames *frames;
+  GstClockTime min_ts = GST_CLOCK_TIME_NONE;
+  GstCaps *pad_caps;
+  guint i;
+  GstValidateMediaDescriptorPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self), NULL);
+  g_return_val_if_fail (self->filenode, NULL);
+  g_return_val_if_fail (GST_IS_PAD (pad), NULL);
+
+  pad_caps = gst_pad_get_current_caps (pad);
+  for (tmpstream = self->filenode->streams;
+      tmpstream; tmpstream = tmpstream->next) {
+    GstValidateMediaStreamNode *snode = tmpstream->data;
+
+    if (snode->pad == pad || (!snode->pad && pad_caps
+            && gst_caps_is_subset (pad_caps, snode->caps))) {
+      streamnode = snode;
+      break;
+    }
+  }
+  if (pad_caps)
+    gst_caps_unref (pad_caps);
+
+  if (!streamnode)
+    return NULL;
+
+  priv = gst_validate_media_descriptor_get_instance_private (self);
+  frames = g_slice_new0 (GstValidateMediaExpectedFrames);
+  frames->checksum_type = self->filenode->checksum_type;
+  frames->checksum_video_frames = self->filenode->checksum_video_frames;
+  frames->keyframes = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK (self);
+  if (priv->frames_loader) {
+    /* Let the descriptor fill the frames without building the nodes */
+    frames->frames = g_array_new (FALSE, FALSE,
+        sizeof (GstValidateMediaExpectedFrame));
+    priv->frames_loader (self, streamnode, frames->frames);
+  } else {
+    frames->frames = g_array_sized_new (FALSE, FALSE,
+        sizeof (GstValidateMediaExpectedFrame),
+        g_list_length (streamnode->frames));
+
+    for (tmpframe = streamnode->frames; tmpframe; tmpframe = tmpframe->next) {
+      GstValidateMediaFrameNode *fnode = tmpframe->data;
+      GstValidateMediaExpectedFrame frame = { 0, };
+
+      frame.pts = fnode->pts;
+      frame.dts = fnode->dts;
+      frame.duration = fnode->duration;
+      frame.is_keyframe = fnode->is_keyframe != FALSE;
+      frame.checksum_size =
+          gst_validate_media_descriptor_parse_checksum (fnode->checksum,
+          frame.checksum);
+      g_array_append_val (frames->frames, frame);
+    }
+  }
+  GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (self);
+
+  /* Walk backward to compute the minimum timestamps, which are then
+   * increasing with the frame index, and index the keyframes */
+  for (i = frames->frames->len; i > 0; i--) {
+    GstValidateMediaExpectedFrame *frame =
+        &g_array_index (frames->frames, GstValidateMediaExpectedFrame, i - 1);
+    GstClockTime ts = GST_CLOCK_TIME_IS_VALID (frame->dts) ?
+        frame->dts : frame->pts;
+
+    /* GST_CLOCK_TIME_NONE is bigger than any valid timestamp */
+    min_ts = MIN (min_ts, ts);
+    frame->min_ts = min_ts;
+  }
+
+  for (i = 0; i < frames->frames->len; i++) {
+    GstValidateMediaExpectedFrame *frame =
+        &g_array_index (frames->frames, GstValidateMediaExpectedFrame, i);
+
+    if (frame->is_keyframe && (GST_CLOCK_TIME_IS_VALID (frame->dts)
+            || GST_CLOCK_TIME_IS_VALID (frame->pts)))
+      g_array_append_val (frames->keyframes, i);
+  }
+
+  return frames;
+}
+
+void
+gst_validate_media_expected_frames_free (GstValidateMediaExpectedFrames *
+    frames)
+{
+  g_array_unref (frames->frames);
+  g_array_unref (frames->keyframes);
+  g_slice_free (GstValidateMediaExpectedFrames, frames);
+}
+
+/**
+ * gst_validate_media_expected_frames_find_sync_point: (skip):
+ * @frames: A #GstValidateMediaExpectedFrames
+ * @start: The start of the new segment
+ *
+ * Finds the frame from which decoding should restart to produce @start:
+ * starting from the last frame whose timestamp is before @start, the
+ * preceding keyframe.
+ *
+ * Returns: The index of the frame, 0 if there is no such keyframe
+ */
+guint
+gst_validate_media_expected_frames_find_sync_point
+    (GstValidateMediaExpectedFrames * frames, GstClockTime start)
+{
+  guint low = 0, high = frames->frames->len, last_before_start;
+
+  /* The last frame with a timestamp before start is the last one whose
+   * min_ts is before start */
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
+
+    if (g_array_index (frames->frames, GstValidateMediaExpectedFrame,
+            mid).min_ts <= start)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low == 0)
+    return 0;
+  last_before_start = low - 1;
+
+  /* And the last keyframe at or before it */
+  low = 0;
+  high = frames->keyframes->len;
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
+
+    if (g_array_index (frames->keyframes, guint, mid) <= last_before_start)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low ? g_array_index (frames->keyframes, guint, low - 1) : 0;
+}
+
 gboolean
 gst_validate_media_descriptor_has_frame_info (GstValidateMediaDescriptor * self)
 {
   GList *tmpstream;
 
+  gst_validate_media_descriptor_ensure_frames (self);
   for (tmpstream = self->filenode->streams;
       tmpstream; tmpstream = tmpstream->next) {
     GstValidateMediaStreamNode
@@ -712,6 +931,42 @@ gst_validate_media_descriptor_get_seekable (GstValidateMediaDescriptor * self)
   return self->filenode->seekable;
 }
 
+/**
+ * gst_validate_media_descriptor_get_checksum_type:
+ * @self: A #GstValidateMediaDescriptor
+ *
+ * Returns: The algorithm used to compute the checksums of the frames
+ * described by @self
+ */
+GstValidateChecksumType
+gst_validate_media_descriptor_get_checksum_type (GstValidateMediaDescriptor *
+    self)
+{
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self),
+      GST_VALIDATE_CHECKSUM_TYPE_MD5);
+  g_return_val_if_fail (self->filenode, GST_VALIDATE_CHECKSUM_TYPE_MD5);
+
+  return self->filenode->checksum_type;
+}
+
+/**
+ * gst_validate_media_descriptor_get_checksum_video_frames:
+ * @self: A #GstValidateMediaDescriptor
+ *
+ * Returns: Whether the checksums of the raw video frames described by @self
+ * only cover the visible part of their planes, see
+ * #gst_validate_checksum_update_video_buffer
+ */
+gboolean
+gst_validate_media_descriptor_get_checksum_video_frames
+    (GstValidateMediaDescriptor * self)
+{
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self), FALSE);
+  g_return_val_if_fail (self->filenode, FALSE);
+
+  return self->filenode->checksum_video_frames;
+}
+
 /**
  * gst_validate_media_descriptor_get_pads: (skip):
  */
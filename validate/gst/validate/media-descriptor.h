@@ -26,6 +26,7 @@
 #include <glib-object.h>
 #include <gst/gst.h>
 #include "gst-validate-report.h"
+#include "gst-validate-checksum.h"
 
 G_BEGIN_DECLS
 
@@ -57,6 +58,11 @@ typedef struct
   gboolean frame_detection;
   gboolean skip_parsers;
   gboolean seekable;
+  /* The algorithm used for the frames checksums */
+  GstValidateChecksumType checksum_type;
+  /* Whether raw video frames were checksummed plane by plane, ignoring the
+   * row padding */
+  gboolean checksum_video_frames;
 
   GstCaps *caps;
 
@@ -117,6 +123,47 @@ typedef struct
   gchar *str_close;
 } GstValidateMediaFrameNode;
 
+/**
+ * GstValidateMediaExpectedFrame:
+ * @pts: The expected PTS
+ * @dts: The expected DTS
+ * @duration: The expected duration
+ * @min_ts: The smallest timestamp (DTS, or PTS when unknown) of this frame and
+ * all the frames expected after it
+ * @is_keyframe: Whether the frame is expected to be a keyframe
+ * @checksum_size: The number of meaningful bytes in @checksum
+ * @checksum: The expected checksum of the frame content, in binary form
+ */
+typedef struct
+{
+  GstClockTime pts, dts;
+  GstClockTime duration;
+  GstClockTime min_ts;
+  gboolean is_keyframe;
+  guint8 checksum_size;
+  guint8 checksum[GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE];
+} GstValidateMediaExpectedFrame;
+
+/**
+ * GstValidateMediaExpectedFrames:
+ * @checksum_type: The algorithm used to compute the checksums
+ * @checksum_video_frames: Whether raw video frames were checksummed with
+ * #gst_validate_checksum_update_video_buffer
+ * @frames: The #GstValidateMediaExpectedFrame, in the order they are expected
+ * @keyframes: The indices in @frames of the keyframes with a valid timestamp,
+ * in increasing order
+ *
+ * The frames expected on a pad, indexed so that the frame to restart from
+ * after a seek can be found with binary searches.
+ */
+typedef struct
+{
+  GstValidateChecksumType checksum_type;
+  gboolean checksum_video_frames;
+  GArray *frames;
+  GArray *keyframes;
+} GstValidateMediaExpectedFrames;
+
 typedef struct
 {
   gint next_frame_id;
@@ -177,6 +224,15 @@ gst_validate_media_descriptor_detects_frames (GstValidateMediaDescriptor *
 GST_VALIDATE_API
 gboolean gst_validate_media_descriptor_get_buffers (GstValidateMediaDescriptor *
     self, GstPad * pad, GCompareFunc compare_func, GList ** bufs);
+GST_VALIDATE_API GstValidateMediaExpectedFrames *
+gst_validate_media_descriptor_get_expected_frames (GstValidateMediaDescriptor *
+    self, GstPad * pad);
+GST_VALIDATE_API void
+gst_validate_media_expected_frames_free (GstValidateMediaExpectedFrames *
+    frames);
+GST_VALIDATE_API guint
+gst_validate_media_expected_frames_find_sync_point
+    (GstValidateMediaExpectedFrames * frames, GstClockTime start);
 GST_VALIDATE_API gboolean
 gst_validate_media_descriptor_has_frame_info (GstValidateMediaDescriptor *
     self);
@@ -188,5 +244,11 @@ gboolean gst_validate_media_descriptor_get_seekable (GstValidateMediaDescriptor
 GST_VALIDATE_API
 GList *gst_validate_media_descriptor_get_pads (GstValidateMediaDescriptor *
     self);
+GST_VALIDATE_API GstValidateChecksumType
+gst_validate_media_descriptor_get_checksum_type (GstValidateMediaDescriptor *
+    self);
+GST_VALIDATE_API gboolean
+gst_validate_media_descriptor_get_checksum_video_frames
+    (GstValidateMediaDescriptor * self);
 G_END_DECLS
 #endif
@@ -17,6 +17,7 @@
 #include <gst/validate/gst-validate-report.h>
 #include <gst/validate/gst-validate-reporter.h>
 #include <gst/validate/gst-validate-media-info.h>
+#include <gst/validate/gst-validate-checksum.h>
 
 GST_VALIDATE_API
 void gst_validate_init (void);
@@ -493,6 +493,7 @@ class GstValidateMixerTestsGenerator(GstValidatePipelineTestsGenerator):
 
 
 class GstValidateLaunchTest(GstValidateTest):
+    supports_workers = True
 
     def __init__(self, classname, options, reporter, pipeline_desc,
                  timeout=DEFAULT_TIMEOUT, scenario=None,
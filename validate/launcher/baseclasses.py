@@ -20,12 +20,15 @@
 """ Class representing tests and test managers. """
 
 import json
+import mmap
 import os
+import pathlib
 import sys
 import re
 import copy
 import shlex
 import socketserver
+import string
 import struct
 import time
 from . import utils
@@ -74,6 +77,9 @@ class Test(Loggable):
 
     """ A class representing a particular test. """
 
+    # Whether the application can run the test in a GstValidateWorker
+    supports_workers = False
+
     def __init__(self, application_name, classname, options,
                  reporter, duration=0, timeout=DEFAULT_TIMEOUT,
                  hard_timeout=None, extra_env_variables=None,
@@ -366,6 +372,15 @@ class Test(Loggable):
     def run_external_checks(self):
         pass
 
+    def can_use_worker(self):
+        """
+        Whether the test can run in a GstValidateWorker instead of its own
+        process, see --use-workers
+        """
+        return self.supports_workers and self.options.use_workers and \
+            not self.options.gdb and not self.options.valgrind and \
+            not self.options.redirect_logs and self.workdir is None
+
     def thread_wrapper(self):
         def enable_sigint():
             # Restore the SIGINT handler for the child process (gdb) to ensure
@@ -377,13 +392,20 @@ class Test(Loggable):
         else:
             preexec_fn = None
 
-        self.process = subprocess.Popen(self.command,
-                                        stderr=self.out,
-                                        stdout=self.out,
-                                        env=self.proc_env,
-                                        cwd=self.workdir,
-                                        preexec_fn=preexec_fn)
-        self.process.wait()
+        if self.can_use_worker():
+            workers = GstValidateWorkers.get_default()
+            worker = workers.acquire(self.command[0], self.proc_env)
+            self.process = GstValidateWorkerTestProcess(worker)
+            self.process.run(self.command[1:], self.proc_env, self.logfile)
+            workers.release(worker, self.options.num_jobs)
+        else:
+            self.process = subprocess.Popen(self.command,
+                                            stderr=self.out,
+                                            stdout=self.out,
+                                            env=self.proc_env,
+                                            cwd=self.workdir,
+                                            preexec_fn=preexec_fn)
+            self.process.wait()
         if self.result is not Result.TIMEOUT:
             if self.process.returncode == 0:
                 self.run_external_checks()
@@ -603,53 +625,370 @@ class GstValidateTCPServer(socketserver.ThreadingMixIn, socketserver.TCPServer):
 
 class GstValidateListener(socketserver.BaseRequestHandler):
 
+    def recv_exactly(self, size):
+        data = b''
+        while len(data) < size:
+            chunk = self.request.recv(size - len(data))
+            if chunk == b'':
+                return b''
+            data += chunk
+
+        return data
+
     def handle(self):
         """Implements BaseRequestHandler handle method"""
         test = None
         while True:
-            raw_len = self.request.recv(4)
+            raw_len = self.recv_exactly(4)
             if raw_len == b'':
                 return
             msglen = struct.unpack('>I', raw_len)[0]
-            msg = self.request.recv(msglen).decode()
+            msg = self.recv_exactly(msglen).decode()
             if msg == '':
                 return
 
-            obj = json.loads(msg)
+            # Messages can be sent one by one or batched in a JSON array
+            objs = json.loads(msg)
+            if not isinstance(objs, list):
+                objs = [objs]
 
-            if test is None:
-                # First message must contain the uuid
-                uuid = obj.get("uuid", None)
-                if uuid is None:
-                    return
-                # Find test from launcher
-                for t in self.server.launcher.tests:
-                    if uuid == t.get_uuid():
-                        test = t
-                        break
+            for obj in objs:
                 if test is None:
-                    self.server.launcher.error(
-                        "Could not find test for UUID %s" % uuid)
-                    return
+                    # First message must contain the uuid
+                    uuid = obj.get("uuid", None)
+                    if uuid is None:
+                        return
+                    # Find test from launcher
+                    for t in self.server.launcher.tests:
+                        if uuid == t.get_uuid():
+                            test = t
+                            break
+                    if test is None:
+                        self.server.launcher.error(
+                            "Could not find test for UUID %s" % uuid)
+                        return
+
+                self.handle_message(test, obj)
+
+    @staticmethod
+    def handle_message(test, obj):
+        obj_type = obj.get("type", '')
+        if obj_type == 'position':
+            test.set_position(obj['position'], obj['duration'],
+                              obj['speed'])
+        elif obj_type == 'buffering':
+            test.set_position(obj['position'], 100)
+        elif obj_type == 'action':
+            test.add_action_execution(obj)
+            # Make sure that action is taken into account when checking if process
+            # is updating
+            test.position += 1
+        elif obj_type == 'action-done':
+            # Make sure that action end is taken into account when checking if process
+            # is updating
+            test.position += 1
+            test.actions_infos[-1]['execution-duration'] = obj['execution-duration']
+        elif obj_type == 'report':
+            test.add_report(obj)
+
+
+class GstValidateReportsRing(Loggable):
+    """
+    Reads the ring file GstValidate writes its messages to when
+    GST_VALIDATE_SERVER is a file:// URI, see gst-validate-report.c
+    """
+    MAGIC = b'GSTVRING'
+    VERSION = 2
+    HEADER = struct.Struct('=8sIIIIiIqqdI4x')
+    RECORD = struct.Struct('=II')
+    RECORD_MESSAGE = 1
+    FLAG_CLOSED = 1 << 0
+    # How often, in seconds, running tests writing to a ring get polled so
+    # that the writer does not lap us
+    POLL_INTERVAL = 0.1
+
+    def __init__(self, path):
+        Loggable.__init__(self)
+        self.path = path
+        self.map = None
+        self.read_offset = 0
+        self.position_seq = 0
+        self.closed = False
+        # Number of bytes of messages the writer overwrote before we could
+        # read them
+        self.lost = 0
+
+    def get_uri(self):
+        return pathlib.Path(os.path.abspath(self.path)).as_uri()
 
-            obj_type = obj.get("type", '')
-            if obj_type == 'position':
-                test.set_position(obj['position'], obj['duration'],
-                                  obj['speed'])
-            elif obj_type == 'buffering':
-                test.set_position(obj['position'], 100)
-            elif obj_type == 'action':
-                test.add_action_execution(obj)
-                # Make sure that action is taken into account when checking if process
-                # is updating
-                test.position += 1
-            elif obj_type == 'action-done':
-                # Make sure that action end is taken into account when checking if process
-                # is updating
-                test.position += 1
-                test.actions_infos[-1]['execution-duration'] = obj['execution-duration']
-            elif obj_type == 'report':
-                test.add_report(obj)
+    def remove(self):
+        """Removes the ring of a previous run, so it is not read again"""
+        self.close()
+        try:
+            os.unlink(self.path)
+        except FileNotFoundError:
+            pass
+
+    def _open(self):
+        try:
+            with open(self.path, 'rb') as f:
+                self.map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        except (OSError, ValueError):
+            return False
+
+        if len(self.map) < self.HEADER.size or \
+                self.map[:len(self.MAGIC)] != self.MAGIC:
+            # Not initialized yet
+            self.close()
+            return False
+
+        return True
+
+    def _overrun(self, write_offset):
+        lost = (write_offset - self.read_offset) & 0xffffffff
+        self.warning("Overrun in %s, %d bytes lost", self.path, lost)
+        self.lost += lost
+        self.read_offset = write_offset
+
+    def close(self):
+        if self.map:
+            self.map.close()
+        self.map = None
+
+    def poll(self, test):
+        """Passes the messages written since the last call to @test"""
+        if self.map is None and not self._open():
+            return
+
+        _, version, capacity, write_offset, flags, position_seq, _, position, \
+            duration, speed, _ = self.HEADER.unpack_from(self.map, 0)
+        if version != self.VERSION:
+            self.error("Unsupported reports ring version %d", version)
+            self.close()
+            return
+
+        self.closed = bool(flags & self.FLAG_CLOSED)
+        if position_seq != self.position_seq and position_seq % 2 == 0 and \
+                self.HEADER.unpack_from(self.map, 0)[5] == position_seq:
+            self.position_seq = position_seq
+            test.set_position(position, duration, speed)
+
+        available = (write_offset - self.read_offset) & 0xffffffff
+        if available > capacity:
+            self._overrun(write_offset)
+            return
+
+        while self.read_offset != write_offset:
+            offset = self.HEADER.size + self.read_offset % capacity
+            size, rtype = self.RECORD.unpack_from(self.map, offset)
+            offset += self.RECORD.size
+            payload = None
+            if rtype == self.RECORD_MESSAGE:
+                payload = self.map[offset:offset + size]
+
+            # The writer might have lapped us while we were copying the
+            # record, in which case what we copied can not be trusted
+            reserved_offset = self.HEADER.unpack_from(self.map, 0)[10]
+            if (reserved_offset - self.read_offset) & 0xffffffff > capacity:
+                self._overrun(self.HEADER.unpack_from(self.map, 0)[3])
+                return
+
+            if payload is not None:
+                obj = json.loads(payload.decode())
+                GstValidateListener.handle_message(test, obj)
+
+            self.read_offset = (self.read_offset + self.RECORD.size +
+                                ((size + 7) & ~7)) & 0xffffffff
+
+
+class GstValidateWorker(Loggable):
+    """
+    A long-lived `gst-validate-1.0 --worker` process running tests one after
+    the other, so they do not each pay for the process startup and the
+    GStreamer and GstValidate initialization
+    """
+    # Environment variables the worker sets for each test, all the other ones
+    # are the same for all the tests running in a given worker
+    TEST_VARIABLES = ["GST_VALIDATE_UUID", "GST_VALIDATE_SERVER",
+                      "GST_VALIDATE_SCENARIO",
+                      "GST_VALIDATE_SCENARIO_FAST_FORWARD",
+                      "GST_VALIDATE_SCENARIO_WAIT_MULTIPLIER",
+                      "GST_VALIDATE_REPORTING_DETAILS"]
+    STRING_CHARS = frozenset(string.ascii_letters + string.digits + '_-+/:.')
+    RESULT_REGEX = re.compile(
+        r'test-done, returncode=\(int\)(-?\d+), reusable=\(boolean\)(\w+);')
+
+    def __init__(self, application, env):
+        Loggable.__init__(self)
+        self.key = self.get_key(application, env)
+        # Unset by the worker once it ran a test whose state it can not drop,
+        # it then exits
+        self.reusable = True
+        worker_env = {var: value for var, value in env.items()
+                      if var not in self.TEST_VARIABLES}
+        self.process = subprocess.Popen([application, "--worker"],
+                                        stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE,
+                                        stderr=subprocess.DEVNULL,
+                                        env=worker_env)
+
+    @classmethod
+    def get_key(cls, application, env):
+        """Tests with the same key can run in the same worker"""
+        return (application, frozenset((var, value) for var, value in env.items()
+                                       if var not in cls.TEST_VARIABLES))
+
+    @classmethod
+    def serialize_string(cls, value):
+        """Quotes @value the way gst_value_serialize() does"""
+        res = '"'
+        for c in value.encode():
+            if chr(c) in cls.STRING_CHARS:
+                res += chr(c)
+            elif c < 0x20 or c >= 0x7f:
+                res += '\\%03o' % c
+            else:
+                res += '\\' + chr(c)
+
+        return res + '"'
+
+    def is_alive(self):
+        return self.process.poll() is None
+
+    def run_test(self, args, env, logfile):
+        """
+        Runs a test and returns its return code, or None if the worker died
+        while running it
+        """
+        test_env = []
+        for var in self.TEST_VARIABLES:
+            if var in env:
+                test_env.append("%s=%s" % (var, env[var]))
+            else:
+                test_env.append(var)
+
+        request = "test, args=(string)<%s>, env=(string)<%s>, logfile=(string)%s;\n" % (
+            ', '.join(self.serialize_string(arg) for arg in args),
+            ', '.join(self.serialize_string(var) for var in test_env),
+            self.serialize_string(logfile))
+        try:
+            self.process.stdin.write(request.encode())
+            self.process.stdin.flush()
+            result = self.process.stdout.readline().decode()
+        except (OSError, ValueError):
+            result = ''
+
+        match = self.RESULT_REGEX.match(result)
+        if not match:
+            return None
+
+        self.reusable = match.group(2) == "true"
+        return int(match.group(1))
+
+    def stop(self):
+        if not self.is_alive():
+            return
+
+        try:
+            # The worker exits once it has read all the tests
+            self.process.stdin.close()
+            self.process.wait(timeout=DEFAULT_TIMEOUT)
+        except (OSError, subprocess.TimeoutExpired):
+            self.process.kill()
+            self.process.wait()
+
+
+class GstValidateWorkerTestProcess(object):
+    """
+    Stands for the process of a test running in a GstValidateWorker, so that
+    the test can be handled as if it was running in its own process
+    """
+
+    def __init__(self, worker):
+        self.worker = worker
+        self.pid = worker.process.pid
+        self.returncode = None
+
+    def run(self, args, env, logfile):
+        returncode = self.worker.run_test(args, env, logfile)
+        if returncode is None:
+            # The worker crashed or was killed, report it as the test result
+            returncode = self.worker.process.wait()
+        self.returncode = returncode
+
+    def poll(self):
+        return self.returncode
+
+    def wait(self):
+        while self.returncode is None:
+            time.sleep(0.05)
+
+        return self.returncode
+
+    def communicate(self):
+        self.wait()
+
+        return None, None
+
+    def send_signal(self, sig):
+        if self.returncode is None:
+            self.worker.process.send_signal(sig)
+
+
+class GstValidateWorkers(Loggable):
+    """The GstValidateWorker that are not running any test"""
+    __instance = None
+
+    def __init__(self):
+        Loggable.__init__(self)
+        self.lock = threading.Lock()
+        self.idle = []
+
+    @classmethod
+    def get_default(cls):
+        if not cls.__instance:
+            cls.__instance = GstValidateWorkers()
+
+        return cls.__instance
+
+    def acquire(self, application, env):
+        key = GstValidateWorker.get_key(application, env)
+        with self.lock:
+            for worker in list(self.idle):
+                if worker.key != key:
+                    continue
+
+                self.idle.remove(worker)
+                if worker.is_alive():
+                    return worker
+
+        self.debug("Starting new worker for %s", application)
+        return GstValidateWorker(application, env)
+
+    def release(self, worker, max_idle):
+        if not worker.reusable:
+            worker.stop()
+            return
+
+        if not worker.is_alive():
+            return
+
+        with self.lock:
+            self.idle.append(worker)
+            # Keep the most recently used ones
+            stale = self.idle[:-max_idle]
+            self.idle = self.idle[-max_idle:]
+
+        for worker in stale:
+            worker.stop()
+
+    def stop(self):
+        with self.lock:
+            workers = self.idle
+            self.idle = []
+
+        for worker in workers:
+            worker.stop()
 
 
 class GstValidateTest(Test):
@@ -748,6 +1087,9 @@ class GstValidateTest(Test):
         return self.position
 
     def get_current_value(self):
+        if self.reports_ring:
+            self.reports_ring.poll(self)
+
         if self.scenario:
             if self._sent_eos_time is not None:
                 t = time.time()
@@ -771,6 +1113,12 @@ class GstValidateTest(Test):
 
         subproc_env["GST_VALIDATE_UUID"] = self.get_uuid()
 
+        if self.options.reports_ring:
+            self.reports_ring = GstValidateReportsRing(
+                self.logfile + '.reports')
+            self.reports_ring.remove()
+            subproc_env["GST_VALIDATE_SERVER"] = self.reports_ring.get_uri()
+
         if 'GST_DEBUG' in os.environ and not self.options.redirect_logs:
             gstlogsfile = self.logfile + '.gstdebug'
             self.extra_logfiles.append(gstlogsfile)
@@ -799,6 +1147,9 @@ class GstValidateTest(Test):
     def clean(self):
         Test.clean(self)
         self._sent_eos_time = None
+        if getattr(self, 'reports_ring', None):
+            self.reports_ring.close()
+        self.reports_ring = None
         self.reports = []
         self.position = -1
         self.media_duration = -1
@@ -892,9 +1243,20 @@ class GstValidateTest(Test):
         return result, msg
 
     def check_results(self):
+        if self.reports_ring:
+            # Get what was written since the last poll, the process is done
+            self.reports_ring.poll(self)
+            self.reports_ring.close()
+
         if self.result in [Result.FAILED, self.result is Result.PASSED]:
             return
 
+        if self.reports_ring and self.reports_ring.lost:
+            self.set_result(Result.FAILED,
+                            "Reports ring overrun, %d bytes of messages lost"
+                            % self.reports_ring.lost)
+            return
+
         for report in self.reports:
             if report.get('issue-id') == 'runtime::missing-plugin':
                 self.set_result(Result.SKIPPED, "%s\n%s" % (report['summary'],
@@ -1728,9 +2090,13 @@ class _TestsLauncher(Loggable):
 
     def test_wait(self):
         while True:
-            # Check process every second for timeout
+            # Check process every second for timeout, more often when
+            # reports have to be drained from a ring before it overruns
+            timeout = 1
+            if any(getattr(test, 'reports_ring', None) for test in self.jobs):
+                timeout = GstValidateReportsRing.POLL_INTERVAL
             try:
-                self.queue.get(timeout=1)
+                self.queue.get(timeout=timeout)
             except queue.Empty:
                 pass
 
@@ -1814,6 +2180,7 @@ class _TestsLauncher(Loggable):
     def clean_tests(self):
         for test in self.tests:
             test.clean()
+        GstValidateWorkers.get_default().stop()
         self._stop_server()
 
     def run_tests(self):
@@ -199,6 +199,8 @@ class LauncherConfig(Loggable):
         self.gdb = False
         self.no_display = False
         self.xunit_file = None
+        self.reports_ring = False
+        self.use_workers = False
         self.main_dir = utils.DEFAULT_MAIN_DIR
         self.output_dir = None
         self.logsdir = None
@@ -466,6 +468,19 @@ class LauncherConfig(Loggable):
                             " in a virtual framebuffer."
                             " Note that it is currently implemented only"
                             " for the X  server thanks to Xvfb (which is requeried in that case)")
+        parser.add_argument("--reports-ring", dest="reports_ring",
+                            action="store_true",
+                            help="Make the tests write their reports, positions and"
+                            " actions in a memory mapped file next to their logs"
+                            " instead of sending them to the launcher over TCP."
+                            " The file stays readable after a crash.")
+        parser.add_argument("--use-workers", dest="use_workers",
+                            action="store_true",
+                            help="Run the gst-validate-1.0 tests in long-lived"
+                            " worker processes, each of them running many tests"
+                            " one after the other, instead of starting a new"
+                            " process for each test. Ignored with --gdb,"
+                            " --valgrind and when the logs are redirected.")
         parser.add_argument('--xunit-file', dest='xunit_file',
                             action='store', metavar="FILE",
                             help=("Path to xml file to store the xunit report in."))
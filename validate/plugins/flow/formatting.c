@@ -143,108 +143,152 @@ validate_flow_format_caps (const GstCaps * caps,
 }
 
 
-static gchar *
-buffer_get_flags_string (GstBuffer * buffer)
+/* Equivalent to format_time() for valid times, without going through the
+ * printf machinery. */
+static void
+append_time (GString * dest, GstClockTime time)
+{
+  gchar str[32], *p = str + sizeof (str);
+  guint64 nsecs = time % GST_SECOND;
+  guint64 secs = time / GST_SECOND;
+  guint hours = (guint) (secs / 3600);
+  gint i;
+
+  for (i = 0; i < 9; i++, nsecs /= 10)
+    *--p = '0' + nsecs % 10;
+  *--p = '.';
+  *--p = '0' + secs % 10;
+  *--p = '0' + (secs % 60) / 10;
+  *--p = ':';
+  *--p = '0' + (secs / 60) % 10;
+  *--p = '0' + ((secs / 60) % 60) / 10;
+  *--p = ':';
+  do {
+    *--p = '0' + hours % 10;
+    hours /= 10;
+  } while (hours);
+
+  g_string_append_len (dest, p, str + sizeof (str) - p);
+}
+
+static void
+append_separator (GString * dest, gsize start)
 {
-  GFlagsClass *flags_class =
-      G_FLAGS_CLASS (g_type_class_ref (gst_buffer_flags_get_type ()));
+  if (dest->len > start)
+    g_string_append_len (dest, ", ", 2);
+}
+
+static void
+buffer_append_flags (GString * dest, gsize start, GstBuffer * buffer)
+{
+  static GFlagsClass *flags_class = NULL;
   GstBufferFlags flags = GST_BUFFER_FLAGS (buffer);
-  GString *string = NULL;
+  gboolean first = TRUE;
+
+  if (g_once_init_enter (&flags_class))
+    g_once_init_leave (&flags_class,
+        G_FLAGS_CLASS (g_type_class_ref (gst_buffer_flags_get_type ())));
 
   while (1) {
     GFlagsValue *value = g_flags_get_first_value (flags_class, flags);
     if (!value)
       break;
 
-    if (string == NULL)
-      string = g_string_new (NULL);
-    else
-      g_string_append (string, " ");
-
-    g_string_append (string, value->value_nick);
+    if (first) {
+      append_separator (dest, start);
+      g_string_append_len (dest, "flags=", 6);
+    } else {
+      g_string_append_c (dest, ' ');
+    }
+    g_string_append (dest, value->value_nick);
     flags &= ~value->value;
+    first = FALSE;
   }
-
-  return (string != NULL) ? g_string_free (string, FALSE) : NULL;
 }
 
-/* Returns a newly-allocated string describing the metas on this buffer, or NULL */
-static gchar *
-buffer_get_meta_string (GstBuffer * buffer)
+static void
+buffer_append_metas (GString * dest, gsize start, GstBuffer * buffer)
 {
   gpointer state = NULL;
   GstMeta *meta;
-  GString *s = NULL;
+  gboolean first = TRUE;
 
   while ((meta = gst_buffer_iterate_meta (buffer, &state))) {
-    const gchar *desc = g_type_name (meta->info->type);
-
-    if (s == NULL)
-      s = g_string_new (NULL);
-    else
-      g_string_append (s, ", ");
-
-    g_string_append (s, desc);
+    if (first) {
+      append_separator (dest, start);
+      g_string_append_len (dest, "meta=", 5);
+    } else {
+      g_string_append_len (dest, ", ", 2);
+    }
+    g_string_append (dest, g_type_name (meta->info->type));
+    first = FALSE;
   }
-
-  return (s != NULL) ? g_string_free (s, FALSE) : NULL;
 }
 
-gchar *
-validate_flow_format_buffer (GstBuffer * buffer)
+/**
+ * validate_flow_append_buffer:
+ * @dest: the string to append to
+ * @buffer: the buffer to describe
+ *
+ * Appends the description of @buffer, as returned by
+ * validate_flow_format_buffer(), to @dest without allocating anything
+ * besides growing @dest.
+ */
+void
+validate_flow_append_buffer (GString * dest, GstBuffer * buffer)
 {
-  gchar *flags_str, *meta_str, *buffer_str;
-  gchar *buffer_parts[6];
-  int buffer_parts_index = 0;
+  gsize start = dest->len;
 
   if (GST_CLOCK_TIME_IS_VALID (buffer->dts)) {
-    gchar time_str[32];
-    format_time (time_str, buffer->dts);
-    buffer_parts[buffer_parts_index++] = g_strdup_printf ("dts=%s", time_str);
+    g_string_append_len (dest, "dts=", 4);
+    append_time (dest, buffer->dts);
   }
 
   if (GST_CLOCK_TIME_IS_VALID (buffer->pts)) {
-    gchar time_str[32];
-    format_time (time_str, buffer->pts);
-    buffer_parts[buffer_parts_index++] = g_strdup_printf ("pts=%s", time_str);
+    append_separator (dest, start);
+    g_string_append_len (dest, "pts=", 4);
+    append_time (dest, buffer->pts);
   }
 
   if (GST_CLOCK_TIME_IS_VALID (buffer->duration)) {
-    gchar time_str[32];
-    format_time (time_str, buffer->duration);
-    buffer_parts[buffer_parts_index++] = g_strdup_printf ("dur=%s", time_str);
+    append_separator (dest, start);
+    g_string_append_len (dest, "dur=", 4);
+    append_time (dest, buffer->duration);
   }
 
-  flags_str = buffer_get_flags_string (buffer);
-  if (flags_str) {
-    buffer_parts[buffer_parts_index++] =
-        g_strdup_printf ("flags=%s", flags_str);
-  }
+  buffer_append_flags (dest, start, buffer);
+  buffer_append_metas (dest, start, buffer);
 
-  meta_str = buffer_get_meta_string (buffer);
-  if (meta_str)
-    buffer_parts[buffer_parts_index++] = g_strdup_printf ("meta=%s", meta_str);
+  if (dest->len == start)
+    g_string_append (dest, "(empty)");
+}
 
-  buffer_parts[buffer_parts_index] = NULL;
-  buffer_str =
-      buffer_parts_index > 0 ? g_strjoinv (", ",
-      buffer_parts) : g_strdup ("(empty)");
+gchar *
+validate_flow_format_buffer (GstBuffer * buffer)
+{
+  GString *string = g_string_new (NULL);
 
-  g_free (meta_str);
-  g_free (flags_str);
-  while (buffer_parts_index > 0)
-    g_free (buffer_parts[--buffer_parts_index]);
+  validate_flow_append_buffer (string, buffer);
 
-  return buffer_str;
+  return g_string_free (string, FALSE);
 }
 
-gchar *
-validate_flow_format_event (GstEvent * event,
+/**
+ * validate_flow_append_event:
+ * @dest: the string to append to
+ * @event: the event to describe
+ * @caps_properties: (nullable): the caps fields to print
+ * @ignored_event_fields: fields to leave out, per event type
+ *
+ * Appends the description of @event, as returned by
+ * validate_flow_format_event(), to @dest.
+ */
+void
+validate_flow_append_event (GString * dest, GstEvent * event,
     const gchar * const *caps_properties, GstStructure * ignored_event_fields)
 {
   const gchar *event_type;
   gchar *structure_string;
-  gchar *event_string;
   const gchar *ignored_fields;
 
   event_type = gst_event_type_get_name (GST_EVENT_TYPE (event));
@@ -278,7 +322,20 @@ validate_flow_format_event (GstEvent * event,
     gst_structure_free (printable);
   }
 
-  event_string = g_strdup_printf ("%s: %s", event_type, structure_string);
+  g_string_append (dest, event_type);
+  g_string_append_len (dest, ": ", 2);
+  g_string_append (dest, structure_string);
   g_free (structure_string);
-  return event_string;
+}
+
+gchar *
+validate_flow_format_event (GstEvent * event,
+    const gchar * const *caps_properties, GstStructure * ignored_event_fields)
+{
+  GString *string = g_string_new (NULL);
+
+  validate_flow_append_event (string, event, caps_properties,
+      ignored_event_fields);
+
+  return g_string_free (string, FALSE);
 }
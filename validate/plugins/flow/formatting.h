@@ -33,6 +33,10 @@ gchar* validate_flow_format_caps (const GstCaps* caps, const gchar * const *keys
 
 gchar* validate_flow_format_buffer (GstBuffer *buffer);
 
+void validate_flow_append_buffer (GString *dest, GstBuffer *buffer);
+
 gchar* validate_flow_format_event (GstEvent *event, const gchar * const *caps_properties, GstStructure *ignored_event_fields);
 
+void validate_flow_append_event (GString *dest, GstEvent *event, const gchar * const *caps_properties, GstStructure *ignored_event_fields);
+
 #endif // __GST_VALIDATE_FLOW_FORMATTING_H__
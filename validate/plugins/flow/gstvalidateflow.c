@@ -36,10 +36,14 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 
 #define VALIDATE_FLOW_MISMATCH g_quark_from_static_string ("validateflow::mismatch")
 #define VALIDATE_FLOW_NOT_ATTACHED g_quark_from_static_string ("validateflow::not-attached")
 
+/* Lines are accumulated in memory and written out in blocks of this size */
+#define VALIDATE_FLOW_OUTPUT_BLOCK_SIZE (64 * 1024)
+
 typedef enum _ValidateFlowMode
 {
   VALIDATE_FLOW_MODE_WRITING_EXPECTATIONS,
@@ -68,6 +72,27 @@ typedef struct _ValidateFlowOverride
   gchar *output_file_path;
   FILE *output_file;
   GMutex output_file_mutex;
+  /* Pending output, protected by output_file_mutex. Every line is formatted
+   * straight into it and it is written out once it grows larger than
+   * VALIDATE_FLOW_OUTPUT_BLOCK_SIZE. */
+  GString *output_block;
+
+  /* When writing actual results, every line is checked against the mapped
+   * expectations file as soon as it is produced. Protected by
+   * output_file_mutex. */
+  GMappedFile *expectations;
+  gsize expected_offset;
+  gsize line_index;
+  gboolean mismatch_found;
+  gchar *mismatch_expected;
+  gchar *mismatch_actual;
+  GstClockTime mismatch_position;
+  gboolean abort_on_mismatch;
+
+  /* Stream time of the last buffer or segment that went through the pad,
+   * protected by output_file_mutex. */
+  GstSegment segment;
+  GstClockTime position;
 
 } ValidateFlowOverride;
 
@@ -89,6 +114,11 @@ G_DEFINE_TYPE (ValidateFlowOverride, validate_flow_override,
 void
 validate_flow_override_init (ValidateFlowOverride * self)
 {
+  self->output_block =
+      g_string_sized_new (VALIDATE_FLOW_OUTPUT_BLOCK_SIZE + 4096);
+  gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
+  self->position = GST_CLOCK_TIME_NONE;
+  self->mismatch_position = GST_CLOCK_TIME_NONE;
 }
 
 void
@@ -116,44 +146,250 @@ validate_flow_override_class_init (ValidateFlowOverrideClass * klass)
           GST_VALIDATE_REPORT_LEVEL_CRITICAL));
 }
 
+/* Must be called with output_file_mutex held */
 static void
-validate_flow_override_vprintf (ValidateFlowOverride * flow, const char *format,
-    va_list ap)
+validate_flow_override_flush_unlocked (ValidateFlowOverride * flow)
 {
-  g_mutex_lock (&flow->output_file_mutex);
-  if (!flow->error_writing_file && vfprintf (flow->output_file, format, ap) < 0) {
+  GString *block = flow->output_block;
+
+  if (!flow->error_writing_file && flow->output_file && block->len > 0 &&
+      fwrite (block->str, 1, block->len, flow->output_file) < block->len) {
     GST_ERROR_OBJECT (flow, "Writing to file %s failed",
         flow->output_file_path);
     flow->error_writing_file = TRUE;
   }
+  g_string_truncate (block, 0);
+}
+
+static void
+validate_flow_override_flush (ValidateFlowOverride * flow)
+{
+  g_mutex_lock (&flow->output_file_mutex);
+  if (flow->output_file) {
+    validate_flow_override_flush_unlocked (flow);
+    if (!flow->error_writing_file && fflush (flow->output_file) != 0) {
+      GST_ERROR_OBJECT (flow, "Writing to file %s failed",
+          flow->output_file_path);
+      flow->error_writing_file = TRUE;
+    }
+  }
+  g_mutex_unlock (&flow->output_file_mutex);
+}
+
+/* Returns the expected line at @offset, or NULL past the end of the file */
+static const gchar *
+validate_flow_override_expected_line (ValidateFlowOverride * flow,
+    gsize offset, gsize * line_length)
+{
+  const gchar *data = g_mapped_file_get_contents (flow->expectations);
+  gsize length = g_mapped_file_get_length (flow->expectations);
+  const gchar *line_end;
+
+  if (offset >= length)
+    return NULL;
+
+  line_end = memchr (data + offset, '\n', length - offset);
+  *line_length = (line_end ? line_end : data + length) - (data + offset);
+  return data + offset;
+}
+
+static gchar *
+_line_to_show (const gchar * line, gsize length, const gchar * next_line,
+    gsize next_length)
+{
+  if (line == NULL) {
+    return g_strdup ("<nothing>");
+  } else if (length == 0) {
+    if (next_line != NULL)
+      /* skip blank lines for reporting purposes (e.g. before CHECKPOINT) */
+      return g_strndup (next_line, next_length);
+    else
+      /* last blank line in the file */
+      return g_strdup ("<nothing>");
+  } else {
+    return g_strndup (line, length);
+  }
+}
+
+/* @next_expected and @next_actual are the lines following @expected and
+ * @actual, if already known, and are shown in place of blank lines. */
+static void
+validate_flow_override_set_mismatch_unlocked (ValidateFlowOverride * flow,
+    const gchar * expected, gsize expected_length,
+    const gchar * next_expected, gsize next_expected_length,
+    const gchar * actual, gsize actual_length,
+    const gchar * next_actual, gsize next_actual_length)
+{
+  flow->mismatch_found = TRUE;
+  flow->mismatch_position = flow->position;
+  flow->mismatch_expected = _line_to_show (expected, expected_length,
+      next_expected, next_expected_length);
+  flow->mismatch_actual = _line_to_show (actual, actual_length,
+      next_actual, next_actual_length);
+}
+
+/* Compares the lines written to the output block since @start with the
+ * expectations. Returns TRUE if this is where the first mismatch is. Must be
+ * called with output_file_mutex held. */
+static gboolean
+validate_flow_override_check_unlocked (ValidateFlowOverride * flow,
+    gsize start)
+{
+  const gchar *actual = flow->output_block->str + start;
+  const gchar *end = flow->output_block->str + flow->output_block->len;
+
+  if (!flow->expectations || flow->mismatch_found)
+    return FALSE;
+
+  while (actual < end) {
+    const gchar *actual_end = memchr (actual, '\n', end - actual);
+    gsize actual_length = (actual_end ? actual_end : end) - actual;
+    gsize expected_length = 0;
+    const gchar *expected = validate_flow_override_expected_line (flow,
+        flow->expected_offset, &expected_length);
+
+    if (!expected || expected_length != actual_length
+        || memcmp (expected, actual, actual_length)) {
+      const gchar *next_actual = NULL, *next_expected = NULL;
+      gsize next_actual_length = 0, next_expected_length = 0;
+
+      if (expected)
+        next_expected = validate_flow_override_expected_line (flow,
+            flow->expected_offset + expected_length + 1,
+            &next_expected_length);
+
+      if (actual_end && actual_end + 1 < end) {
+        const gchar *next_end;
+
+        next_actual = actual_end + 1;
+        next_end = memchr (next_actual, '\n', end - next_actual);
+        next_actual_length = (next_end ? next_end : end) - next_actual;
+      }
+
+      validate_flow_override_set_mismatch_unlocked (flow, expected,
+          expected_length, next_expected, next_expected_length, actual,
+          actual_length, next_actual, next_actual_length);
+      return TRUE;
+    }
+
+    flow->expected_offset += expected_length + 1;
+    flow->line_index++;
+    actual += actual_length + 1;
+  }
+
+  return FALSE;
+}
+
+/* Must be called with output_file_mutex held, after appending lines at
+ * @start. Returns TRUE if they do not match the expectations. */
+static gboolean
+validate_flow_override_lines_written_unlocked (ValidateFlowOverride * flow,
+    gsize start)
+{
+  gboolean mismatch = validate_flow_override_check_unlocked (flow, start);
+
+  if (flow->output_block->len >= VALIDATE_FLOW_OUTPUT_BLOCK_SIZE)
+    validate_flow_override_flush_unlocked (flow);
+
+  return mismatch;
+}
+
+static void
+validate_flow_override_report_mismatch (ValidateFlowOverride * flow,
+    GstElement * pipeline)
+{
+  /* The position is the one of the data that produced the mismatching line,
+   * querying the pipeline from the streaming thread could deadlock against
+   * state changes and seeks. */
+  GST_VALIDATE_REPORT (flow, VALIDATE_FLOW_MISMATCH,
+      "Mismatch error in pad %s, line %" G_GSIZE_FORMAT ", stream position %"
+      GST_TIME_FORMAT ". Expected:\n%s\nActual:\n%s\n", flow->pad_name,
+      flow->line_index + 1, GST_TIME_ARGS (flow->mismatch_position),
+      flow->mismatch_expected, flow->mismatch_actual);
+
+  if (flow->abort_on_mismatch && pipeline) {
+    GError *err = g_error_new (GST_STREAM_ERROR, GST_STREAM_ERROR_FAILED,
+        "Flow of pad %s does not match its expectations", flow->pad_name);
+
+    gst_element_post_message (pipeline,
+        gst_message_new_error (GST_OBJECT (pipeline), err,
+            flow->expectations_file_path));
+    g_error_free (err);
+  }
+}
+
+static void
+validate_flow_override_vprintf (ValidateFlowOverride * flow,
+    GstElement * pipeline, const char *format, va_list ap)
+{
+  gboolean mismatch = FALSE;
+
+  g_mutex_lock (&flow->output_file_mutex);
+  if (!flow->error_writing_file) {
+    gsize start = flow->output_block->len;
+
+    g_string_append_vprintf (flow->output_block, format, ap);
+    mismatch = validate_flow_override_lines_written_unlocked (flow, start);
+  }
   g_mutex_unlock (&flow->output_file_mutex);
+
+  if (mismatch)
+    validate_flow_override_report_mismatch (flow, pipeline);
 }
 
 static void
-validate_flow_override_printf (ValidateFlowOverride * flow, const char *format,
-    ...)
+validate_flow_override_printf (ValidateFlowOverride * flow,
+    GstElement * pipeline, const char *format, ...)
 {
   va_list ap;
   va_start (ap, format);
-  validate_flow_override_vprintf (flow, format, ap);
+  validate_flow_override_vprintf (flow, pipeline, format, ap);
   va_end (ap);
 }
 
+/* Terminates the line started at @start and releases output_file_mutex */
+static void
+validate_flow_override_end_line_and_unlock (ValidateFlowOverride * flow,
+    GstValidateMonitor * pad_monitor, gsize start)
+{
+  gboolean mismatch;
+
+  g_string_append_c (flow->output_block, '\n');
+  mismatch = validate_flow_override_lines_written_unlocked (flow, start);
+  g_mutex_unlock (&flow->output_file_mutex);
+
+  if (mismatch) {
+    GstPipeline *pipeline = gst_validate_monitor_get_pipeline (pad_monitor);
+
+    validate_flow_override_report_mismatch (flow, GST_ELEMENT (pipeline));
+    if (pipeline)
+      gst_object_unref (pipeline);
+  }
+}
+
 static void
 validate_flow_override_event_handler (GstValidateOverride * override,
     GstValidateMonitor * pad_monitor, GstEvent * event)
 {
   ValidateFlowOverride *flow = VALIDATE_FLOW_OVERRIDE (override);
-  gchar *event_string;
+  gsize start;
 
   if (flow->error_writing_file)
     return;
 
-  event_string = validate_flow_format_event (event,
+  g_mutex_lock (&flow->output_file_mutex);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+    gst_event_copy_segment (event, &flow->segment);
+    flow->position = flow->segment.format == GST_FORMAT_TIME ?
+        flow->segment.time : GST_CLOCK_TIME_NONE;
+  }
+
+  start = flow->output_block->len;
+  g_string_append_len (flow->output_block, "event ", 6);
+  validate_flow_append_event (flow->output_block, event,
       (const gchar * const *) flow->caps_properties,
       flow->ignored_event_fields);
-  validate_flow_override_printf (flow, "event %s\n", event_string);
-  g_free (event_string);
+  validate_flow_override_end_line_and_unlock (flow, pad_monitor, start);
 }
 
 static void
@@ -161,14 +397,26 @@ validate_flow_override_buffer_handler (GstValidateOverride * override,
     GstValidateMonitor * pad_monitor, GstBuffer * buffer)
 {
   ValidateFlowOverride *flow = VALIDATE_FLOW_OVERRIDE (override);
-  gchar *buffer_str;
+  gsize start;
+
+  if (flow->error_writing_file)
+    return;
+
+  g_mutex_lock (&flow->output_file_mutex);
+  if (flow->segment.format == GST_FORMAT_TIME
+      && GST_BUFFER_PTS_IS_VALID (buffer))
+    flow->position = gst_segment_to_stream_time (&flow->segment,
+        GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
 
-  if (flow->error_writing_file || !flow->record_buffers)
+  if (!flow->record_buffers) {
+    g_mutex_unlock (&flow->output_file_mutex);
     return;
+  }
 
-  buffer_str = validate_flow_format_buffer (buffer);
-  validate_flow_override_printf (flow, "buffer: %s\n", buffer_str);
-  g_free (buffer_str);
+  start = flow->output_block->len;
+  g_string_append_len (flow->output_block, "buffer: ", 8);
+  validate_flow_append_buffer (flow->output_block, buffer);
+  validate_flow_override_end_line_and_unlock (flow, pad_monitor, start);
 }
 
 static gchar **
@@ -218,6 +466,12 @@ validate_flow_override_new (GstStructure * config)
   flow->record_buffers = FALSE;
   gst_structure_get_boolean (config, "record-buffers", &flow->record_buffers);
 
+  /* abort-on-mismatch: Whether to post an error on the pipeline, stopping the
+   * test, as soon as the flow deviates from the expectations. */
+  flow->abort_on_mismatch = FALSE;
+  gst_structure_get_boolean (config, "abort-on-mismatch",
+      &flow->abort_on_mismatch);
+
   /* caps-properties: Caps events can include many dfferent properties, but
    * many of these may be irrelevant for some tests. If this option is set,
    * only the listed properties will be written to the expectation log. */
@@ -275,8 +529,16 @@ validate_flow_override_new (GstStructure * config)
   }
 
   if (g_file_test (flow->expectations_file_path, G_FILE_TEST_EXISTS)) {
+    GError *error = NULL;
+
     flow->mode = VALIDATE_FLOW_MODE_WRITING_ACTUAL_RESULTS;
     flow->output_file_path = g_strdup (flow->actual_results_file_path);
+    flow->expectations =
+        g_mapped_file_new (flow->expectations_file_path, FALSE, &error);
+    if (error) {
+      g_error ("Failed to open expectations file: %s Reason: %s",
+          flow->expectations_file_path, error->message);
+    }
   } else {
     flow->mode = VALIDATE_FLOW_MODE_WRITING_EXPECTATIONS;
     flow->output_file_path = g_strdup (flow->expectations_file_path);
@@ -351,47 +613,40 @@ run_diff (const gchar * expected_file, const gchar * actual_file)
   g_free (stdout_text);
 }
 
-static const gchar *
-_line_to_show (gchar ** lines, gsize i)
-{
-  if (lines[i] == NULL) {
-    return "<nothing>";
-  } else if (*lines[i] == '\0') {
-    if (lines[i + 1] != NULL)
-      /* skip blank lines for reporting purposes (e.g. before CHECKPOINT) */
-      return lines[i + 1];
-    else
-      /* last blank line in the file */
-      return "<nothing>";
-  } else {
-    return lines[i];
-  }
-}
-
-static void
-show_mismatch_error (ValidateFlowOverride * flow, gchar ** lines_expected,
-    gchar ** lines_actual, gsize line_index)
-{
-  const gchar *line_expected = _line_to_show (lines_expected, line_index);
-  const gchar *line_actual = _line_to_show (lines_actual, line_index);
-
-  GST_VALIDATE_REPORT (flow, VALIDATE_FLOW_MISMATCH,
-      "Mismatch error in pad %s, line %" G_GSIZE_FORMAT
-      ". Expected:\n%s\nActual:\n%s\n", flow->pad_name, line_index + 1,
-      line_expected, line_actual);
-
-  run_diff (flow->expectations_file_path, flow->actual_results_file_path);
-}
-
 static void
 runner_stopping (GstValidateRunner * runner, ValidateFlowOverride * flow)
 {
-  gchar **lines_expected, **lines_actual;
-  gsize i = 0;
+  gboolean mismatch, missing_lines = FALSE;
 
+  validate_flow_override_flush (flow);
+
+  g_mutex_lock (&flow->output_file_mutex);
   fclose (flow->output_file);
   flow->output_file = NULL;
 
+  /* All the actual lines were checked as they were produced, only the
+   * expected lines that never came remain to be checked. */
+  if (flow->expectations && flow->was_attached && !flow->mismatch_found) {
+    gsize expected_length = 0;
+    const gchar *expected = validate_flow_override_expected_line (flow,
+        flow->expected_offset, &expected_length);
+
+    if (expected) {
+      gsize next_length = 0;
+      const gchar *next = validate_flow_override_expected_line (flow,
+          flow->expected_offset + expected_length + 1, &next_length);
+
+      validate_flow_override_set_mismatch_unlocked (flow, expected,
+          expected_length, next, next_length, NULL, 0, NULL, 0);
+      missing_lines = TRUE;
+    }
+  }
+  mismatch = flow->mismatch_found;
+  g_mutex_unlock (&flow->output_file_mutex);
+
+  if (missing_lines)
+    validate_flow_override_report_mismatch (flow, NULL);
+
   if (!flow->was_attached) {
     GST_VALIDATE_REPORT (flow, VALIDATE_FLOW_NOT_ATTACHED,
         "The test ended without the pad ever being attached: %s",
@@ -402,48 +657,11 @@ runner_stopping (GstValidateRunner * runner, ValidateFlowOverride * flow)
   if (flow->mode == VALIDATE_FLOW_MODE_WRITING_EXPECTATIONS)
     return;
 
-  {
-    gchar *contents;
-    GError *error = NULL;
-    g_file_get_contents (flow->expectations_file_path, &contents, NULL, &error);
-    if (error) {
-      g_error ("Failed to open expectations file: %s Reason: %s",
-          flow->expectations_file_path, error->message);
-    }
-    lines_expected = g_strsplit (contents, "\n", 0);
-  }
-
-  {
-    gchar *contents;
-    GError *error = NULL;
-    g_file_get_contents (flow->actual_results_file_path, &contents, NULL,
-        &error);
-    if (error) {
-      g_error ("Failed to open actual results file: %s Reason: %s",
-          flow->actual_results_file_path, error->message);
-    }
-    lines_actual = g_strsplit (contents, "\n", 0);
-  }
-
   gst_validate_printf (flow, "Checking that flow %s matches expected flow %s\n",
       flow->expectations_file_path, flow->actual_results_file_path);
 
-  for (i = 0; lines_expected[i] && lines_actual[i]; i++) {
-    if (g_strcmp0 (lines_expected[i], lines_actual[i])) {
-      show_mismatch_error (flow, lines_expected, lines_actual, i);
-      goto stop;
-    }
-  }
-
-  if (!lines_expected[i] && lines_actual[i]) {
-    show_mismatch_error (flow, lines_expected, lines_actual, i);
-  } else if (lines_expected[i] && !lines_actual[i]) {
-    show_mismatch_error (flow, lines_expected, lines_actual, i);
-  }
-
-stop:
-  g_strfreev (lines_expected);
-  g_strfreev (lines_actual);
+  if (mismatch)
+    run_diff (flow->expectations_file_path, flow->actual_results_file_path);
 }
 
 static void
@@ -457,8 +675,15 @@ validate_flow_override_finalize (GObject * object)
   g_free (flow->expectations_dir);
   g_free (flow->expectations_file_path);
   g_free (flow->output_file_path);
-  if (flow->output_file)
+  if (flow->output_file) {
+    validate_flow_override_flush (flow);
     fclose (flow->output_file);
+  }
+  g_string_free (flow->output_block, TRUE);
+  if (flow->expectations)
+    g_mapped_file_unref (flow->expectations);
+  g_free (flow->mismatch_expected);
+  g_free (flow->mismatch_actual);
   if (flow->caps_properties) {
     gchar **str_pointer;
     for (str_pointer = flow->caps_properties; *str_pointer != NULL;
@@ -476,6 +701,7 @@ static gboolean
 _execute_checkpoint (GstValidateScenario * scenario, GstValidateAction * action)
 {
   GList *i;
+  GstElement *pipeline = gst_validate_scenario_get_pipeline (scenario);
   gchar *checkpoint_name =
       g_strdup (gst_structure_get_string (action->structure, "text"));
 
@@ -483,12 +709,14 @@ _execute_checkpoint (GstValidateScenario * scenario, GstValidateAction * action)
     ValidateFlowOverride *flow = (ValidateFlowOverride *) i->data;
 
     if (checkpoint_name)
-      validate_flow_override_printf (flow, "\nCHECKPOINT: %s\n\n",
+      validate_flow_override_printf (flow, pipeline, "\nCHECKPOINT: %s\n\n",
           checkpoint_name);
     else
-      validate_flow_override_printf (flow, "\nCHECKPOINT\n\n");
+      validate_flow_override_printf (flow, pipeline, "\nCHECKPOINT\n\n");
   }
 
+  if (pipeline)
+    gst_object_unref (pipeline);
   g_free (checkpoint_name);
   return TRUE;
 }
@@ -69,6 +69,19 @@
  *    in the stream (after a seek or a change in the video format for example)
  *    a check is done. And if recurrence == 0, images will be checked only after
  *    such discontinuity
+ *  - reference-cache-size: (default 256): The maximum amount of memory, in
+ *    MiB, used to keep converted reference images around, so that they
+ *    are not loaded and converted again each time they are compared
+ *  - async-dump: (default false): Save the frames from a background thread
+ *    instead of the streaming thread, so that encoding and writing the
+ *    image files does not change the timing of the pipeline. Frames are
+ *    still converted in the streaming thread, into pooled buffers.
+ *  - dump-queue-size: (default 8): The maximum number of frames waiting to
+ *    be saved when using async-dump
+ *  - dump-drop-policy: (default "block"): What to do with a frame to dump
+ *    when the queue is full. "block" waits for a frame to be saved,
+ *    "drop-new" drops the new frame and "drop-old" drops the oldest queued
+ *    frame. Dropped frames are not checked against the reference images.
  *  - is-config: Property letting the plugin know that the config line is exclusively
  *    used to configure the following configuration expressions. In practice this
  *    means that it will change the default values for the other configuration
@@ -141,13 +154,34 @@ typedef struct
 
 } ValidateSsimOverrideClass;
 
+#define DEFAULT_DUMP_QUEUE_SIZE 8
+
+typedef enum
+{
+  SSIM_DUMP_POLICY_BLOCK,
+  SSIM_DUMP_POLICY_DROP_NEW,
+  SSIM_DUMP_POLICY_DROP_OLD,
+} SSimDumpPolicy;
+
 typedef struct
 {
   gchar *path;
   GstClockTime position;
   guint width, height;
+
+  /* Set when a frame dumped asynchronously could not be saved */
+  gboolean failed;
 } Frame;
 
+typedef struct
+{
+  GstVideoFrame frame;
+  gchar *outname;
+
+  /* Index of the frame in priv->frames */
+  guint index;
+} SSimDump;
+
 static void
 free_frame (Frame * frame)
 {
@@ -177,6 +211,23 @@ struct _ValidateSsimOverridePrivate
   const gchar *ext;
   GstVideoFormat ref_format;
   const gchar *ref_ext;
+
+  /* Asynchronous dumping */
+  gboolean async_dump;
+  SSimDumpPolicy dump_policy;
+  guint dump_queue_size;
+  GstBufferPool *dump_pool;
+  GThread *dump_thread;
+
+  /* Protects the following fields and frames when dumping asynchronously */
+  GMutex dump_lock;
+  GCond dump_cond;
+  GQueue dump_queue;
+  gboolean dumping;
+  gboolean dump_stopping;
+  guint dumps_written;
+  guint dumps_dropped;
+  guint max_dump_queue_depth;
 };
 
 
@@ -195,20 +246,154 @@ G_DEFINE_TYPE_WITH_PRIVATE (ValidateSsimOverride, validate_ssim_override,
     GST_TYPE_VALIDATE_OVERRIDE)
 /*  *INDENT-ON* */
 
+static gboolean _save_frame (ValidateSsimOverride * self,
+    GstVideoFrame * frame, const gchar * outname);
+
+static void
+_free_dump (SSimDump * dump)
+{
+  gst_video_frame_unmap (&dump->frame);
+  g_free (dump->outname);
+
+  g_slice_free (SSimDump, dump);
+}
+
+static gpointer
+_dump_thread_func (ValidateSsimOverride * self)
+{
+  ValidateSsimOverridePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->dump_lock);
+  while (TRUE) {
+    SSimDump *dump;
+    gboolean res;
+
+    while (!priv->dump_stopping && g_queue_is_empty (&priv->dump_queue))
+      g_cond_wait (&priv->dump_cond, &priv->dump_lock);
+
+    if (g_queue_is_empty (&priv->dump_queue))
+      break;
+
+    dump = g_queue_pop_head (&priv->dump_queue);
+    priv->dumping = TRUE;
+    g_cond_broadcast (&priv->dump_cond);
+    g_mutex_unlock (&priv->dump_lock);
+
+    res = _save_frame (self, &dump->frame, dump->outname);
+
+    g_mutex_lock (&priv->dump_lock);
+    if (res)
+      priv->dumps_written++;
+    else
+      g_array_index (priv->frames, Frame, dump->index).failed = TRUE;
+    priv->dumping = FALSE;
+    g_cond_broadcast (&priv->dump_cond);
+
+    _free_dump (dump);
+  }
+  g_mutex_unlock (&priv->dump_lock);
+
+  return NULL;
+}
+
+/* Waits until all the queued frames have been saved */
+static void
+_flush_dumps (ValidateSsimOverride * self)
+{
+  ValidateSsimOverridePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->dump_lock);
+  while (!g_queue_is_empty (&priv->dump_queue) || priv->dumping)
+    g_cond_wait (&priv->dump_cond, &priv->dump_lock);
+  g_mutex_unlock (&priv->dump_lock);
+}
+
+/* Makes room in the queue for a new frame according to the drop policy,
+ * returns FALSE if the new frame should be dropped */
+static gboolean
+_reserve_dump (ValidateSsimOverride * self)
+{
+  gboolean res = TRUE;
+  ValidateSsimOverridePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->dump_lock);
+  if (priv->dump_queue.length >= priv->dump_queue_size) {
+    switch (priv->dump_policy) {
+      case SSIM_DUMP_POLICY_BLOCK:
+        while (priv->dump_queue.length >= priv->dump_queue_size)
+          g_cond_wait (&priv->dump_cond, &priv->dump_lock);
+        break;
+      case SSIM_DUMP_POLICY_DROP_NEW:
+        priv->dumps_dropped++;
+        res = FALSE;
+        break;
+      case SSIM_DUMP_POLICY_DROP_OLD:
+      {
+        SSimDump *dump = g_queue_pop_head (&priv->dump_queue);
+
+        g_array_index (priv->frames, Frame, dump->index).failed = TRUE;
+        priv->dumps_dropped++;
+        _free_dump (dump);
+        break;
+      }
+    }
+  }
+  g_mutex_unlock (&priv->dump_lock);
+
+  return res;
+}
+
+static void
+_queue_dump (ValidateSsimOverride * self, GstVideoFrame * frame,
+    gchar * outname, GstClockTime position)
+{
+  Frame iframe;
+  ValidateSsimOverridePrivate *priv = self->priv;
+  SSimDump *dump = g_slice_new0 (SSimDump);
+
+  dump->frame = *frame;
+  dump->outname = g_strdup (outname);
+
+  iframe.position = position;
+  iframe.path = outname;
+  iframe.width = priv->in_info.width;
+  iframe.height = priv->in_info.height;
+  iframe.failed = FALSE;
+
+  g_mutex_lock (&priv->dump_lock);
+  dump->index = priv->frames->len;
+  g_array_append_val (priv->frames, iframe);
+  g_queue_push_tail (&priv->dump_queue, dump);
+  priv->max_dump_queue_depth = MAX (priv->max_dump_queue_depth,
+      priv->dump_queue.length);
+  g_cond_broadcast (&priv->dump_cond);
+  g_mutex_unlock (&priv->dump_lock);
+}
+
 static void
 runner_stopping (GstValidateRunner * runner, ValidateSsimOverride * self)
 {
   GstValidateSsim *ssim;
 
-  guint i, nfiles;
+  guint i, n, ncompared = 0;
   gfloat mssim = 0, lowest = 1, highest = -1, total_avg = 0;
-  gint npassed = 0, nfailures = 0;
+  gint npassed = 0, nfailures = 0, cache_size;
+  guint cache_hits, cache_misses;
   gdouble min_avg_similarity = 0.95, min_lowest_similarity = -1.0,
       min_avg = 1.0, min_min = 1.0;
   const gchar *compared_files_dir =
       gst_structure_get_string (self->priv->config,
       "reference-images-dir");
 
+  if (self->priv->async_dump) {
+    _flush_dumps (self);
+
+    gst_validate_printf (self, "Frame dumps: %u written, %u dropped,"
+        " max queue depth: %u/%u\n", self->priv->dumps_written,
+        self->priv->dumps_dropped, self->priv->max_dump_queue_depth,
+        self->priv->dump_queue_size);
+  }
+
   if (!compared_files_dir) {
     return;
   }
@@ -227,11 +412,27 @@ runner_stopping (GstValidateRunner * runner, ValidateSsimOverride * self)
 
   ssim =
       gst_validate_ssim_new (runner, min_avg_similarity, min_lowest_similarity);
+  if (gst_structure_get_int (self->priv->config, "reference-cache-size",
+          &cache_size))
+    gst_validate_ssim_set_reference_cache_size (ssim,
+        (guint64) MAX (cache_size, 0) * 1024 * 1024);
+
+  /* Frames that could not be dumped are not compared */
+  for (i = 0; i < self->priv->frames->len; i++) {
+    if (!g_array_index (self->priv->frames, Frame, i).failed)
+      ncompared++;
+  }
 
-  nfiles = self->priv->frames->len;
-  for (i = 0; i < nfiles; i++) {
+  for (i = 0, n = 0; i < self->priv->frames->len; i++) {
     Frame *frame = &g_array_index (self->priv->frames, Frame, i);
-    gchar *refname, *ref_path, *bname = g_path_get_basename (frame->path);
+    gchar *refname, *ref_path, *bname;
+
+    if (frame->failed)
+      continue;
+
+    n++;
+
+    bname = g_path_get_basename (frame->path);
 
     if (self->priv->ref_format == GST_VIDEO_FORMAT_ENCODED)
       refname = g_strdup_printf ("*.%s", self->priv->ref_ext);
@@ -255,14 +456,21 @@ runner_stopping (GstValidateRunner * runner, ValidateSsimOverride * self)
         "<position: %" GST_TIME_FORMAT " duration: %" GST_TIME_FORMAT
         " %d / %d avg: %f min: %f (Passed: %d failed: %d)/>\n",
         GST_TIME_ARGS (frame->position), GST_TIME_ARGS (GST_CLOCK_TIME_NONE),
-        i + 1, nfiles, mssim, lowest, npassed, nfailures);
+        n, ncompared, mssim, lowest, npassed, nfailures);
 
     g_free (bname);
   }
 
   gst_validate_printf (NULL,
       "\nAverage similarity: %f, min_avg: %f, min_min: %f\n",
-      total_avg / nfiles, min_avg, min_min);
+      ncompared ? total_avg / ncompared : 0, min_avg, min_min);
+
+  gst_validate_ssim_get_reference_cache_stats (ssim, &cache_hits,
+      &cache_misses);
+  gst_validate_printf (NULL, "Reference frames cache: %u hits, %u misses\n",
+      cache_hits, cache_misses);
+
+  gst_object_unref (ssim);
 }
 
 static void
@@ -348,6 +556,33 @@ validate_ssim_override_new (GstStructure * config)
   gst_validate_utils_get_clocktime (config, "check-recurrence",
       &self->priv->recurrence);
 
+  gst_structure_get_boolean (config, "async-dump", &self->priv->async_dump);
+  if (self->priv->async_dump) {
+    gint queue_size;
+    const gchar *policy = gst_structure_get_string (config,
+        "dump-drop-policy");
+
+    if (gst_structure_get_int (config, "dump-queue-size", &queue_size))
+      self->priv->dump_queue_size = MAX (queue_size, 1);
+
+    if (!policy || !g_strcmp0 (policy, "block")) {
+      self->priv->dump_policy = SSIM_DUMP_POLICY_BLOCK;
+    } else if (!g_strcmp0 (policy, "drop-new")) {
+      self->priv->dump_policy = SSIM_DUMP_POLICY_DROP_NEW;
+    } else if (!g_strcmp0 (policy, "drop-old")) {
+      self->priv->dump_policy = SSIM_DUMP_POLICY_DROP_OLD;
+    } else {
+      GST_ERROR ("Unknown dump drop policy: %s", policy);
+
+      gst_object_unref (self);
+
+      return NULL;
+    }
+
+    self->priv->dump_thread = g_thread_new ("validatessim-dump",
+        (GThreadFunc) _dump_thread_func, self);
+  }
+
   g_signal_connect (self, "notify::validate-runner", G_CALLBACK (_runner_set),
       NULL);
 
@@ -417,6 +652,22 @@ _finalize (GObject * object)
 {
   ValidateSsimOverridePrivate *priv = VALIDATE_SSIM_OVERRIDE (object)->priv;
 
+  if (priv->dump_thread) {
+    g_mutex_lock (&priv->dump_lock);
+    priv->dump_stopping = TRUE;
+    g_cond_broadcast (&priv->dump_cond);
+    g_mutex_unlock (&priv->dump_lock);
+
+    g_thread_join (priv->dump_thread);
+  }
+  g_mutex_clear (&priv->dump_lock);
+  g_cond_clear (&priv->dump_cond);
+
+  if (priv->dump_pool) {
+    gst_buffer_pool_set_active (priv->dump_pool, FALSE);
+    gst_object_unref (priv->dump_pool);
+  }
+
   if (priv->converter)
     gst_video_converter_free (priv->converter);
 
@@ -470,6 +721,35 @@ validate_ssim_override_init (ValidateSsimOverride * self)
   self->priv->needs_reconfigure = TRUE;
   self->priv->frames = g_array_new (TRUE, TRUE, sizeof (Frame));
   g_array_set_clear_func (self->priv->frames, (GDestroyNotify) free_frame);
+
+  self->priv->dump_queue_size = DEFAULT_DUMP_QUEUE_SIZE;
+  g_mutex_init (&self->priv->dump_lock);
+  g_cond_init (&self->priv->dump_cond);
+  g_queue_init (&self->priv->dump_queue);
+}
+
+/* Frames to save asynchronously are copied or converted into buffers from
+ * that pool, so that upstream buffers are not held while they are queued */
+static void
+_setup_dump_pool (ValidateSsimOverride * o, GstVideoInfo * info)
+{
+  GstStructure *config;
+  ValidateSsimOverridePrivate *priv = o->priv;
+
+  if (!priv->async_dump)
+    return;
+
+  /* Queued frames, the one being saved and the one being converted */
+  priv->dump_pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (priv->dump_pool);
+  gst_buffer_pool_config_set_params (config, NULL, info->size, 0,
+      priv->dump_queue_size + 2);
+  if (!gst_buffer_pool_set_config (priv->dump_pool, config) ||
+      !gst_buffer_pool_set_active (priv->dump_pool, TRUE)) {
+    GST_ERROR_OBJECT (o, "Could not configure the dump buffer pool");
+    gst_object_unref (priv->dump_pool);
+    priv->dump_pool = NULL;
+  }
 }
 
 static gboolean
@@ -494,6 +774,13 @@ _set_videoconvert (ValidateSsimOverride * o,
     priv->converter = NULL;
   }
 
+  if (priv->dump_pool) {
+    /* Buffers still queued are freed when released */
+    gst_buffer_pool_set_active (priv->dump_pool, FALSE);
+    gst_object_unref (priv->dump_pool);
+    priv->dump_pool = NULL;
+  }
+
   if (!gst_video_info_from_caps (&priv->in_info, priv->last_caps)) {
     GST_VALIDATE_REPORT (o, SSIM_WRONG_FORMAT,
         "The format %" GST_PTR_FORMAT " is not supported"
@@ -509,6 +796,7 @@ _set_videoconvert (ValidateSsimOverride * o,
 
   if (priv->in_info.finfo->format == format) {
     GST_INFO_OBJECT (o, "No conversion needed");
+    _setup_dump_pool (o, &priv->in_info);
 
     return TRUE;
   }
@@ -524,6 +812,8 @@ _set_videoconvert (ValidateSsimOverride * o,
   priv->converter = gst_video_converter_new (&priv->in_info,
       &priv->out_info, NULL);
 
+  _setup_dump_pool (o, &priv->out_info);
+
   return TRUE;
 
 }
@@ -672,9 +962,16 @@ _handle_buffer (GstValidateOverride * override,
     priv->needs_reconfigure = !_set_videoconvert (o, pad_monitor);
   }
 
+  if (priv->async_dump && !_reserve_dump (o)) {
+    GST_LOG_OBJECT (override, "Dump queue full, dropping buffer: %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (position));
+
+    return;
+  }
+
   if (priv->converter) {
     GstVideoFrame inframe;
-    GstBuffer *outbuf;
+    GstBuffer *outbuf = NULL;
 
     if (!gst_video_frame_map (&inframe, &priv->in_info, buffer, GST_MAP_READ)) {
       GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
@@ -683,7 +980,12 @@ _handle_buffer (GstValidateOverride * override,
       return;
     }
 
-    outbuf = gst_buffer_new_allocate (NULL, priv->out_info.size, NULL);
+    if (priv->dump_pool &&
+        gst_buffer_pool_acquire_buffer (priv->dump_pool, &outbuf,
+            NULL) != GST_FLOW_OK)
+      outbuf = NULL;
+    if (!outbuf)
+      outbuf = gst_buffer_new_allocate (NULL, priv->out_info.size, NULL);
     if (!gst_video_frame_map (&frame, &priv->out_info, outbuf, GST_MAP_WRITE)) {
       GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
           "Could not map the outbuffer %p", outbuf);
@@ -694,6 +996,31 @@ _handle_buffer (GstValidateOverride * override,
     gst_buffer_unref (outbuf);
     gst_video_converter_frame (priv->converter, &inframe, &frame);
     gst_video_frame_unmap (&inframe);
+  } else if (priv->dump_pool) {
+    GstVideoFrame inframe;
+    GstBuffer *outbuf = NULL;
+
+    if (!gst_video_frame_map (&inframe, &priv->in_info, buffer, GST_MAP_READ)) {
+      GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
+          "Could not map the videoframe %p", buffer);
+
+      return;
+    }
+
+    if (gst_buffer_pool_acquire_buffer (priv->dump_pool, &outbuf,
+            NULL) != GST_FLOW_OK ||
+        !gst_video_frame_map (&frame, &priv->in_info, outbuf, GST_MAP_WRITE)) {
+      GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
+          "Could not get a buffer to copy %p", buffer);
+
+      if (outbuf)
+        gst_buffer_unref (outbuf);
+      gst_video_frame_unmap (&inframe);
+      return;
+    }
+    gst_buffer_unref (outbuf);
+    gst_video_frame_copy (&frame, &inframe);
+    gst_video_frame_unmap (&inframe);
   } else {
     if (!gst_video_frame_map (&frame, &priv->in_info, buffer, GST_MAP_WRITE)) {
       GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
@@ -703,6 +1030,13 @@ _handle_buffer (GstValidateOverride * override,
   }
 
   outname = _get_filename (o, pad_monitor, position);
+  if (priv->async_dump) {
+    priv->last_dump_position = position;
+    _queue_dump (o, &frame, outname, position);
+
+    return;
+  }
+
   if (_save_frame (o, &frame, outname)) {
     priv->last_dump_position = position;
 
@@ -0,0 +1,126 @@
+/* GstValidate
+ *
+ * padmonitor.c - Measures the per buffer overhead of pad monitoring
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/validate/validate.h>
+
+#define DEFAULT_NUM_BUFFERS 200000
+#define DEFAULT_NUM_ELEMENTS 8
+
+static GstElement *
+create_pipeline (gint num_buffers, gint num_elements)
+{
+  gint i;
+  GstElement *pipeline, *prev, *sink;
+  GstElement *src = gst_element_factory_make ("fakesrc", NULL);
+
+  pipeline = gst_pipeline_new (NULL);
+  g_object_set (src, "num-buffers", num_buffers, "sizetype", 2, "sizemax",
+      4096, "can-activate-pull", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), src);
+
+  prev = src;
+  for (i = 0; i < num_elements; i++) {
+    GstElement *identity = gst_element_factory_make ("identity", NULL);
+
+    g_object_set (identity, "silent", TRUE, NULL);
+    gst_bin_add (GST_BIN (pipeline), identity);
+    g_assert (gst_element_link (prev, identity));
+    prev = identity;
+  }
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  g_assert (gst_element_link (prev, sink));
+
+  return pipeline;
+}
+
+static gdouble
+run_pipeline (gint num_buffers, gint num_elements, gboolean monitored)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  gint64 start, end;
+  GstValidateRunner *runner = NULL;
+  GstValidateMonitor *monitor = NULL;
+  GstElement *pipeline = create_pipeline (num_buffers, num_elements);
+
+  if (monitored) {
+    runner = gst_validate_runner_new ();
+    monitor = gst_validate_monitor_factory_create (GST_OBJECT (pipeline),
+        runner, NULL);
+  }
+
+  bus = gst_element_get_bus (pipeline);
+  start = g_get_monotonic_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = g_get_monotonic_time ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_error ("Got an error running the benchmark pipeline");
+
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (monitored) {
+    gst_object_unref (monitor);
+    gst_object_unref (runner);
+  }
+
+  return (gdouble) (end - start) / G_USEC_PER_SEC;
+}
+
+int
+main (int argc, char **argv)
+{
+  gdouble reference, monitored;
+  gint num_buffers = DEFAULT_NUM_BUFFERS;
+  gint num_elements = DEFAULT_NUM_ELEMENTS;
+
+  gst_init (&argc, &argv);
+  gst_validate_init ();
+
+  if (argc > 1)
+    num_buffers = atoi (argv[1]);
+  if (argc > 2)
+    num_elements = atoi (argv[2]);
+
+  reference = run_pipeline (num_buffers, num_elements, FALSE);
+  monitored = run_pipeline (num_buffers, num_elements, TRUE);
+
+  g_print ("%d buffers through %d identity elements\n", num_buffers,
+      num_elements);
+  g_print ("  not monitored: %.3fs (%.0f buffers/s)\n", reference,
+      num_buffers / reference);
+  g_print ("  monitored:     %.3fs (%.0f buffers/s)\n", monitored,
+      num_buffers / monitored);
+  g_print ("  overhead:      %.2fx\n", monitored / reference);
+
+  gst_validate_deinit ();
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/* GstValidate
+ *
+ * ssim.c - Measures the throughput of the SSIM engine
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst-libs/gst/video/gssim.h>
+
+#define DEFAULT_NUM_FRAMES 20
+
+typedef void (*CompareFunc) (Gssim * self, guint8 * org, guint8 * mod,
+    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest);
+
+static const struct
+{
+  const gchar *name;
+  gint width;
+  gint height;
+} resolutions[] = {
+  {"QVGA", 320, 240},
+  {"VGA", 640, 480},
+  {"720p", 1280, 720},
+  {"1080p", 1920, 1080},
+};
+
+static gdouble
+run_compare (Gssim * ssim, CompareFunc compare, guint8 * org, guint8 * mod,
+    guint8 * out, gint num_frames)
+{
+  gint i;
+  gint64 start, end;
+  gfloat mean, lowest, highest;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < num_frames; i++)
+    compare (ssim, org, mod, out, &mean, &lowest, &highest);
+  end = g_get_monotonic_time ();
+
+  return num_frames * (gdouble) G_USEC_PER_SEC / (end - start);
+}
+
+int
+main (int argc, char **argv)
+{
+  guint i;
+  gint num_frames = DEFAULT_NUM_FRAMES;
+  gboolean with_reference = FALSE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+  if (argc > 2)
+    with_reference = g_strcmp0 (argv[2], "reference") == 0;
+
+  g_print ("SSIM over %d frames, %u threads\n", num_frames,
+      g_get_num_processors ());
+
+  for (i = 0; i < G_N_ELEMENTS (resolutions); i++) {
+    gint x, size = resolutions[i].width * resolutions[i].height;
+    guint8 *org = g_malloc (size), *mod = g_malloc (size);
+    guint8 *out = g_malloc (size);
+    Gssim *ssim = gssim_new ();
+    GRand *rand = g_rand_new_with_seed (i);
+
+    for (x = 0; x < size; x++) {
+      org[x] = g_rand_int_range (rand, 0, 256);
+      mod[x] = CLAMP (org[x] + g_rand_int_range (rand, -16, 16), 0, 255);
+    }
+
+    gssim_configure (ssim, resolutions[i].width, resolutions[i].height);
+    g_print ("  %-6s %.1f fps", resolutions[i].name,
+        run_compare (ssim, gssim_compare, org, mod, out, num_frames));
+    if (with_reference)
+      g_print (" (reference: %.1f fps)", run_compare (ssim,
+              gssim_compare_reference, org, mod, out, num_frames));
+    g_print ("\n");
+
+    g_rand_free (rand);
+    gst_object_unref (ssim);
+    g_free (org);
+    g_free (mod);
+    g_free (out);
+  }
+
+  return 0;
+}
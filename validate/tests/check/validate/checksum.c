@@ -0,0 +1,256 @@
+/* GstValidate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <gst/validate/validate.h>
+#include <gst/check/gstcheck.h>
+
+static void
+check_data_checksum (GstValidateChecksumType type, const gchar * data,
+    const gchar * expected)
+{
+  GstValidateChecksum *checksum = gst_validate_checksum_new (type);
+
+  gst_validate_checksum_update (checksum, (const guint8 *) data, strlen (data));
+  fail_unless_equals_string (gst_validate_checksum_get_string (checksum),
+      expected);
+  gst_validate_checksum_free (checksum);
+}
+
+GST_START_TEST (test_checksum_known_values)
+{
+  check_data_checksum (GST_VALIDATE_CHECKSUM_TYPE_MD5, "abc",
+      "900150983cd24fb0d6963f7d28e17f72");
+  check_data_checksum (GST_VALIDATE_CHECKSUM_TYPE_SHA1, "abc",
+      "a9993e364706816aba3e25717850c26c9cd0d89d");
+  check_data_checksum (GST_VALIDATE_CHECKSUM_TYPE_XXH64, "",
+      "ef46db3751d8e999");
+  check_data_checksum (GST_VALIDATE_CHECKSUM_TYPE_XXH64, "abc",
+      "44bc2cf5ad770999");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_checksum_type_names)
+{
+  GstValidateChecksumType type;
+
+  fail_unless (gst_validate_checksum_type_from_name ("xxh64", &type));
+  fail_unless_equals_int (type, GST_VALIDATE_CHECKSUM_TYPE_XXH64);
+  fail_unless_equals_string (gst_validate_checksum_type_get_name (type),
+      "xxh64");
+  fail_if (gst_validate_checksum_type_from_name ("crc32", &type));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_checksum_digest)
+{
+  GstValidateChecksumType types[] = { GST_VALIDATE_CHECKSUM_TYPE_MD5,
+    GST_VALIDATE_CHECKSUM_TYPE_SHA256, GST_VALIDATE_CHECKSUM_TYPE_XXH64
+  };
+  guint i;
+
+  /* The binary digest must follow the order of the hexadecimal string */
+  for (i = 0; i < G_N_ELEMENTS (types); i++) {
+    guint8 digest[GST_VALIDATE_CHECKSUM_MAX_DIGEST_SIZE];
+    GstValidateChecksum *checksum = gst_validate_checksum_new (types[i]);
+    GString *hex = g_string_new (NULL);
+    gsize j, len;
+
+    gst_validate_checksum_update (checksum, (const guint8 *) "abc", 3);
+    len = gst_validate_checksum_get_digest (checksum, digest);
+    for (j = 0; j < len; j++)
+      g_string_append_printf (hex, "%02x", digest[j]);
+
+    fail_unless_equals_string (hex->str,
+        gst_validate_checksum_get_string (checksum));
+
+    g_string_free (hex, TRUE);
+    gst_validate_checksum_free (checksum);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_checksum_buffer_memories)
+{
+  guint i;
+  guint8 data[1000];
+  GstBuffer *single, *split;
+  gchar *single_sum, *split_sum;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i * 7 + 3;
+
+  single = gst_buffer_new_wrapped (g_memdup (data, sizeof (data)),
+      sizeof (data));
+  split = gst_buffer_new_wrapped (g_memdup (data, 13), 13);
+  gst_buffer_append_memory (split,
+      gst_memory_new_wrapped (0, g_memdup (data + 13, sizeof (data) - 13),
+          sizeof (data) - 13, 0, sizeof (data) - 13, NULL, NULL));
+
+  /* Hashing is streamed, how the data is split must not matter */
+  single_sum =
+      gst_validate_compute_checksum_for_buffer
+      (GST_VALIDATE_CHECKSUM_TYPE_XXH64, single);
+  split_sum =
+      gst_validate_compute_checksum_for_buffer
+      (GST_VALIDATE_CHECKSUM_TYPE_XXH64, split);
+  fail_unless_equals_string (single_sum, "5f235fa033f1a3fb");
+  fail_unless_equals_string (split_sum, single_sum);
+
+  g_free (single_sum);
+  g_free (split_sum);
+  gst_buffer_unref (single);
+  gst_buffer_unref (split);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_checksum_video_frame_stride)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *packed, *padded;
+  GstValidateChecksum *checksum;
+  gchar *packed_sum;
+  gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
+  gint stride[GST_VIDEO_MAX_PLANES] = { 8, };
+  const guint8 packed_data[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  const guint8 padded_data[] = { 0, 1, 2, 3, 0xff, 0xff, 0xff, 0xff,
+    4, 5, 6, 7, 0xff, 0xff, 0xff, 0xff
+  };
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_GRAY8, 4, 2);
+  packed = gst_buffer_new_wrapped (g_memdup (packed_data,
+          sizeof (packed_data)), sizeof (packed_data));
+  padded = gst_buffer_new_wrapped (g_memdup (padded_data,
+          sizeof (padded_data)), sizeof (padded_data));
+  gst_buffer_add_video_meta_full (padded, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_GRAY8, 4, 2, 1, offset, stride);
+
+  checksum = gst_validate_checksum_new (GST_VALIDATE_CHECKSUM_TYPE_XXH64);
+  fail_unless (gst_video_frame_map (&frame, &info, packed, GST_MAP_READ));
+  fail_unless (gst_validate_checksum_update_video_frame (checksum, &frame));
+  gst_video_frame_unmap (&frame);
+  packed_sum = g_strdup (gst_validate_checksum_get_string (checksum));
+
+  /* Row padding is not part of the image and must be ignored */
+  gst_validate_checksum_reset (checksum);
+  fail_unless (gst_video_frame_map (&frame, &info, padded, GST_MAP_READ));
+  fail_unless (gst_validate_checksum_update_video_frame (checksum, &frame));
+  gst_video_frame_unmap (&frame);
+  fail_unless_equals_string (gst_validate_checksum_get_string (checksum),
+      packed_sum);
+
+  g_free (packed_sum);
+  gst_validate_checksum_free (checksum);
+  gst_buffer_unref (packed);
+  gst_buffer_unref (padded);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_checksum_video_buffer)
+{
+  GstCaps *caps, *other_caps, *bigger_caps;
+  GstBuffer *packed, *padded;
+  GstValidateChecksum *checksum;
+  gchar *packed_sum, *buffer_sum;
+  gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
+  gint stride[GST_VIDEO_MAX_PLANES] = { 8, };
+  const guint8 packed_data[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  const guint8 padded_data[] = { 0, 1, 2, 3, 0xff, 0xff, 0xff, 0xff,
+    4, 5, 6, 7, 0xff, 0xff, 0xff, 0xff
+  };
+
+  caps = gst_caps_from_string ("video/x-raw, format=GRAY8, width=4, "
+      "height=2, framerate=25/1");
+  other_caps = gst_caps_from_string ("video/x-h264");
+  bigger_caps = gst_caps_from_string ("video/x-raw, format=GRAY8, width=4, "
+      "height=4, framerate=25/1");
+  packed = gst_buffer_new_wrapped (g_memdup (packed_data,
+          sizeof (packed_data)), sizeof (packed_data));
+  padded = gst_buffer_new_wrapped (g_memdup (padded_data,
+          sizeof (padded_data)), sizeof (padded_data));
+  gst_buffer_add_video_meta_full (padded, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_GRAY8, 4, 2, 1, offset, stride);
+
+  checksum = gst_validate_checksum_new (GST_VALIDATE_CHECKSUM_TYPE_MD5);
+  fail_unless (gst_validate_checksum_update_video_buffer (checksum, packed,
+          caps));
+  packed_sum = g_strdup (gst_validate_checksum_get_string (checksum));
+
+  gst_validate_checksum_reset (checksum);
+  fail_unless (gst_validate_checksum_update_video_buffer (checksum, padded,
+          caps));
+  fail_unless_equals_string (gst_validate_checksum_get_string (checksum),
+      packed_sum);
+
+  /* Anything else than raw video is checksummed as a whole */
+  gst_validate_checksum_reset (checksum);
+  fail_unless (gst_validate_checksum_update_video_buffer (checksum, padded,
+          other_caps));
+  buffer_sum =
+      gst_validate_compute_checksum_for_buffer (GST_VALIDATE_CHECKSUM_TYPE_MD5,
+      padded);
+  fail_unless_equals_string (gst_validate_checksum_get_string (checksum),
+      buffer_sum);
+  g_free (buffer_sum);
+
+  /* And so is a buffer that can not be mapped as a frame of its caps */
+  gst_validate_checksum_reset (checksum);
+  fail_unless (gst_validate_checksum_update_video_buffer (checksum, packed,
+          bigger_caps));
+  buffer_sum =
+      gst_validate_compute_checksum_for_buffer (GST_VALIDATE_CHECKSUM_TYPE_MD5,
+      packed);
+  fail_unless_equals_string (gst_validate_checksum_get_string (checksum),
+      buffer_sum);
+
+  g_free (buffer_sum);
+  g_free (packed_sum);
+  gst_validate_checksum_free (checksum);
+  gst_buffer_unref (packed);
+  gst_buffer_unref (padded);
+  gst_caps_unref (bigger_caps);
+  gst_caps_unref (other_caps);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_validate_suite (void)
+{
+  Suite *s = suite_create ("checksum");
+  TCase *tc_chain = tcase_create ("checksum");
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_checksum_known_values);
+  tcase_add_test (tc_chain, test_checksum_type_names);
+  tcase_add_test (tc_chain, test_checksum_digest);
+  tcase_add_test (tc_chain, test_checksum_buffer_memories);
+  tcase_add_test (tc_chain, test_checksum_video_frame_stride);
+  tcase_add_test (tc_chain, test_checksum_video_buffer);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_validate);
@@ -29,6 +29,35 @@ GST_START_TEST (test_expression_parser)
 
 GST_END_TEST;
 
+GST_START_TEST (test_compiled_expression)
+{
+  gchar *error = NULL;
+  GstValidateExpression *expr;
+
+  expr = gst_validate_utils_compile_expression ("position + -2 ^ 2 * duration",
+      &error);
+  fail_unless (expr);
+  fail_if (error);
+
+  fail_unless_equals_float (gst_validate_expression_evaluate (expr, get_var,
+          GINT_TO_POINTER (1), NULL), 5);
+  fail_unless_equals_float (gst_validate_expression_evaluate (expr, get_var,
+          GINT_TO_POINTER (2), NULL), 10);
+
+  fail_unless_equals_float (gst_validate_expression_evaluate (expr, NULL,
+          NULL, &error), -1.0);
+  fail_unless_equals_string (error,
+      "Could not look up value for variable position!");
+  g_free (error);
+  gst_validate_expression_free (expr);
+
+  fail_if (gst_validate_utils_compile_expression ("max(1, 2", &error));
+  fail_unless (error);
+  g_free (error);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_validate_suite (void)
 {
@@ -43,6 +72,7 @@ gst_validate_suite (void)
   g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE);
   gst_validate_init ();
   tcase_add_test (tc_chain, test_expression_parser);
+  tcase_add_test (tc_chain, test_compiled_expression);
   gst_validate_deinit ();
 
   return s;
@@ -92,6 +92,43 @@ GST_START_TEST (check_text_overrides)
 
 GST_END_TEST;
 
+GST_START_TEST (check_klass_and_name_overrides)
+{
+  GstValidateOverride *override;
+  GQuark issue_id = g_quark_from_string ("buffer::not-expected-one");
+  GstValidateRunner *runner = gst_validate_runner_new ();
+
+  _check_message_level (runner, 0, "fakesink",
+      GST_VALIDATE_REPORT_LEVEL_WARNING, "buffer::not-expected-one");
+
+  /* Registering an override applies to element types already seen */
+  override = gst_validate_override_new ();
+  gst_validate_override_change_severity (override, issue_id,
+      GST_VALIDATE_REPORT_LEVEL_CRITICAL);
+  gst_validate_override_register_by_klass ("Sink", override);
+  g_object_unref (override);
+
+  _check_message_level (runner, 1, "fakesink",
+      GST_VALIDATE_REPORT_LEVEL_CRITICAL, "buffer::not-expected-one");
+  _check_message_level (runner, 2, "identity",
+      GST_VALIDATE_REPORT_LEVEL_WARNING, "buffer::not-expected-one");
+
+  override = gst_validate_override_new ();
+  gst_validate_override_change_severity (override, issue_id,
+      GST_VALIDATE_REPORT_LEVEL_ISSUE);
+  gst_validate_override_register_by_name ("^ident.*", override);
+  g_object_unref (override);
+
+  _check_message_level (runner, 3, "identity",
+      GST_VALIDATE_REPORT_LEVEL_ISSUE, "buffer::not-expected-one");
+  _check_message_level (runner, 4, "queue",
+      GST_VALIDATE_REPORT_LEVEL_WARNING, "buffer::not-expected-one");
+
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_validate_suite (void)
@@ -107,6 +144,7 @@ gst_validate_suite (void)
   g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE);
   gst_validate_init ();
   tcase_add_test (tc_chain, check_text_overrides);
+  tcase_add_test (tc_chain, check_klass_and_name_overrides);
   gst_validate_deinit ();
 
   return s;
@@ -18,6 +18,7 @@
  */
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <gst/validate/validate.h>
 #include <gst/validate/gst-validate-pad-monitor.h>
 #include <gst/validate/media-descriptor-parser.h>
@@ -160,6 +161,169 @@ GST_START_TEST (buffer_before_segment)
 
 GST_END_TEST;
 
+static guint chained_buffers = 0;
+static guint chained_lists = 0;
+static guint last_chained_list_length = 0;
+
+static GstFlowReturn
+_count_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  chained_buffers++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+_count_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  chained_lists++;
+  last_chained_list_length = gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static GstBufferList *
+_buffer_list_new (guint len, GstClockTime start)
+{
+  guint i;
+  GstBufferList *list = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buffer) = start + i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buffer) = 10 * GST_MSECOND;
+    if (i == 0)
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+    gst_buffer_list_add (list, buffer);
+  }
+
+  return list;
+}
+
+GST_START_TEST (buffer_list_batching)
+{
+  GList *tmp, *reports;
+  GstPad *srcpad, *sinkpad;
+  GstValidateRunner *runner;
+  GstValidateMonitor *srcmonitor, *sinkmonitor;
+  GstElement *element = gst_element_factory_make ("fakesink", NULL);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, _count_chain);
+  gst_pad_set_chain_list_function (sinkpad, _count_chain_list);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  fail_unless (g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE));
+  runner = gst_validate_runner_new ();
+  srcmonitor =
+      gst_validate_monitor_factory_create (GST_OBJECT (srcpad), runner, NULL);
+  sinkmonitor =
+      gst_validate_monitor_factory_create (GST_OBJECT (sinkpad), runner, NULL);
+  fail_unless (GST_IS_VALIDATE_PAD_MONITOR (srcmonitor));
+  fail_unless (GST_IS_VALIDATE_PAD_MONITOR (sinkmonitor));
+
+  fail_unless (gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE));
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PUSH, TRUE));
+
+  /* The buffers of a list are still checked by both monitors (FAILS) */
+  _gst_check_expecting_log = TRUE;
+  fail_unless_equals_int (gst_pad_push_list (srcpad, _buffer_list_new (8, 0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 1);
+  fail_unless_equals_int (last_chained_list_length, 8);
+  fail_unless_equals_int (chained_buffers, 0);
+
+  reports = gst_validate_runner_get_reports (runner);
+  assert_equals_int (g_list_length (reports), 2);
+  for (tmp = reports; tmp; tmp = tmp->next) {
+    GstValidateReport *report = tmp->data;
+
+    fail_unless_equals_int (report->issue->issue_id, BUFFER_BEFORE_SEGMENT);
+  }
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+
+  /* And lists keep reaching the element in one piece (WORKS) */
+  _gst_check_expecting_log = FALSE;
+  gst_check_setup_events (srcpad, element, NULL, GST_FORMAT_TIME);
+  fail_unless_equals_int (gst_pad_push_list (srcpad, _buffer_list_new (16,
+              80 * GST_MSECOND)), GST_FLOW_OK);
+  fail_unless_equals_int (chained_lists, 2);
+  fail_unless_equals_int (last_chained_list_length, 16);
+  fail_unless_equals_int (chained_buffers, 0);
+
+  reports = gst_validate_runner_get_reports (runner);
+  assert_equals_int (g_list_length (reports), 2);
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+
+  /* clean up */
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PUSH, FALSE));
+  fail_unless (gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, FALSE));
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (element);
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (buffer_list_default_chain_list)
+{
+  GList *tmp, *reports;
+  GstPad *srcpad, *sinkpad;
+  GstValidateRunner *runner;
+  GstValidateMonitor *srcmonitor, *sinkmonitor;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, _count_chain);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  fail_unless (g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE));
+  runner = gst_validate_runner_new ();
+  srcmonitor =
+      gst_validate_monitor_factory_create (GST_OBJECT (srcpad), runner, NULL);
+  sinkmonitor =
+      gst_validate_monitor_factory_create (GST_OBJECT (sinkpad), runner, NULL);
+  fail_unless (GST_IS_VALIDATE_PAD_MONITOR (srcmonitor));
+  fail_unless (GST_IS_VALIDATE_PAD_MONITOR (sinkmonitor));
+
+  fail_unless (gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE));
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PUSH, TRUE));
+
+  /* Without a chain list function the buffers go through the chain function
+   * one by one, and are each checked once by the sink pad monitor */
+  chained_buffers = 0;
+  _gst_check_expecting_log = TRUE;
+  fail_unless_equals_int (gst_pad_push_list (srcpad, _buffer_list_new (8, 0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (chained_buffers, 8);
+
+  reports = gst_validate_runner_get_reports (runner);
+  assert_equals_int (g_list_length (reports), 2);
+  for (tmp = reports; tmp; tmp = tmp->next) {
+    GstValidateReport *report = tmp->data;
+
+    fail_unless_equals_int (report->issue->issue_id, BUFFER_BEFORE_SEGMENT);
+  }
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+  _gst_check_expecting_log = FALSE;
+
+  /* clean up */
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PUSH, FALSE));
+  fail_unless (gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, FALSE));
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (buffer_outside_segment)
 {
   GstPad *srcpad, *pad;
@@ -771,6 +935,221 @@ MEDIA_INFO_TEST (5, 6,
     }));
 /* *INDENT-ON* */
 
+GST_START_TEST (media_info_sync_point)
+{
+  GstPad *pad;
+  GstCaps *caps;
+  GstValidateRunner *runner;
+  GstValidateMediaDescriptor *mdesc;
+  GstValidateMediaExpectedFrames *frames;
+  GstValidateMediaExpectedFrame *frame;
+  GError *err = NULL;
+
+  runner = gst_validate_runner_new ();
+  mdesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new_from_xml (runner, media_info,
+      &err);
+
+  pad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (gst_pad_set_active (pad, TRUE));
+  caps = gst_caps_from_string ("video/x-raw, format=AYUV");
+  fail_unless_equals_int (gst_pad_store_sticky_event (pad,
+          gst_event_new_caps (caps)), GST_FLOW_OK);
+  gst_caps_unref (caps);
+
+  frames = gst_validate_media_descriptor_get_expected_frames (mdesc, pad);
+  fail_unless (frames != NULL);
+  fail_unless_equals_int (frames->frames->len, 8);
+  fail_unless_equals_int (frames->keyframes->len, 2);
+
+  frame = &g_array_index (frames->frames, GstValidateMediaExpectedFrame, 0);
+  fail_unless (frame->is_keyframe);
+  fail_unless_equals_int (frame->checksum_size, 16);
+  frame = &g_array_index (frames->frames, GstValidateMediaExpectedFrame, 3);
+  fail_unless (!frame->is_keyframe);
+  fail_unless_equals_int (frame->checksum_size, 0);
+
+  fail_unless_equals_int (gst_validate_media_expected_frames_find_sync_point
+      (frames, 0), 0);
+  fail_unless_equals_int (gst_validate_media_expected_frames_find_sync_point
+      (frames, 3), 0);
+  fail_unless_equals_int (gst_validate_media_expected_frames_find_sync_point
+      (frames, 4), 4);
+  fail_unless_equals_int (gst_validate_media_expected_frames_find_sync_point
+      (frames, 6), 4);
+  fail_unless_equals_int (gst_validate_media_expected_frames_find_sync_point
+      (frames, GST_SECOND), 4);
+
+  gst_validate_media_expected_frames_free (frames);
+  gst_object_unref (pad);
+  gst_object_unref (mdesc);
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
+static GstValidateMediaExpectedFrames *
+_get_expected_frames (GstValidateMediaDescriptor * mdesc)
+{
+  GstCaps *caps;
+  GstValidateMediaExpectedFrames *frames;
+  GstPad *pad = gst_pad_new ("sink", GST_PAD_SINK);
+
+  fail_unless (gst_pad_set_active (pad, TRUE));
+  caps = gst_caps_from_string ("video/x-raw, format=AYUV");
+  fail_unless_equals_int (gst_pad_store_sticky_event (pad,
+          gst_event_new_caps (caps)), GST_FLOW_OK);
+  gst_caps_unref (caps);
+
+  frames = gst_validate_media_descriptor_get_expected_frames (mdesc, pad);
+  fail_unless (frames != NULL);
+  gst_object_unref (pad);
+
+  return frames;
+}
+
+GST_START_TEST (media_info_binary)
+{
+  gint fd;
+  guint i;
+  gchar *path, *binpath;
+  GstValidateRunner *runner;
+  GstValidateMediaDescriptor *xmldesc, *bindesc;
+  GstValidateMediaExpectedFrames *xmlframes, *binframes;
+  GError *err = NULL;
+
+  fd = g_file_open_tmp ("padmonitor-XXXXXX.media_info", &path, &err);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (path, media_info, -1, NULL));
+  binpath = g_strconcat (path, ".bin", NULL);
+
+  runner = gst_validate_runner_new ();
+  xmldesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new (runner, path, &err);
+  fail_unless (xmldesc != NULL);
+  fail_unless (gst_validate_media_descriptor_parser_write_binary
+      (GST_VALIDATE_MEDIA_DESCRIPTOR_PARSER (xmldesc), path, &err));
+  fail_unless (g_file_test (binpath, G_FILE_TEST_IS_REGULAR));
+
+  /* Now loaded from the compiled form */
+  bindesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new (runner, path, &err);
+  fail_unless (bindesc != NULL);
+  fail_unless_equals_uint64 (gst_validate_media_descriptor_get_duration
+      (bindesc), 10031000000);
+  fail_unless (gst_validate_media_descriptor_get_seekable (bindesc));
+
+  /* Straight from the frames table */
+  xmlframes = _get_expected_frames (xmldesc);
+  binframes = _get_expected_frames (bindesc);
+  fail_unless_equals_int (binframes->frames->len, xmlframes->frames->len);
+  fail_unless_equals_int (binframes->keyframes->len,
+      xmlframes->keyframes->len);
+  for (i = 0; i < xmlframes->frames->len; i++) {
+    GstValidateMediaExpectedFrame *xmlframe = &g_array_index
+        (xmlframes->frames, GstValidateMediaExpectedFrame, i);
+    GstValidateMediaExpectedFrame *binframe = &g_array_index
+        (binframes->frames, GstValidateMediaExpectedFrame, i);
+
+    fail_unless_equals_uint64 (binframe->pts, xmlframe->pts);
+    fail_unless_equals_uint64 (binframe->dts, xmlframe->dts);
+    fail_unless_equals_uint64 (binframe->min_ts, xmlframe->min_ts);
+    fail_unless_equals_int (binframe->is_keyframe, xmlframe->is_keyframe);
+    fail_unless_equals_int (binframe->checksum_size, xmlframe->checksum_size);
+    fail_unless (memcmp (binframe->checksum, xmlframe->checksum,
+            xmlframe->checksum_size) == 0);
+  }
+  gst_validate_media_expected_frames_free (xmlframes);
+  gst_validate_media_expected_frames_free (binframes);
+
+  /* And with the frame nodes */
+  fail_unless (gst_validate_media_descriptor_has_frame_info (bindesc));
+  gst_validate_media_descriptors_compare (xmldesc, bindesc);
+  fail_unless_equals_int (gst_validate_runner_get_reports_count (runner), 0);
+  gst_object_unref (bindesc);
+
+  /* An outdated compiled form is ignored */
+  fail_unless (g_file_set_contents (path, "<file duration='1'></file>", -1,
+          NULL));
+  bindesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new (runner, path, &err);
+  fail_unless (bindesc != NULL);
+  fail_unless_equals_uint64 (gst_validate_media_descriptor_get_duration
+      (bindesc), 1);
+
+  gst_object_unref (bindesc);
+  gst_object_unref (xmldesc);
+  gst_object_unref (runner);
+  g_unlink (binpath);
+  g_unlink (path);
+  g_free (binpath);
+  g_free (path);
+}
+
+GST_END_TEST;
+
+/* *INDENT-OFF* */
+static const gchar * media_info_sha1_file =
+"<file duration='10031000000' frame-detection='1' uri='file:///I/am/so/fake.fakery' seekable='true'";
+
+static const gchar * media_info_sha1_streams =
+">  <streams caps='video/quicktime'>"
+"    <stream type='video' caps='video/x-raw'>"
+"       <frame duration='1' id='0' is-keyframe='true' offset='18446744073709551615' offset-end='18446744073709551615' pts='0' dts='0' checksum='4a0e0a3f5b4dbf1e5c64c98b6c3f4bd5b4b4e0a5'/>"
+"      <tags>"
+"      </tags>"
+"    </stream>"
+"  </streams>"
+"</file>";
+/* *INDENT-ON* */
+
+GST_START_TEST (media_info_checksum_type)
+{
+  gchar *xml;
+  GstValidateRunner *runner;
+  GstValidateMediaDescriptor *mdesc;
+  GError *err = NULL;
+
+  runner = gst_validate_runner_new ();
+
+  /* Written before the algorithm was recorded, guessed from the size */
+  xml = g_strconcat (media_info_sha1_file, "",
+      media_info_sha1_streams, NULL);
+  mdesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new_from_xml (runner, xml, &err);
+  fail_unless (mdesc != NULL);
+  fail_unless_equals_int (gst_validate_media_descriptor_get_checksum_type
+      (mdesc), GST_VALIDATE_CHECKSUM_TYPE_SHA1);
+  gst_object_unref (mdesc);
+  g_free (xml);
+
+  /* Never compared with a checksum computed with another algorithm */
+  xml = g_strconcat (media_info_sha1_file, " checksum-type='md5'",
+      media_info_sha1_streams, NULL);
+  mdesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new_from_xml (runner, xml, &err);
+  fail_unless (mdesc == NULL);
+  fail_unless (g_error_matches (err, G_MARKUP_ERROR,
+          G_MARKUP_ERROR_INVALID_CONTENT));
+  g_clear_error (&err);
+  g_free (xml);
+
+  xml = g_strconcat (media_info_sha1_file, " checksum-type='sha512'",
+      media_info_sha1_streams, NULL);
+  mdesc = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new_from_xml (runner, xml, &err);
+  fail_unless (mdesc == NULL);
+  fail_unless (g_error_matches (err, G_MARKUP_ERROR,
+          G_MARKUP_ERROR_INVALID_CONTENT));
+  g_clear_error (&err);
+  g_free (xml);
+
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (caps_events)
 {
   GstPad *srcpad, *sinkpad;
@@ -1083,6 +1462,8 @@ gst_validate_suite (void)
 
   tcase_add_test (tc_chain, buffer_before_segment);
   tcase_add_test (tc_chain, buffer_outside_segment);
+  tcase_add_test (tc_chain, buffer_list_batching);
+  tcase_add_test (tc_chain, buffer_list_default_chain_list);
   tcase_add_test (tc_chain, buffer_timestamp_out_of_received_range);
 
   tcase_add_test (tc_chain, media_info_1);
@@ -1090,6 +1471,9 @@ gst_validate_suite (void)
   tcase_add_test (tc_chain, media_info_3);
   tcase_add_test (tc_chain, media_info_4);
   tcase_add_test (tc_chain, media_info_5);
+  tcase_add_test (tc_chain, media_info_sync_point);
+  tcase_add_test (tc_chain, media_info_binary);
+  tcase_add_test (tc_chain, media_info_checksum_type);
 
   tcase_add_test (tc_chain, flow_aggregation_ok_ok_error_ok);
   tcase_add_test (tc_chain, flow_aggregation_eos_eos_eos_ok);
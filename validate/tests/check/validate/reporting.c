@@ -17,6 +17,8 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <stdio.h>
+
 #include <gst/validate/validate.h>
 #include <gst/check/gstcheck.h>
 #include "test-utils.h"
@@ -213,6 +215,133 @@ _create_issues (GstValidateRunner * runner)
   gst_check_objects_destroyed_on_unref (sink, sinkpad, NULL);
 }
 
+GST_START_TEST (test_repeated_reports_counted)
+{
+  gint i;
+  GList *reports;
+  GstValidateReport *report;
+  GstValidateRunner *runner;
+  GstValidateOverride *reporter;
+
+  fail_unless (g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "monitor", TRUE));
+  runner = gst_validate_runner_new ();
+  reporter = gst_validate_override_new ();
+  gst_validate_reporter_set_name (GST_VALIDATE_REPORTER (reporter),
+      g_strdup ("repeater"));
+  gst_validate_reporter_set_runner (GST_VALIDATE_REPORTER (reporter), runner);
+
+  for (i = 0; i < 10; i++)
+    GST_VALIDATE_REPORT (reporter, BUFFER_BEFORE_SEGMENT, "occurrence %d", i);
+
+  /* Only the first occurrence is kept, the others are counted on it */
+  reports =
+      gst_validate_reporter_get_reports (GST_VALIDATE_REPORTER (reporter));
+  fail_unless_equals_int (g_list_length (reports), 1);
+  report = reports->data;
+  fail_unless_equals_string (report->message, "occurrence 0");
+  fail_unless_equals_int (report->n_repeats, 9);
+  fail_unless (report->repeated_reports == NULL);
+  fail_unless_equals_int (gst_validate_runner_get_reports_count (runner), 1);
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+
+  gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (reporter));
+  g_object_unref (reporter);
+  g_object_unref (runner);
+
+  /* When all the details are requested, each occurrence is kept and counted */
+  fail_unless (g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE));
+  runner = gst_validate_runner_new ();
+  reporter = gst_validate_override_new ();
+  gst_validate_reporter_set_name (GST_VALIDATE_REPORTER (reporter),
+      g_strdup ("repeater"));
+  gst_validate_reporter_set_runner (GST_VALIDATE_REPORTER (reporter), runner);
+
+  for (i = 0; i < 10; i++)
+    GST_VALIDATE_REPORT (reporter, BUFFER_BEFORE_SEGMENT, "occurrence %d", i);
+
+  fail_unless_equals_int (gst_validate_runner_get_reports_count (runner), 10);
+  GST_VALIDATE_REPORT (reporter, BUFFER_BEFORE_SEGMENT, "occurrence 10");
+  fail_unless_equals_int (gst_validate_runner_get_reports_count (runner), 11);
+
+  gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (reporter));
+  g_object_unref (reporter);
+  g_object_unref (runner);
+}
+
+GST_END_TEST;
+
+#define REPORTING_THREADS 10
+#define REPORTS_PER_THREAD 10
+
+static gpointer
+_report_from_thread (GstValidateOverride ** reporters)
+{
+  gint i;
+
+  for (i = 0; i < REPORTS_PER_THREAD; i++)
+    GST_VALIDATE_REPORT (reporters[i], BUFFER_BEFORE_SEGMENT, "%s",
+        gst_validate_reporter_get_name (GST_VALIDATE_REPORTER (reporters[i])));
+
+  return NULL;
+}
+
+GST_START_TEST (test_reports_order)
+{
+  gint i, j;
+  GList *reports, *tmp;
+  GstValidateRunner *runner;
+  GThread *threads[REPORTING_THREADS];
+  GstValidateOverride *reporters[REPORTING_THREADS][REPORTS_PER_THREAD];
+  gint last_reported[REPORTING_THREADS];
+
+  fail_unless (g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "monitor", TRUE));
+  runner = gst_validate_runner_new ();
+
+  for (i = 0; i < REPORTING_THREADS; i++) {
+    for (j = 0; j < REPORTS_PER_THREAD; j++) {
+      reporters[i][j] = gst_validate_override_new ();
+      gst_validate_reporter_set_name (GST_VALIDATE_REPORTER (reporters[i][j]),
+          g_strdup_printf ("reporter%d-%d", i, j));
+      gst_validate_reporter_set_runner (GST_VALIDATE_REPORTER (reporters[i]
+              [j]), runner);
+    }
+    last_reported[i] = -1;
+  }
+
+  /* Reports added concurrently from different threads end up in different
+   * staging areas, the reports of each thread must still be kept in the
+   * order they were added in */
+  for (i = 0; i < REPORTING_THREADS; i++)
+    threads[i] = g_thread_new ("reporter",
+        (GThreadFunc) _report_from_thread, reporters[i]);
+  for (i = 0; i < REPORTING_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  fail_unless_equals_int (gst_validate_runner_get_reports_count (runner),
+      REPORTING_THREADS * REPORTS_PER_THREAD);
+  reports = gst_validate_runner_get_reports (runner);
+  fail_unless_equals_int (g_list_length (reports),
+      REPORTING_THREADS * REPORTS_PER_THREAD);
+  for (tmp = reports; tmp; tmp = tmp->next) {
+    fail_unless_equals_int (sscanf (((GstValidateReport *) tmp->data)->message,
+            "reporter%d-%d", &i, &j), 2);
+    fail_unless_equals_int (j, last_reported[i] + 1);
+    last_reported[i] = j;
+  }
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+
+  for (i = 0; i < REPORTING_THREADS; i++) {
+    for (j = 0; j < REPORTS_PER_THREAD; j++) {
+      gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (reporters[i]
+              [j]));
+      g_object_unref (reporters[i][j]);
+    }
+  }
+  g_object_unref (runner);
+}
+
+GST_END_TEST;
+
 #define TEST_LEVELS(name, details, num_issues) \
 GST_START_TEST (test_global_level_##name) { \
   GstValidateRunner *runner; \
@@ -267,6 +396,8 @@ gst_validate_suite (void)
   tcase_add_test (tc_chain, test_report_levels_2);
   tcase_add_test (tc_chain, test_report_levels_complex_parsing);
   tcase_add_test (tc_chain, test_complex_reporting_details);
+  tcase_add_test (tc_chain, test_repeated_reports_counted);
+  tcase_add_test (tc_chain, test_reports_order);
 
   tcase_add_test (tc_chain, test_global_level_none);
   tcase_add_test (tc_chain, test_global_level_synthetic);
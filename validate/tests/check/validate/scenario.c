@@ -1,6 +1,8 @@
 #include <gst/check/gstcheck.h>
 #include <glib/gstdio.h>
+#include <utime.h>
 #include <gst/validate/validate.h>
+#include <gst/validate/gst-validate-utils.h>
 
 GST_START_TEST (test_expression_parser)
 {
@@ -40,6 +42,152 @@ GST_START_TEST (test_expression_parser)
 
 GST_END_TEST;
 
+GST_START_TEST (test_structs_parse_from_filename)
+{
+  gint i, fd;
+  gchar *path;
+  struct utimbuf times;
+  GList *structures, *again;
+  const gchar *content = "# A comment\n"
+      "description, summary=\"Some\\\n summary\"\n"
+      "\n"
+      "seek, start=1.0, \\\n  flags=accurate+flush\n"
+      "# Another comment\n" "stop;\n";
+
+  fd = g_file_open_tmp ("test-structs-XXXXXX.scenario", &path, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (path, content, -1, NULL));
+
+  structures = gst_validate_utils_structs_parse_from_filename (path);
+  fail_unless_equals_int (g_list_length (structures), 3);
+  fail_unless (gst_structure_has_name (structures->data, "description"));
+  fail_unless_equals_string (gst_structure_get_string (structures->data,
+          "summary"), "Some summary");
+  fail_unless (gst_structure_has_name (structures->next->data, "seek"));
+  fail_unless (gst_structure_has_field (structures->next->data, "flags"));
+  fail_unless (gst_structure_has_name (structures->next->next->data, "stop"));
+
+  /* Loading the file again gives copies of the same structures */
+  for (i = 0; i < 2; i++) {
+    GList *a, *b;
+
+    again = gst_validate_utils_structs_parse_from_filename (path);
+    fail_unless_equals_int (g_list_length (again), 3);
+    for (a = structures, b = again; a; a = a->next, b = b->next) {
+      fail_unless (a->data != b->data);
+      fail_unless (gst_structure_is_equal (a->data, b->data));
+    }
+    g_list_free_full (again, (GDestroyNotify) gst_structure_free);
+  }
+  g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+
+  /* Rewriting it with the same size is noticed, make sure the modification
+   * time differs even on file systems with coarse timestamps */
+  fail_unless (g_file_set_contents (path, "play;\n", -1, NULL));
+  times.actime = times.modtime = 1000000000;
+  fail_unless (g_utime (path, &times) == 0);
+  structures = gst_validate_utils_structs_parse_from_filename (path);
+  fail_unless (gst_structure_has_name (structures->data, "play"));
+  fail_unless (g_file_set_contents (path, "stop;\n", -1, NULL));
+  times.actime = times.modtime = 1000000001;
+  fail_unless (g_utime (path, &times) == 0);
+  again = gst_validate_utils_structs_parse_from_filename (path);
+  fail_unless (gst_structure_has_name (again->data, "stop"));
+  g_list_free_full (again, (GDestroyNotify) gst_structure_free);
+  g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+
+  g_remove (path);
+  g_free (path);
+}
+
+GST_END_TEST;
+
+static GstClockTime last_rendered_pts = GST_CLOCK_TIME_NONE;
+static GList *positions_at_execution = NULL;
+
+static GstPadProbeReturn
+_record_rendered_pts_cb (GstPad * pad, GstPadProbeInfo * info, gpointer unused)
+{
+  last_rendered_pts = GST_BUFFER_PTS (GST_PAD_PROBE_INFO_BUFFER (info));
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstValidateExecuteActionReturn
+_execute_record_position (GstValidateScenario * scenario,
+    GstValidateAction * action)
+{
+  positions_at_execution = g_list_append (positions_at_execution,
+      GUINT_TO_POINTER (last_rendered_pts / GST_MSECOND));
+
+  return GST_VALIDATE_EXECUTE_ACTION_OK;
+}
+
+GST_START_TEST (test_fast_forward_holds_at_action)
+{
+  gint fd;
+  gchar *path;
+  GstPad *sinkpad;
+  GstElement *sink, *pipeline;
+  GstValidateScenario *scenario;
+  GMainLoop *loop = g_main_loop_new (NULL, FALSE);
+  GstValidateRunner *runner = gst_validate_runner_new ();
+  const gchar *content = "description, summary=\"fast-forward test\"\n"
+      "record-position\n" "record-position, playback-time=2.0\n";
+
+  gst_validate_register_action_type ("record-position", "validate-test",
+      _execute_record_position, NULL,
+      "Records the PTS of the last buffer the sink rendered",
+      GST_VALIDATE_ACTION_TYPE_NONE);
+
+  fd = g_file_open_tmp ("fast-forward-XXXXXX.scenario", &path, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (path, content, -1, NULL));
+
+  g_setenv ("GST_VALIDATE_SCENARIO_FAST_FORWARD", "1", TRUE);
+  /* 100 bytes buffers at 1000 bytes per second, 100ms each */
+  pipeline = gst_parse_launch ("fakesrc num-buffers=50 format=time "
+      "sizetype=fixed sizemax=100 datarate=1000 ! fakesink name=sink", NULL);
+  fail_unless (pipeline);
+  scenario = gst_validate_scenario_factory_create (runner, pipeline, path);
+  fail_unless (scenario);
+
+  /* Added after the scenario one, only sees the data it let through */
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) _record_rendered_pts_cb, NULL, NULL);
+  gst_object_unref (sinkpad);
+  gst_object_unref (sink);
+
+  g_signal_connect_swapped (scenario, "done", G_CALLBACK (g_main_loop_quit),
+      loop);
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  g_main_loop_run (loop);
+
+  /* The first action not having a playback time does not let the data run
+   * past the second one */
+  fail_unless_equals_int (g_list_length (positions_at_execution), 2);
+  fail_unless_equals_int (GPOINTER_TO_UINT (positions_at_execution->next->data),
+      1900);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_list_free (positions_at_execution);
+  positions_at_execution = NULL;
+  g_unsetenv ("GST_VALIDATE_SCENARIO_FAST_FORWARD");
+  gst_object_unref (scenario);
+  gst_object_unref (pipeline);
+  gst_object_unref (runner);
+  g_main_loop_unref (loop);
+  g_remove (path);
+  g_free (path);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_validate_suite (void)
 {
@@ -54,6 +202,8 @@ gst_validate_suite (void)
   g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE);
   gst_validate_init ();
   tcase_add_test (tc_chain, test_expression_parser);
+  tcase_add_test (tc_chain, test_structs_parse_from_filename);
+  tcase_add_test (tc_chain, test_fast_forward_holds_at_action);
   gst_validate_deinit ();
 
   return s;
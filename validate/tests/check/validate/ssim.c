@@ -0,0 +1,117 @@
+/* GstValidate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <gst/check/gstcheck.h>
+#include <gst-libs/gst/video/gssim.h>
+
+static void
+check_against_reference (gint width, gint height, gint noise)
+{
+  gint i;
+  gfloat mean, lowest, highest;
+  gfloat ref_mean, ref_lowest, ref_highest;
+  guint8 *org = g_malloc (width * height), *mod = g_malloc (width * height);
+  guint8 *out = g_malloc (width * height);
+  guint8 *ref_out = g_malloc (width * height);
+  GRand *rand = g_rand_new_with_seed (width * height);
+  Gssim *ssim = gssim_new ();
+
+  for (i = 0; i < width * height; i++) {
+    /* A gradient with some flat, bright areas */
+    org[i] = MIN (255, (i % width) * 300 / width);
+    mod[i] = CLAMP (org[i] + g_rand_int_range (rand, -noise, noise + 1), 0,
+        255);
+  }
+
+  gssim_configure (ssim, width, height);
+  gssim_compare_reference (ssim, org, mod, ref_out, &ref_mean, &ref_lowest,
+      &ref_highest);
+  gssim_compare (ssim, org, mod, out, &mean, &lowest, &highest);
+
+  fail_unless (fabs (mean - ref_mean) <= GSSIM_EPSILON, "mean %f != %f",
+      mean, ref_mean);
+  fail_unless (fabs (lowest - ref_lowest) <= GSSIM_EPSILON,
+      "lowest %f != %f", lowest, ref_lowest);
+  fail_unless (fabs (highest - ref_highest) <= GSSIM_EPSILON,
+      "highest %f != %f", highest, ref_highest);
+  for (i = 0; i < width * height; i++)
+    fail_unless (abs (out[i] - ref_out[i]) <= 1);
+
+  /* Comparing again must give the same results */
+  gssim_compare (ssim, org, mod, NULL, &ref_mean, &ref_lowest, &ref_highest);
+  fail_unless_equals_float (mean, ref_mean);
+  fail_unless_equals_float (lowest, ref_lowest);
+  fail_unless_equals_float (highest, ref_highest);
+
+  gst_object_unref (ssim);
+  g_rand_free (rand);
+  g_free (org);
+  g_free (mod);
+  g_free (out);
+  g_free (ref_out);
+}
+
+GST_START_TEST (test_ssim_matches_reference)
+{
+  check_against_reference (160, 120, 2);
+  check_against_reference (160, 120, 40);
+  /* Smaller than the window and not a multiple of the SIMD width */
+  check_against_reference (7, 13, 10);
+  check_against_reference (67, 301, 10);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ssim_identical_images)
+{
+  gfloat mean, lowest, highest;
+  guint8 *org = g_malloc (64 * 48);
+  Gssim *ssim = gssim_new ();
+  gint i;
+
+  for (i = 0; i < 64 * 48; i++)
+    org[i] = i * 7;
+
+  gssim_configure (ssim, 64, 48);
+  gssim_compare (ssim, org, org, NULL, &mean, &lowest, &highest);
+  fail_unless (fabs (mean - 1) <= GSSIM_EPSILON);
+  fail_unless (fabs (lowest - 1) <= GSSIM_EPSILON);
+  fail_unless (fabs (highest - 1) <= GSSIM_EPSILON);
+
+  gst_object_unref (ssim);
+  g_free (org);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_validate_suite (void)
+{
+  Suite *s = suite_create ("ssim");
+  TCase *tc_chain = tcase_create ("ssim");
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_ssim_matches_reference);
+  tcase_add_test (tc_chain, test_ssim_identical_images);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_validate);
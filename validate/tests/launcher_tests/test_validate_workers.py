@@ -0,0 +1,46 @@
+# -*- Mode: Python -*- vi:si:et:sw=4:sts=4:ts=4:syntax=python
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this program; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+# Boston, MA 02110-1301, USA.
+
+"""
+Runs several pipelines one after the other in the same gst-validate-1.0
+worker, to be used with `--use-workers -j 1`. The tests run in the order of
+their names, the failure of the first one must not leak into the others.
+"""
+
+TEST_MANAGER = "validate"
+
+
+def get_pipelines(test_manager):
+    return [("1_not_negotiated",
+             "audiotestsrc num-buffers=10 ! capsfilter caps=video/x-raw ! fakesink",
+             {"scenarios": [],
+              "expected-failures": [
+                  {'returncode': 18},
+                  {'level': 'critical', 'summary': 'a NOT NEGOTIATED message has been posted on the bus.'}]}),
+            ("2_passing", "audiotestsrc num-buffers=10 ! fakesink",
+             {"scenarios": []}),
+            ("3_passing", "videotestsrc num-buffers=10 ! fakesink",
+             {"scenarios": []})]
+
+
+def setup_tests(test_manager, options):
+    print("Setting up tests to test the GstValidate workers")
+    test_manager.add_generators(test_manager.GstValidatePipelineTestsGenerator
+                                ("test_validate_workers", test_manager,
+                                 pipelines_descriptions=get_pipelines(test_manager)))
+
+    return True
@@ -37,6 +37,308 @@
 #include <gst/pbutils/encoding-profile.h>
 #include <locale.h>             /* for LC_ALL */
 
+typedef struct
+{
+  gchar *uri;
+  gchar *output_file;
+
+  /* Results */
+  gboolean success;
+  gchar *error;
+  GstClockTime duration;
+  gdouble time;
+} MediaCheckJob;
+
+typedef struct
+{
+  GstValidateRunner *runner;
+  GstValidateMediaDescriptorWriterFlags flags;
+
+  GMutex lock;
+  guint done;
+  guint total;
+} MediaCheckBatch;
+
+static void
+_media_check_job_free (MediaCheckJob * job)
+{
+  g_free (job->uri);
+  g_free (job->output_file);
+  g_free (job->error);
+  g_slice_free (MediaCheckJob, job);
+}
+
+static gboolean
+_is_media_info (const gchar * name)
+{
+  return g_str_has_suffix (name, ".media_info")
+      || g_str_has_suffix (name, ".media_info.bin");
+}
+
+/* @relative_path is the path of the file relative to the directory given on
+ * the command line it was found in, which is mirrored in @output_dir, or NULL
+ * if the file was given directly */
+static void
+_add_job (GPtrArray * jobs, const gchar * uri, const gchar * output_dir,
+    const gchar * relative_path)
+{
+  MediaCheckJob *job = g_slice_new0 (MediaCheckJob);
+  gchar *location = gst_uri_get_location (uri);
+
+  job->uri = g_strdup (uri);
+  if (output_dir) {
+    gchar *name = relative_path ? g_strdup (relative_path) :
+        g_path_get_basename (location ? location : uri);
+    gchar *filename = g_strconcat (name, ".media_info", NULL);
+
+    job->output_file = g_build_filename (output_dir, filename, NULL);
+    g_free (filename);
+    g_free (name);
+  } else if (location && gst_uri_has_protocol (uri, "file")) {
+    job->output_file = g_strconcat (location, ".media_info", NULL);
+  }
+
+  g_free (location);
+  g_ptr_array_add (jobs, job);
+}
+
+static void
+_add_jobs_from_directory (GPtrArray * jobs, const gchar * dirname,
+    const gchar * output_dir, const gchar * relative_dir)
+{
+  const gchar *name;
+  GDir *dir = g_dir_open (dirname, 0, NULL);
+
+  if (!dir) {
+    g_printerr ("Could not open directory %s\n", dirname);
+    return;
+  }
+
+  while ((name = g_dir_read_name (dir))) {
+    gchar *path, *relative_path;
+
+    if (name[0] == '.' || _is_media_info (name))
+      continue;
+
+    path = g_build_filename (dirname, name, NULL);
+    relative_path = relative_dir ? g_build_filename (relative_dir, name, NULL)
+        : g_strdup (name);
+    if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+      _add_jobs_from_directory (jobs, path, output_dir, relative_path);
+    } else if (g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+      gchar *uri = gst_filename_to_uri (path, NULL);
+
+      if (uri)
+        _add_job (jobs, uri, output_dir, relative_path);
+      g_free (uri);
+    }
+    g_free (relative_path);
+    g_free (path);
+  }
+
+  g_dir_close (dir);
+}
+
+static gboolean
+_add_jobs_from_list (GPtrArray * jobs, const gchar * listfile,
+    const gchar * output_dir)
+{
+  gint i;
+  gchar *content, **lines;
+  GError *err = NULL;
+
+  if (!g_file_get_contents (listfile, &content, NULL, &err)) {
+    g_printerr ("Could not read %s: %s\n", listfile, err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+
+  lines = g_strsplit (content, "\n", -1);
+  for (i = 0; lines[i]; i++) {
+    gchar *uri = g_strstrip (lines[i]);
+
+    if (*uri && *uri != '#')
+      _add_job (jobs, uri, output_dir, NULL);
+  }
+
+  g_strfreev (lines);
+  g_free (content);
+
+  return TRUE;
+}
+
+static void
+_add_jobs_from_argument (GPtrArray * jobs, const gchar * arg,
+    const gchar * output_dir)
+{
+  if (g_file_test (arg, G_FILE_TEST_IS_DIR)) {
+    _add_jobs_from_directory (jobs, arg, output_dir, NULL);
+  } else if (gst_uri_is_valid (arg)) {
+    _add_job (jobs, arg, output_dir, NULL);
+  } else {
+    gchar *uri = gst_filename_to_uri (arg, NULL);
+
+    if (uri)
+      _add_job (jobs, uri, output_dir, NULL);
+    else
+      g_printerr ("Ignoring %s, neither a file nor an URI\n", arg);
+    g_free (uri);
+  }
+}
+
+/* Files given from different places can have the same name in --output-dir,
+ * returns FALSE if several jobs would write the same file */
+static gboolean
+_check_output_files (GPtrArray * jobs)
+{
+  guint i;
+  gboolean ret = TRUE;
+  GHashTable *output_files = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < jobs->len; i++) {
+    MediaCheckJob *job = g_ptr_array_index (jobs, i);
+    MediaCheckJob *other;
+
+    if (!job->output_file)
+      continue;
+
+    other = g_hash_table_lookup (output_files, job->output_file);
+    if (other) {
+      g_printerr ("%s and %s would both be written to %s\n", other->uri,
+          job->uri, job->output_file);
+      ret = FALSE;
+    } else {
+      g_hash_table_insert (output_files, job->output_file, job);
+    }
+  }
+  g_hash_table_unref (output_files);
+
+  return ret;
+}
+
+/* Runs in the batch thread pool, with its own main context for the frame
+ * analysis pipeline */
+static void
+_run_job (MediaCheckJob * job, MediaCheckBatch * batch)
+{
+  GError *err = NULL;
+  GstValidateMediaDescriptorWriter *writer;
+  GMainContext *context = g_main_context_new ();
+  gint64 start = g_get_monotonic_time ();
+
+  g_main_context_push_thread_default (context);
+
+  writer = gst_validate_media_descriptor_writer_new_discover (batch->runner,
+      job->uri, batch->flags, &err);
+  if (job->output_file) {
+    gchar *dirname = g_path_get_dirname (job->output_file);
+
+    g_mkdir_with_parents (dirname, 0755);
+    g_free (dirname);
+  }
+
+  if (writer == NULL) {
+    job->error = g_strdup_printf ("Could not discover file%s%s",
+        err ? ": " : "", err ? err->message : "");
+  } else if (!job->output_file) {
+    job->error = g_strdup ("Not a local file and no --output-dir given");
+  } else if (!gst_validate_media_descriptor_writer_write (writer,
+          job->output_file)) {
+    job->error = g_strdup_printf ("Could not write %s", job->output_file);
+  } else {
+    job->success = TRUE;
+    job->duration = gst_validate_media_descriptor_get_duration (
+        (GstValidateMediaDescriptor *) writer);
+  }
+  g_clear_error (&err);
+
+  if (writer) {
+    gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (writer));
+    gst_object_unref (writer);
+  }
+
+  g_main_context_pop_thread_default (context);
+  g_main_context_unref (context);
+
+  job->time = (gdouble) (g_get_monotonic_time () - start) / G_USEC_PER_SEC;
+
+  g_mutex_lock (&batch->lock);
+  batch->done++;
+  g_print ("[%u/%u] %s: %s (%.2fs)\n", batch->done, batch->total, job->uri,
+      job->success ? "OK" : job->error, job->time);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Writes the descriptor of each job, running @n_threads analyses at the
+ * same time, and returns the process exit code */
+static gint
+_run_batch (GPtrArray * jobs, GstValidateMediaDescriptorWriterFlags flags,
+    gint n_threads)
+{
+  guint i, failures = 0;
+  gint ret;
+  GThreadPool *pool;
+  GError *err = NULL;
+  GstClockTime duration = 0;
+  MediaCheckBatch batch = { 0, };
+  gint64 start = g_get_monotonic_time ();
+  gdouble time;
+
+  batch.runner = gst_validate_runner_new ();
+  batch.flags = flags;
+  batch.total = jobs->len;
+  g_mutex_init (&batch.lock);
+
+  pool = g_thread_pool_new ((GFunc) _run_job, &batch, n_threads, TRUE, &err);
+  if (!pool) {
+    g_printerr ("Could not start the analysis threads: %s\n", err->message);
+    g_clear_error (&err);
+    ret = 1;
+    goto done;
+  }
+
+  for (i = 0; i < jobs->len; i++)
+    g_thread_pool_push (pool, g_ptr_array_index (jobs, i), NULL);
+
+  /* Waits for all the jobs to be done */
+  g_thread_pool_free (pool, FALSE, TRUE);
+  time = MAX ((gdouble) (g_get_monotonic_time () - start) / G_USEC_PER_SEC,
+      0.001);
+
+  ret = gst_validate_runner_exit (batch.runner, TRUE);
+
+  g_print ("\nAnalyzed %u files in %.2fs with %d jobs: %.2f files/s",
+      jobs->len, time, n_threads, jobs->len / time);
+  for (i = 0; i < jobs->len; i++) {
+    MediaCheckJob *job = g_ptr_array_index (jobs, i);
+
+    if (job->success && GST_CLOCK_TIME_IS_VALID (job->duration))
+      duration += job->duration;
+  }
+  g_print (", %.2fx realtime\n", (gdouble) duration / GST_SECOND / time);
+
+  for (i = 0; i < jobs->len; i++) {
+    MediaCheckJob *job = g_ptr_array_index (jobs, i);
+
+    if (job->success)
+      continue;
+
+    if (!failures)
+      g_print ("\nFailures:\n");
+    g_print ("  %s: %s\n", job->uri, job->error);
+    failures++;
+  }
+
+  if (failures)
+    ret = 1;
+
+done:
+  g_mutex_clear (&batch.lock);
+  gst_object_unref (batch.runner);
+
+  return ret;
+}
+
 int
 main (int argc, gchar ** argv)
 {
@@ -46,6 +348,14 @@ main (int argc, gchar ** argv)
   GError *err = NULL;
   gboolean full = FALSE;
   gboolean skip_parsers = FALSE;
+  gboolean fast_checksums = FALSE;
+  gboolean video_frame_checksums = FALSE;
+  gboolean binary = FALSE;
+  gboolean convert = FALSE;
+  gboolean batch = FALSE;
+  gint jobs = g_get_num_processors ();
+  gchar *uri_list = NULL;
+  gchar *output_dir = NULL;
   gchar *output_file = NULL;
   gchar *expected_file = NULL;
   gchar *output = NULL;
@@ -69,12 +379,41 @@ main (int argc, gchar ** argv)
     {"skip-parsers", 's', 0, G_OPTION_ARG_NONE,
           &skip_parsers, "Do not plug a parser after demuxer.",
         NULL},
+    {"fast-checksums", 0, 0, G_OPTION_ARG_NONE,
+          &fast_checksums, "Use a fast non-cryptographic hash (xxh64) "
+          "instead of md5 to checksum frames when fully analyzing the file.",
+        NULL},
+    {"video-frame-checksums", 0, 0, G_OPTION_ARG_NONE,
+          &video_frame_checksums, "Checksum raw video frames plane by plane, "
+          "ignoring the padding at the end of the rows, so that the "
+          "checksums do not depend on the strides used by the decoders.",
+        NULL},
+    {"binary", 'b', 0, G_OPTION_ARG_NONE,
+          &binary, "Also write the compiled binary form of the results next "
+          "to the output file, which is faster to load.",
+        NULL},
+    {"convert", 'c', 0, G_OPTION_ARG_NONE,
+          &convert, "Compile the results file passed instead of an URI into "
+          "its binary form, written next to it with a .bin suffix.",
+        NULL},
+    {"uri-list", 'l', 0, G_OPTION_ARG_FILENAME,
+          &uri_list, "A file listing the URIs to analyze, one per line. "
+          "Several URIs, files or directories can also be passed directly.",
+        NULL},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT,
+          &jobs, "The number of files to analyze at the same time when "
+          "analyzing several files (defaults to the number of processors).",
+        NULL},
+    {"output-dir", 'd', 0, G_OPTION_ARG_FILENAME,
+          &output_dir, "The directory where to write the results when "
+          "analyzing several files, instead of next to each local file.",
+        NULL},
     {NULL}
   };
 
   setlocale (LC_ALL, "");
   g_set_prgname ("gst-validate-media-check-" GST_API_VERSION);
-  ctx = g_option_context_new ("[URI]");
+  ctx = g_option_context_new ("[URI | RESULTS-FILE | URI... | DIRECTORY...]");
   g_option_context_set_summary (ctx, "Analyzes a media file and writes "
       "the results to stdout or a file. Can also compare the results found "
       "with another results file for identifying regressions. The monitoring"
@@ -93,7 +432,10 @@ main (int argc, gchar ** argv)
   gst_init (&argc, &argv);
   gst_validate_init ();
 
-  if (argc != 2) {
+  batch = uri_list || argc > 2
+      || (argc == 2 && g_file_test (argv[1], G_FILE_TEST_IS_DIR));
+  if ((!batch && argc != 2) || (batch && (convert || expected_file
+              || output_file || jobs < 1))) {
     gchar *msg = g_option_context_get_help (ctx, TRUE, NULL);
     g_printerr ("%s\n", msg);
     g_free (msg);
@@ -105,6 +447,63 @@ main (int argc, gchar ** argv)
 
   gst_validate_spin_on_fault_signals ();
 
+  if (batch) {
+    gint i;
+    GPtrArray *batch_jobs =
+        g_ptr_array_new_with_free_func ((GDestroyNotify) _media_check_job_free);
+
+    if (uri_list && !_add_jobs_from_list (batch_jobs, uri_list, output_dir)) {
+      ret = 1;
+    } else {
+      for (i = 1; i < argc; i++)
+        _add_jobs_from_argument (batch_jobs, argv[i], output_dir);
+    }
+
+    if (!ret && !_check_output_files (batch_jobs))
+      ret = 1;
+
+    if (!ret) {
+      if (full)
+        writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FULL;
+      if (skip_parsers)
+        writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER;
+      if (fast_checksums)
+        writer_flags |=
+            GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM;
+      if (video_frame_checksums)
+        writer_flags |=
+            GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_VIDEO_FRAME_CHECKSUM;
+      if (binary)
+        writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_BINARY;
+      /* The g_log handler is global, it can't be one of the writers */
+      writer_flags &= ~GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_HANDLE_GLOGS;
+      writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_CONCURRENT;
+
+      ret = _run_batch (batch_jobs, writer_flags, jobs);
+    }
+
+    g_ptr_array_unref (batch_jobs);
+    goto out;
+  }
+
+  if (convert) {
+    GstValidateMediaDescriptorParser *parser =
+        gst_validate_media_descriptor_parser_new (NULL, argv[1], &err);
+
+    if (parser == NULL
+        || !gst_validate_media_descriptor_parser_write_binary (parser,
+            argv[1], &err)) {
+      g_printerr ("Could not convert %s: %s\n", argv[1],
+          err ? err->message : "unknown error");
+      g_clear_error (&err);
+      ret = 1;
+    }
+
+    if (parser)
+      gst_object_unref (parser);
+    goto out;
+  }
+
   runner = gst_validate_runner_new ();
 
   if (expected_file) {
@@ -123,6 +522,15 @@ main (int argc, gchar ** argv)
             (GstValidateMediaDescriptor *)
             reference))
       full = TRUE;              /* Reference has frame info, activate to do comparison */
+
+    /* Frames checksums need to be computed the same way as the reference ones */
+    fast_checksums =
+        gst_validate_media_descriptor_get_checksum_type (
+        (GstValidateMediaDescriptor *) reference) ==
+        GST_VALIDATE_CHECKSUM_TYPE_XXH64;
+    video_frame_checksums =
+        gst_validate_media_descriptor_get_checksum_video_frames (
+        (GstValidateMediaDescriptor *) reference);
   }
 
   if (full)
@@ -131,6 +539,16 @@ main (int argc, gchar ** argv)
   if (skip_parsers)
     writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER;
 
+  if (fast_checksums)
+    writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM;
+
+  if (video_frame_checksums)
+    writer_flags |=
+        GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_VIDEO_FRAME_CHECKSUM;
+
+  if (binary)
+    writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_BINARY;
+
 
   writer =
       gst_validate_media_descriptor_writer_new_discover (runner, argv[1],
@@ -166,6 +584,8 @@ out:
 
   g_free (output_file);
   g_free (expected_file);
+  g_free (uri_list);
+  g_free (output_dir);
 
   if (reference) {
     gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (reference));
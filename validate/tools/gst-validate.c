@@ -39,6 +39,10 @@
 
 #ifdef G_OS_UNIX
 #include <glib-unix.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 #include <locale.h>             /* for LC_ALL */
 
@@ -278,6 +282,13 @@ _execute_set_subtitles (GstValidateScenario * scenario,
 static void
 _register_playbin_actions (void)
 {
+  static gboolean registered = FALSE;
+
+  /* The worker runs many pipelines in the same process */
+  if (registered)
+    return;
+  registered = TRUE;
+
 /* *INDENT-OFF* */
   gst_validate_register_action_type ("set-subtitle", "validate-launcher", _execute_set_subtitles,
       (GstValidateActionParameter []) {
@@ -301,62 +312,66 @@ _register_playbin_actions (void)
 /* *INDENT-ON* */
 }
 
-int
-main (int argc, gchar ** argv)
+typedef struct
 {
-  GError *err = NULL;
-  gchar *scenario = NULL, *configs = NULL, *media_info = NULL,
-      *verbosity = NULL;
-  gboolean list_scenarios = FALSE, monitor_handles_state,
-      inspect_action_type = FALSE;
-  GstStateChangeReturn sret;
-  gchar *output_file = NULL;
-  BusCallbackData bus_callback_data = { 0, };
-
-#ifdef G_OS_UNIX
-  guint signal_watch_id;
-#endif
-  int rep_err;
-
+  gchar *scenario;
+  gchar *configs;
+  gchar *media_info;
+  gchar *verbosity;
+  gchar *output_file;
+  gboolean list_scenarios;
+  gboolean inspect_action_type;
+  gboolean fast_forward;
+  gboolean worker;
+} Options;
+
+static GOptionContext *
+create_option_context (Options * opts)
+{
+  GOptionContext *ctx;
   GOptionEntry options[] = {
-    {"set-scenario", '\0', 0, G_OPTION_ARG_FILENAME, &scenario,
+    {"set-scenario", '\0', 0, G_OPTION_ARG_FILENAME, &opts->scenario,
         "Let you set a scenario, it can be a full path to a scenario file"
           " or the name of the scenario (name of the file without the"
           " '.scenario' extension).", NULL},
-    {"list-scenarios", 'l', 0, G_OPTION_ARG_NONE, &list_scenarios,
+    {"list-scenarios", 'l', 0, G_OPTION_ARG_NONE, &opts->list_scenarios,
         "List the available scenarios that can be run", NULL},
-    {"verbosity", 'v', 0, G_OPTION_ARG_STRING, &verbosity,
+    {"verbosity", 'v', 0, G_OPTION_ARG_STRING, &opts->verbosity,
         "Set overall verbosity as defined by GstValidateVerbosityFlags"
           " as a string", NULL},
     {"scenarios-defs-output-file", '\0', 0, G_OPTION_ARG_FILENAME,
-          &output_file, "The output file to store scenarios details. "
+          &opts->output_file, "The output file to store scenarios details. "
           "Implies --list-scenarios",
         NULL},
-    {"inspect-action-type", 't', 0, G_OPTION_ARG_NONE, &inspect_action_type,
+    {"inspect-action-type", 't', 0, G_OPTION_ARG_NONE,
+          &opts->inspect_action_type,
           "Inspect the available action types with which to write scenarios."
           " Specify an action type if you want its full description."
           " If no action type is given the full list of available ones gets printed.",
         NULL},
-    {"set-media-info", '\0', 0, G_OPTION_ARG_FILENAME, &media_info,
+    {"set-media-info", '\0', 0, G_OPTION_ARG_FILENAME, &opts->media_info,
           "Set a media_info XML file descriptor to share information about the"
           " media file that will be reproduced.",
         NULL},
-    {"set-configs", '\0', 0, G_OPTION_ARG_STRING, &configs,
+    {"set-configs", '\0', 0, G_OPTION_ARG_STRING, &opts->configs,
           "Select a config scenario (one including 'is-config=true' in its"
           " description). Specify multiple ones using ':' as separator."
           " This option overrides the GST_VALIDATE_SCENARIO environment variable.",
         NULL},
+    {"fast-forward", '\0', 0, G_OPTION_ARG_NONE, &opts->fast_forward,
+          "Run the scenario as fast as the pipeline can produce data: sinks"
+          " do not synchronise on the clock and are held back at the playback"
+          " time of the next action until it has been executed."
+          " Equivalent to setting GST_VALIDATE_SCENARIO_FAST_FORWARD=1.",
+        NULL},
+    {"worker", '\0', 0, G_OPTION_ARG_NONE, &opts->worker,
+          "Run the tests described on the standard input one after the other"
+          " in this process, instead of the PIPELINE-DESCRIPTION."
+          " This is meant to be used by gst-validate-launcher.",
+        NULL},
     {NULL}
   };
-  GOptionContext *ctx;
-  gchar **argvn;
-  GstValidateRunner *runner;
-  GstValidateMonitor *monitor;
-  GstBus *bus;
 
-  setlocale (LC_ALL, "");
-
-  g_set_prgname ("gst-validate-" GST_API_VERSION);
   ctx = g_option_context_new ("PIPELINE-DESCRIPTION");
   g_option_context_add_main_entries (ctx, options, NULL);
   g_option_context_set_summary (ctx, "Runs a gst launch pipeline, adding "
@@ -365,82 +380,80 @@ main (int argc, gchar ** argv)
       " the env var GST_DEBUG=validate:2 and it will be printed "
       "as gstreamer debugging");
 
-  if (argc == 1) {
-    g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
-    exit (1);
-  }
-
-  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
-    g_printerr ("Error initializing: %s\n", err->message);
-    g_option_context_free (ctx);
-    g_clear_error (&err);
-    exit (1);
-  }
+  return ctx;
+}
 
-  if (scenario || configs) {
+/* Passes the options the library reads from the environment */
+static void
+apply_options (Options * opts)
+{
+  if (opts->scenario || opts->configs) {
     gchar *scenarios;
 
-    if (scenario)
-      scenarios = g_strjoin (":", scenario, configs, NULL);
+    if (opts->scenario)
+      scenarios = g_strjoin (":", opts->scenario, opts->configs, NULL);
     else
-      scenarios = g_strdup (configs);
+      scenarios = g_strdup (opts->configs);
 
     g_setenv ("GST_VALIDATE_SCENARIO", scenarios, TRUE);
     g_free (scenarios);
-    g_free (scenario);
-    g_free (configs);
-  }
-
-  gst_init (&argc, &argv);
-  gst_validate_init ();
-
-  if (list_scenarios || output_file) {
-    if (gst_validate_list_scenarios (argv + 1, argc - 1, output_file))
-      return 1;
-    return 0;
   }
 
-  if (inspect_action_type) {
-    _register_playbin_actions ();
-
-    if (!gst_validate_print_action_types ((const gchar **) argv + 1, argc - 1)) {
-      GST_ERROR ("Could not print all wanted types");
-      return -1;
-    }
-
-    return 0;
-  }
+  if (opts->fast_forward)
+    g_setenv ("GST_VALIDATE_SCENARIO_FAST_FORWARD", "1", TRUE);
+}
 
-  if (argc == 1) {
-    g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
-    g_option_context_free (ctx);
-    exit (1);
-  }
+static void
+options_clear (Options * opts)
+{
+  g_free (opts->scenario);
+  g_free (opts->configs);
+  g_free (opts->media_info);
+  g_free (opts->verbosity);
+  g_free (opts->output_file);
+  memset (opts, 0, sizeof (Options));
+}
 
-  g_option_context_free (ctx);
+/* Runs the pipeline described by @argv, reporting to @runner, and returns the
+ * test result */
+static gint
+run_pipeline (GstValidateRunner * runner, gint argc, gchar ** argv,
+    Options * opts)
+{
+  GError *err = NULL;
+  gboolean monitor_handles_state;
+  GstStateChangeReturn sret;
+  BusCallbackData bus_callback_data = { 0, };
+  gchar **argvn;
+  GstValidateMonitor *monitor;
+  GstBus *bus;
+  int rep_err;
+#ifdef G_OS_UNIX
+  guint signal_watch_id;
+#endif
 
-  runner = gst_validate_runner_new ();
-  if (!runner) {
-    g_printerr ("Failed to setup Validate Runner\n");
-    exit (1);
-  }
+  ret = 0;
+  buffering = FALSE;
+  is_live = FALSE;
 
   /* Create the pipeline */
-  argvn = g_new0 (char *, argc);
-  memcpy (argvn, argv + 1, sizeof (char *) * (argc - 1));
+  argvn = g_new0 (char *, argc + 1);
+  memcpy (argvn, argv, sizeof (char *) * argc);
   pipeline = (GstElement *) gst_parse_launchv ((const gchar **) argvn, &err);
   g_free (argvn);
   if (!pipeline) {
     g_print ("Failed to create pipeline: %s\n",
         err ? err->message : "unknown reason");
     g_clear_error (&err);
-    g_object_unref (runner);
 
-    exit (1);
+    return 1;
   } else if (err) {
     g_printerr ("Erroneous pipeline: %s\n",
         err->message ? err->message : "unknown reason");
     g_clear_error (&err);
+    gst_object_unref (pipeline);
+    pipeline = NULL;
+
     return 1;
   }
 
@@ -457,39 +470,36 @@ main (int argc, gchar ** argv)
       g_unix_signal_add (SIGINT, (GSourceFunc) intr_handler, pipeline);
 #endif
 
-  gst_validate_spin_on_fault_signals ();
-
-  if (_is_playbin_pipeline (argc - 1, argv + 1)) {
+  if (_is_playbin_pipeline (argc, argv)) {
     _register_playbin_actions ();
   }
 
   monitor = gst_validate_monitor_factory_create (GST_OBJECT_CAST (pipeline),
       runner, NULL);
-  if (verbosity)
-    gst_util_set_object_arg (G_OBJECT (monitor), "verbosity", verbosity);
+  if (opts->verbosity)
+    gst_util_set_object_arg (G_OBJECT (monitor), "verbosity", opts->verbosity);
   gst_validate_reporter_set_handle_g_logs (GST_VALIDATE_REPORTER (monitor));
 
-  if (media_info) {
-    GError *err = NULL;
+  mainloop = g_main_loop_new (NULL, FALSE);
+
+  if (opts->media_info) {
     GstValidateMediaDescriptorParser *parser =
         gst_validate_media_descriptor_parser_new (runner,
-        media_info, &err);
+        opts->media_info, &err);
 
     if (parser == NULL) {
       GST_ERROR ("Could not use %s as a media-info file (error: %s)",
-          media_info, err ? err->message : "Unknown error");
+          opts->media_info, err ? err->message : "Unknown error");
 
-      g_free (media_info);
-      exit (1);
+      ret = 1;
+      goto exit;
     }
 
     gst_validate_monitor_set_media_descriptor (monitor,
         GST_VALIDATE_MEDIA_DESCRIPTOR (parser));
     gst_object_unref (parser);
-    g_free (media_info);
   }
 
-  mainloop = g_main_loop_new (NULL, FALSE);
   bus = gst_element_get_bus (pipeline);
   gst_bus_add_signal_watch (bus);
   bus_callback_data.mainloop = mainloop;
@@ -507,7 +517,7 @@ main (int argc, gchar ** argv)
         g_print ("Pipeline failed to go to PLAYING state\n");
         gst_element_set_state (pipeline, GST_STATE_NULL);
         ret = -1;
-        goto exit;
+        goto done;
       case GST_STATE_CHANGE_NO_PREROLL:
         g_print ("Pipeline is live.\n");
         is_live = TRUE;
@@ -527,11 +537,6 @@ main (int argc, gchar ** argv)
   gst_element_set_state (pipeline, GST_STATE_NULL);
   gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
 
-  /* Clean the bus */
-  gst_bus_set_flushing (bus, TRUE);
-  gst_bus_remove_signal_watch (bus);
-  gst_object_unref (bus);
-
   rep_err = gst_validate_runner_exit (runner, TRUE);
   if (ret == 0) {
     ret = rep_err;
@@ -539,10 +544,18 @@ main (int argc, gchar ** argv)
       g_print ("Returning %d as errors were found\n", rep_err);
   }
 
+done:
+  /* Clean the bus */
+  gst_bus_set_flushing (bus, TRUE);
+  gst_bus_remove_signal_watch (bus);
+  g_signal_handlers_disconnect_by_func (bus, bus_callback, &bus_callback_data);
+  gst_object_unref (bus);
+
 exit:
   g_main_loop_unref (mainloop);
-  g_object_unref (pipeline);
-  g_object_unref (runner);
+  mainloop = NULL;
+  gst_object_unref (pipeline);
+  pipeline = NULL;
   gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (monitor));
   g_object_unref (monitor);
   g_clear_error (&err);
@@ -553,6 +566,326 @@ exit:
   g_print ("\n=======> Test %s (Return value: %i)\n\n",
       ret == 0 ? "PASSED" : "FAILED", ret);
 
+  return ret;
+}
+
+#ifdef G_OS_UNIX
+static void
+save_env (GHashTable * saved_env, const gchar * name)
+{
+  if (!g_hash_table_contains (saved_env, name))
+    g_hash_table_insert (saved_env, g_strdup (name), g_strdup (g_getenv (name)));
+}
+
+static void
+restore_env (GHashTable * saved_env)
+{
+  GHashTableIter iter;
+  const gchar *name, *value;
+
+  g_hash_table_iter_init (&iter, saved_env);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & name,
+          (gpointer *) & value)) {
+    if (value)
+      g_setenv (name, value, TRUE);
+    else
+      g_unsetenv (name);
+  }
+}
+
+/* Runs the test described by @line, which looks like:
+ *
+ *   test, args=(string)<"--set-media-info", "/path/to/file.media_info",
+ *       "playbin", "uri=file:///path/to/file">,
+ *       env=(string)<"GST_VALIDATE_UUID=some-uuid", "GST_VALIDATE_SCENARIO">,
+ *       logfile=(string)"/path/to/logfile";
+ *
+ * @args are the arguments gst-validate-1.0 would be started with, @env the
+ * environment variables to set ("NAME=value") or unset ("NAME") for the
+ * duration of the test, and @logfile the file the test output is appended
+ * to. The environment variables that are only read when GstValidate is
+ * initialized can not be changed that way.
+ */
+static gint
+run_worker_test (GstValidateRunner * runner, const gchar * line)
+{
+  GstStructure *test;
+  const GValue *args, *env;
+  const gchar *logfile;
+  GHashTable *saved_env;
+  GOptionContext *ctx;
+  GError *err = NULL;
+  Options opts = { NULL, };
+  gchar **argv, **argvn;
+  gint argc, i, logfd, stdout_fd = -1, stderr_fd = -1;
+  gint res = 1;
+
+  test = gst_structure_from_string (line, NULL);
+  if (!test || !gst_structure_has_name (test, "test")) {
+    g_printerr ("Invalid test description: %s\n", line);
+    goto invalid;
+  }
+
+  args = gst_structure_get_value (test, "args");
+  env = gst_structure_get_value (test, "env");
+  logfile = gst_structure_get_string (test, "logfile");
+  if (!args || !GST_VALUE_HOLDS_ARRAY (args)
+      || (env && !GST_VALUE_HOLDS_ARRAY (env))) {
+    g_printerr ("Invalid test description: %s\n", line);
+    goto invalid;
+  }
+
+  if (logfile) {
+    logfd = g_open (logfile, O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (logfd < 0) {
+      g_printerr ("Could not open %s: %s\n", logfile, g_strerror (errno));
+      goto invalid;
+    }
+
+    fflush (stdout);
+    fflush (stderr);
+    stdout_fd = dup (STDOUT_FILENO);
+    stderr_fd = dup (STDERR_FILENO);
+    dup2 (logfd, STDOUT_FILENO);
+    dup2 (logfd, STDERR_FILENO);
+    close (logfd);
+  }
+
+  saved_env = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  /* Set by the options */
+  save_env (saved_env, "GST_VALIDATE_SCENARIO");
+  save_env (saved_env, "GST_VALIDATE_SCENARIO_FAST_FORWARD");
+  for (i = 0; env && i < gst_value_array_get_size (env); i++) {
+    const GValue *v = gst_value_array_get_value (env, i);
+    gchar **name_value;
+
+    if (!G_VALUE_HOLDS_STRING (v))
+      continue;
+
+    name_value = g_strsplit (g_value_get_string (v), "=", 2);
+    if (name_value[0]) {
+      save_env (saved_env, name_value[0]);
+      if (name_value[1])
+        g_setenv (name_value[0], name_value[1], TRUE);
+      else
+        g_unsetenv (name_value[0]);
+    }
+    g_strfreev (name_value);
+  }
+
+  argc = gst_value_array_get_size (args) + 1;
+  argv = g_new0 (gchar *, argc + 1);
+  argv[0] = g_strdup (g_get_prgname ());
+  for (i = 1; i < argc; i++) {
+    const GValue *v = gst_value_array_get_value (args, i - 1);
+
+    argv[i] = G_VALUE_HOLDS_STRING (v) ? g_value_dup_string (v) :
+        gst_value_serialize (v);
+  }
+
+  /* g_option_context_parse() removes the options from the array it gets */
+  argvn = g_new0 (gchar *, argc + 1);
+  memcpy (argvn, argv, sizeof (gchar *) * argc);
+
+  ctx = create_option_context (&opts);
+  if (!g_option_context_parse (ctx, &argc, &argvn, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+  } else if (argc == 1) {
+    g_printerr ("No pipeline description given\n");
+  } else {
+    apply_options (&opts);
+
+    /* Report as this test, and only what happens in this test */
+    gst_validate_report_reconnect_server ();
+    gst_validate_runner_reset (runner);
+    res = run_pipeline (runner, argc - 1, argvn + 1, &opts);
+  }
+  g_option_context_free (ctx);
+  options_clear (&opts);
+  g_free (argvn);
+  g_strfreev (argv);
+
+  restore_env (saved_env);
+  g_hash_table_unref (saved_env);
+
+  /* Makes sure everything has been sent for this test */
+  gst_validate_report_reconnect_server ();
+
+  if (stdout_fd >= 0) {
+    fflush (stdout);
+    fflush (stderr);
+    dup2 (stdout_fd, STDOUT_FILENO);
+    dup2 (stderr_fd, STDERR_FILENO);
+    close (stdout_fd);
+    close (stderr_fd);
+  }
+
+invalid:
+  if (test)
+    gst_structure_free (test);
+
+  return res;
+}
+
+/* The validate plugins configured through GST_VALIDATE_CONFIG create their
+ * overrides when GstValidate is initialized, and those keep the state of the
+ * test they ran in, like the frames validatessim compared or the output file
+ * of validateflow. A worker with such a configuration only runs one test. */
+static gboolean
+worker_is_reusable (void)
+{
+  return g_getenv ("GST_VALIDATE_CONFIG") == NULL;
+}
+
+/* Runs the tests described on stdin one line at a time, see
+ * run_worker_test(), and writes
+ * "test-done, returncode=(int)<value>, reusable=(boolean)<value>;" on stdout
+ * once each of them is done. The worker exits after a test it can not be
+ * reused for. */
+static gint
+run_worker (void)
+{
+  gboolean reusable = worker_is_reusable ();
+
+  GstValidateRunner *runner;
+  GIOChannel *requests;
+  FILE *results;
+  gchar *line;
+
+  /* No other runner can be created once the first test created elements, all
+   * the tests use that one */
+  runner = gst_validate_runner_new ();
+  if (!runner) {
+    g_printerr ("Failed to setup Validate Runner\n");
+    return 1;
+  }
+
+  /* Only the results go to stdout, what is printed outside of the tests
+   * goes to stderr */
+  fflush (stdout);
+  results = fdopen (dup (STDOUT_FILENO), "w");
+  if (!results) {
+    g_printerr ("Could not open the results stream: %s\n", g_strerror (errno));
+    g_object_unref (runner);
+    return 1;
+  }
+  dup2 (STDERR_FILENO, STDOUT_FILENO);
+
+  requests = g_io_channel_unix_new (STDIN_FILENO);
+  g_io_channel_set_encoding (requests, NULL, NULL);
+  while (g_io_channel_read_line (requests, &line, NULL, NULL,
+          NULL) == G_IO_STATUS_NORMAL) {
+    gint res;
+
+    g_strstrip (line);
+    if (*line == '\0') {
+      g_free (line);
+      continue;
+    }
+
+    res = run_worker_test (runner, line);
+    g_free (line);
+
+    fprintf (results, "test-done, returncode=(int)%d, reusable=(boolean)%s;\n",
+        res, reusable ? "true" : "false");
+    fflush (results);
+
+    if (!reusable)
+      break;
+  }
+
+  g_io_channel_unref (requests);
+  fclose (results);
+  g_object_unref (runner);
+
+  return 0;
+}
+#else
+static gint
+run_worker (void)
+{
+  g_printerr ("The worker mode is not supported on this platform\n");
+
+  return 1;
+}
+#endif
+
+int
+main (int argc, gchar ** argv)
+{
+  GError *err = NULL;
+  Options opts = { NULL, };
+  GstValidateRunner *runner;
+  GOptionContext *ctx;
+
+  setlocale (LC_ALL, "");
+
+  g_set_prgname ("gst-validate-" GST_API_VERSION);
+  ctx = create_option_context (&opts);
+
+  if (argc == 1) {
+    g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
+    exit (1);
+  }
+
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    exit (1);
+  }
+
+  apply_options (&opts);
+
+  gst_init (&argc, &argv);
+  gst_validate_init ();
+
+  if (opts.list_scenarios || opts.output_file) {
+    if (gst_validate_list_scenarios (argv + 1, argc - 1, opts.output_file))
+      return 1;
+    return 0;
+  }
+
+  if (opts.inspect_action_type) {
+    _register_playbin_actions ();
+
+    if (!gst_validate_print_action_types ((const gchar **) argv + 1, argc - 1)) {
+      GST_ERROR ("Could not print all wanted types");
+      return -1;
+    }
+
+    return 0;
+  }
+
+  gst_validate_spin_on_fault_signals ();
+
+  if (opts.worker) {
+    g_option_context_free (ctx);
+    ret = run_worker ();
+    goto done;
+  }
+
+  if (argc == 1) {
+    g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
+    g_option_context_free (ctx);
+    exit (1);
+  }
+
+  g_option_context_free (ctx);
+
+  runner = gst_validate_runner_new ();
+  if (!runner) {
+    g_printerr ("Failed to setup Validate Runner\n");
+    ret = 1;
+    goto done;
+  }
+
+  ret = run_pipeline (runner, argc - 1, argv + 1, &opts);
+  g_object_unref (runner);
+
+done:
+  options_clear (&opts);
   gst_validate_deinit ();
   gst_deinit ();
   return ret;